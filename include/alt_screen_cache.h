@@ -0,0 +1,100 @@
+/**
+ * @file alt_screen_cache.h
+ * @brief Keeps the primary screen's pixels while the alternate screen is up.
+ *
+ * Full-screen programs (editors, pagers) switch to the alternate screen and
+ * back. Instead of repainting every row of the primary screen on the way
+ * back, its rendered frame is copied aside on entry and copied back on
+ * exit; only rows whose cells changed in between are drawn again.
+ *
+ * @author VaixTerm Team
+ * @date 2024
+ */
+
+#ifndef ALT_SCREEN_CACHE_H
+#define ALT_SCREEN_CACHE_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "terminal_state.h"
+
+typedef struct AltScreenCache AltScreenCache;
+
+/**
+ * @brief Create an idle cache
+ *
+ * @return AltScreenCache* The cache, or NULL on allocation failure
+ */
+AltScreenCache* alt_screen_cache_create(void);
+
+/**
+ * @brief Destroy the cache and its copy of the frame
+ *
+ * @param cache Cache (may be NULL)
+ */
+void alt_screen_cache_destroy(AltScreenCache* cache);
+
+/**
+ * @brief Forget the saved frame, e.g. after render targets were lost
+ *
+ * @param cache Cache (may be NULL)
+ */
+void alt_screen_cache_drop(AltScreenCache* cache);
+
+/**
+ * @brief Remember the primary screen as the alternate screen comes up
+ *
+ * The frame itself is copied by the next alt_screen_cache_render(), which
+ * runs before anything of the alternate screen is drawn.
+ *
+ * @param cache Cache
+ * @param term Terminal; its rows still marked dirty have not been drawn yet
+ * @param grid Primary screen cells, term->rows * term->cols
+ * @return bool True if the primary screen will be restored from the cache
+ */
+bool alt_screen_cache_enter(AltScreenCache* cache, Terminal* term, const Glyph* grid);
+
+/**
+ * @brief Schedule the saved frame for restore as the primary screen returns
+ *
+ * Dirty rows are reset to those the saved frame lacks; further damage is
+ * filtered through alt_screen_cache_row_changed() until the restore.
+ *
+ * @param cache Cache (may be NULL)
+ * @param term Terminal
+ * @return bool False if nothing usable was saved and a full repaint is needed
+ */
+bool alt_screen_cache_leave(AltScreenCache* cache, Terminal* term);
+
+/**
+ * @brief Whether the primary screen is back and not yet restored
+ *
+ * @param cache Cache (may be NULL)
+ * @return bool True between alt_screen_cache_leave() and the next render
+ */
+bool alt_screen_cache_restoring(const AltScreenCache* cache);
+
+/**
+ * @brief Whether a damaged row differs from the saved frame
+ *
+ * @param cache Cache, restoring
+ * @param y Row
+ * @param line Current cells of the row
+ * @param cols Cells in @p line; a width other than the saved one always differs
+ * @return bool True if the row must be drawn again
+ */
+bool alt_screen_cache_row_changed(const AltScreenCache* cache, int y, const Glyph* line, int cols);
+
+/**
+ * @brief Save or restore the frame; call before drawing any rows
+ *
+ * @param cache Cache (may be NULL)
+ * @param renderer Renderer
+ * @param term Terminal whose screen texture is saved or restored
+ * @param full_repaint This frame repaints everything anyway; the cache is dropped
+ * @return bool True if the frame was restored and must be presented
+ */
+bool alt_screen_cache_render(AltScreenCache* cache, SDL_Renderer* renderer, Terminal* term,
+                             bool full_repaint);
+
+#endif // ALT_SCREEN_CACHE_H
@@ -24,7 +24,7 @@
  * @return true on success, false on failure.
  */
 bool app_init_sdl(SDL_Window** win, SDL_Renderer** renderer, TTF_Font** font, 
-                  const Config* config, int* char_w, int* char_h);
+                  Config* config, int* char_w, int* char_h);
 
 /**
  * @brief Spawns the child process (shell) using PTY.
@@ -50,6 +50,44 @@ Terminal* app_init_terminal(const Config* config, SDL_Renderer* renderer, int ch
  */
 bool app_init_osk(OnScreenKeyboard* osk, const Config* config);
 
+/**
+ * @brief Loads OSK layouts and key sets; the file-parsing half of app_init_osk().
+ *
+ * Makes no SDL calls, so it may run before SDL is initialized.
+ * @param osk OSK structure to initialize.
+ * @param config Application configuration.
+ * @return true on success, false on failure.
+ */
+bool app_load_osk(OnScreenKeyboard* osk, const Config* config);
+
+typedef struct AppStartup AppStartup;
+
+/**
+ * @brief Starts background work that overlaps SDL initialization.
+ *
+ * Buffers PTY output from the already-forked shell and parses the OSK
+ * files on worker threads. @p osk and @p config must not be touched until
+ * app_startup_finish_osk() returns.
+ * @param master_fd PTY master (-1 for none).
+ * @param osk OSK structure to load into.
+ * @param config Application configuration.
+ * @return Startup handle, or NULL to fall back to inline loading.
+ */
+AppStartup* app_startup_begin(int master_fd, OnScreenKeyboard* osk, const Config* config);
+
+/**
+ * @brief Waits for the OSK files and opens input devices (needs SDL).
+ * @return true on success, false on failure.
+ */
+bool app_startup_finish_osk(AppStartup* startup, OnScreenKeyboard* osk, const Config* config);
+
+/**
+ * @brief Stops the PTY reader and feeds its buffered output into @p term.
+ * @param startup Startup handle (may be NULL).
+ * @param term Terminal instance, or NULL to discard the output.
+ */
+void app_startup_finish(AppStartup* startup, Terminal* term);
+
 /**
  * @brief Runs the credit screen if enabled.
  * @param renderer SDL renderer.
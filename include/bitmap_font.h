@@ -0,0 +1,51 @@
+/**
+ * @file bitmap_font.h
+ * @brief Fixed-size bitmap fonts (PSF1, PSF2, BDF) loaded without FreeType.
+ *
+ * Glyphs are kept as 1 bit per pixel cell bitmaps so the glyph cache can
+ * expand them straight into its atlas. The cell size comes from the font
+ * header.
+ */
+
+#ifndef BITMAP_FONT_H
+#define BITMAP_FONT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t codepoint;
+    uint32_t glyph;
+} BitmapFontMapping;
+
+typedef struct BitmapFont {
+    int width;                  // Cell width in pixels
+    int height;                 // Cell height in pixels
+    size_t stride;              // Bytes per glyph row, MSB is the leftmost pixel
+    uint32_t num_glyphs;
+    uint8_t* bitmaps;           // num_glyphs * height * stride bytes
+    BitmapFontMapping* map;     // Sorted by codepoint
+    uint32_t map_len;
+} BitmapFont;
+
+/**
+ * @brief Loads a PSF1, PSF2 or BDF font, detected from the file contents.
+ * @param path Font file path.
+ * @return The font, or NULL on failure.
+ */
+BitmapFont* bitmap_font_open(const char* path);
+
+/**
+ * @brief Releases a font returned by bitmap_font_open().
+ */
+void bitmap_font_close(BitmapFont* font);
+
+/**
+ * @brief Returns the cell bitmap for @p c, or NULL if the font lacks it.
+ *
+ * The bitmap is height rows of stride bytes.
+ */
+const uint8_t* bitmap_font_glyph(const BitmapFont* font, uint32_t c);
+
+#endif // BITMAP_FONT_H
@@ -0,0 +1,46 @@
+/**
+ * @file cache_file.h
+ * @brief Files in the per-user cache directory: paths, atomic writes and read-only mappings.
+ *
+ * The cache directory is $XDG_CACHE_HOME/vaixterm, falling back to
+ * ~/.cache/vaixterm. Everything kept there can be rebuilt, so callers treat
+ * any failure here as a cache miss.
+ */
+
+#ifndef CACHE_FILE_H
+#define CACHE_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Builds the path of a cache file, creating the cache directory if needed.
+ * @param name File name inside the cache directory.
+ * @param out Output buffer.
+ * @param out_size Size of @p out.
+ * @return true on success, false if no cache directory is available.
+ */
+bool cache_file_path(const char* name, char* out, size_t out_size);
+
+/**
+ * @brief Writes @p len bytes to @p path through a temporary file and rename().
+ *
+ * Readers that mapped the previous file keep a valid view of it.
+ * @return true on success, false on failure.
+ */
+bool cache_file_write_atomic(const char* path, const void* data, size_t len);
+
+/**
+ * @brief Maps a whole file read-only.
+ * @param path File path.
+ * @param len Output for the mapping length.
+ * @return Mapping, or NULL if the file is missing, empty or cannot be mapped.
+ */
+const void* cache_file_map(const char* path, size_t* len);
+
+/**
+ * @brief Releases a mapping returned by cache_file_map().
+ */
+void cache_file_unmap(const void* data, size_t len);
+
+#endif // CACHE_FILE_H
@@ -16,6 +16,7 @@ SDL_Color get_background_color(Terminal* term, Glyph* glyph);
 void apply_sgr_colors(Terminal* term, Glyph* glyph, SDL_Color* fg, SDL_Color* bg);
 bool validate_color(const SDL_Color* color);
 SDL_Color rgb_to_color(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+SDL_Color color_quantize_565(SDL_Color color);
 bool hex_to_rgb(const char* hex_str, uint8_t* r, uint8_t* g, uint8_t* b, uint8_t* a);
 void sgr_to_color(Terminal* term, int color_index, SDL_Color* color);
 
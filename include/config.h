@@ -64,6 +64,10 @@
 #define DEFAULT_SCROLLBACK_LINES 1000
 #define DEFAULT_FONT_FILE_PATH "res/Martian.ttf"
 #define DEFAULT_BACKGROUND_IMAGE_PATH NULL // Or "" if you prefer an empty string
+#define DEFAULT_POWER_SUPPLY_PATH "/sys/class/power_supply"
+#define DEFAULT_THERMAL_PATH "/sys/class/thermal"
+#define DEFAULT_LOW_BATTERY_PERCENT 20
+#define DEFAULT_HOT_TEMP_CELSIUS 70
 
 // --- Button Repeat Timing ---
 // The initial delay before a held button starts repeating.
@@ -7,6 +7,7 @@
 #define CONFIG_MANAGER_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "terminal_state.h"
 
 /**
@@ -52,4 +53,13 @@ void config_cleanup(Config* config);
  */
 bool config_load_from_file(Config* config, const char* explicit_path);
 
+/**
+ * @brief Builds the path of a file next to vaixterm.conf, creating the directory if needed.
+ * @param name File name inside the config directory.
+ * @param out Output buffer.
+ * @param out_size Size of @p out.
+ * @return true on success, false if no config directory is available.
+ */
+bool config_dir_path(const char* name, char* out, size_t out_size);
+
 #endif // CONFIG_MANAGER_H
@@ -0,0 +1,62 @@
+/**
+ * @file font_fallback.h
+ * @brief Ordered fallback fonts for codepoints the primary font lacks.
+ *
+ * Every font in the chain has a coverage bitmap, computed once and saved
+ * to the cache directory, so resolving a codepoint to a font is a few bit
+ * tests. Index 0 is the primary font; fallbacks start at 1.
+ */
+
+#ifndef FONT_FALLBACK_H
+#define FONT_FALLBACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <SDL_ttf.h>
+
+#include "terminal_state.h"
+
+#define FONT_COVERAGE_LIMIT 0x40000     // Codepoints with a coverage bit (planes 0-3)
+
+/**
+ * @brief Sets up the chain. Without fallback paths every codepoint resolves to 0.
+ *
+ * Coverage of every font in the chain is loaded from the cache directory,
+ * or probed and saved, before this returns.
+ * @param primary_path Primary font file, used to identify its coverage cache.
+ * @param primary Open primary font, used to compute its coverage.
+ * @param paths Fallback font files in order of preference.
+ * @param count Number of @p paths; extra ones beyond FONT_FALLBACK_MAX are ignored.
+ * @return true if fallback resolution is active.
+ */
+bool font_fallback_init(const char* primary_path, TTF_Font* primary, char* const* paths, int count);
+
+/**
+ * @brief Marks @p c as drawn by the primary font (e.g. from a bitmap font).
+ */
+void font_fallback_add_primary(uint32_t c);
+
+/**
+ * @brief Returns the index of the first font in the chain that has @p c.
+ *
+ * Only reads the coverage built by font_fallback_init(). Codepoints no font
+ * has, and codepoints past FONT_COVERAGE_LIMIT, resolve to the primary font.
+ */
+unsigned font_fallback_resolve(uint32_t c);
+
+/**
+ * @brief Returns the file of fallback @p index (1-based), or NULL.
+ */
+const char* font_fallback_path(unsigned index);
+
+/**
+ * @brief Identifies the chain, for caches that store fallback glyphs.
+ */
+uint64_t font_fallback_id(void);
+
+/**
+ * @brief Releases coverage and paths.
+ */
+void font_fallback_cleanup(void);
+
+#endif // FONT_FALLBACK_H
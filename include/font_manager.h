@@ -10,9 +10,59 @@
 #include <stdbool.h>
 
 #include "terminal_state.h"
+#include "bitmap_font.h"
+
+/**
+ * @brief Opens @p path at @p size from an in-memory copy of the file.
+ *
+ * The file is read once; later sizes of the same file reuse the buffer,
+ * which stays valid until font_manager_cleanup().
+ * @return The font, or NULL on failure.
+ */
+TTF_Font* font_open(const char* path, int size);
+
+/**
+ * @brief Prepares the next size in the last zoom direction.
+ *
+ * Call while the terminal is idle. Does nothing unless a zoom happened
+ * since the last call.
+ * @param renderer Renderer the glyph atlas is created for.
+ * @param config Application configuration.
+ */
+void font_manager_prewarm(SDL_Renderer* renderer, const Config* config);
+
+/**
+ * @brief Opens the bitmap font drawn in place of the TTF font in the grid.
+ * @param path PSF1, PSF2 or BDF file.
+ * @return true on success, false if the font could not be loaded.
+ */
+bool font_manager_open_bitmap(const char* path);
+
+/**
+ * @brief Returns the bitmap font, or NULL when the grid uses the TTF font.
+ */
+const BitmapFont* font_manager_bitmap(void);
+
+/**
+ * @brief Releases retained zoom sizes, the bitmap font and the font data.
+ *
+ * Call after closing the current font and before destroying the renderer.
+ */
+void font_manager_cleanup(void);
+
+/**
+ * @brief Returns the terminal cell size.
+ *
+ * The bitmap font header when one is open, else the size of "W" in @p font.
+ * @return true on success, false if the metrics could not be determined.
+ */
+bool font_cell_size(TTF_Font* font, int* char_w, int* char_h);
 
 /**
  * @brief Changes the font size and updates all related components.
+ *
+ * The outgoing font and glyph cache are retained, and a retained size is
+ * reused instead of being reopened.
  * @param font Font pointer (will be modified).
  * @param config Application configuration.
  * @param term Terminal instance.
@@ -7,6 +7,7 @@
  * - Cache hit/miss operations
  * - Texture lifecycle management
  * - Cache statistics and cleanup
+ * - Alpha-mask atlas persisted per font file, size and hinting
  *
  * @author VaixTerm Team
  * @date 2024
@@ -22,12 +23,15 @@
 /**
  * @brief Create a glyph key for caching
  *
+ * Colors are applied when drawing, so only the code point, the
+ * attributes that change the outline and the font it comes from take part.
+ *
  * @param c Character code
  * @param attributes Character attributes
- * @param fg Foreground color
+ * @param font_index Font in the fallback chain, 0 = primary
  * @return uint64_t Cache key
  */
-uint64_t make_glyph_key(uint32_t c, unsigned char attributes, SDL_Color fg);
+uint64_t make_glyph_key(uint32_t c, unsigned char attributes, unsigned font_index);
 
 /**
  * @brief Hash a cache key
@@ -47,16 +51,14 @@ uint32_t hash_key(uint64_t key);
 GlyphCacheEntry* glyph_cache_get(GlyphCache* cache, uint64_t key);
 
 /**
- * @brief Put a glyph texture into the cache
+ * @brief Put a glyph into the cache
  *
  * @param cache Pointer to the glyph cache
  * @param key Cache key
- * @param texture SDL texture to cache
- * @param w Texture width
- * @param h Texture height
- * @return bool True if successfully cached
+ * @param src Glyph coverage inside the atlas
+ * @return GlyphCacheEntry* The stored entry, or NULL on invalid input
  */
-bool glyph_cache_put(GlyphCache* cache, uint64_t key, SDL_Texture* texture, int w, int h);
+GlyphCacheEntry* glyph_cache_put(GlyphCache* cache, uint64_t key, const SDL_Rect* src);
 
 /**
  * @brief Initialize the glyph cache
@@ -70,6 +72,8 @@ bool glyph_cache_init(GlyphCache* cache, int capacity);
 /**
  * @brief Cleanup the glyph cache
  *
+ * Saves the atlas (see glyph_cache_save()) and releases it.
+ *
  * @param cache Pointer to the cache structure
  */
 void glyph_cache_cleanup(GlyphCache* cache);
@@ -81,35 +85,132 @@ void glyph_cache_cleanup(GlyphCache* cache);
  */
 void glyph_cache_clear(GlyphCache* cache);
 
+/**
+ * @brief Free the atlas, keeping font and settings
+ *
+ * New glyphs are saved first, so the next glyph_cache_prepare() reloads
+ * the atlas from the cache directory instead of rasterizing it again.
+ *
+ * @param cache Pointer to the cache structure
+ */
+void glyph_cache_release(GlyphCache* cache);
+
 /**
  * @brief Get cache statistics
  *
  * @param cache Pointer to the cache structure
  * @param hits Output for cache hits
  * @param misses Output for cache misses
- * @param size Output for current cache size
+ * @param size Output for the number of cached glyphs
  */
 void glyph_cache_stats(GlyphCache* cache, int* hits, int* misses, int* size);
 
 /**
- * @brief Render a glyph and cache it if needed
+ * @brief Names the font the cache holds glyphs for
  *
- * This function combines glyph rendering and caching in one operation.
+ * Together with the size and the font's hinting this selects the atlas
+ * file. Call after glyph_cache_init() whenever the font changes.
  *
- * @param renderer SDL renderer
- * @param font Font to use for rendering
- * @param cache Glyph cache
+ * @param cache Pointer to the glyph cache
+ * @param font_path Font file path
+ * @param font_size Point size
+ */
+void glyph_cache_set_font(GlyphCache* cache, const char* font_path, int font_size);
+
+/**
+ * @brief Select the atlas texel format
+ *
+ * At 16 bits the atlas texture is ARGB4444, half the size, with 16
+ * coverage levels; the CPU coverage keeps all 256. Call before
+ * glyph_cache_prepare().
+ *
+ * @param cache Pointer to the glyph cache
+ * @param depth 16 or 32
+ */
+void glyph_cache_set_color_depth(GlyphCache* cache, int depth);
+
+/**
+ * @brief Choose how glyphs missing from the cache are rasterized
+ *
+ * Glyphs already in the atlas keep their look while quality drops.
+ * Anything below GLYPH_RASTER_BLENDED is left out of the saved atlas, and
+ * is dropped when the mode returns to GLYPH_RASTER_BLENDED.
+ *
+ * @param cache Pointer to the glyph cache
+ * @param mode Rasterization mode
+ * @return true if glyphs were dropped: what was drawn with them, on screen
+ *         or in the row cache, needs drawing again
+ */
+bool glyph_cache_set_raster_mode(GlyphCache* cache, GlyphRasterMode mode);
+
+/**
+ * @brief Draw the glyphs a bitmap font provides from its cell bitmaps
+ *
+ * Codepoints missing from @p font are still rasterized with the TTF font.
+ * The font must outlive the cache; NULL goes back to TTF only. Call after
+ * glyph_cache_init() and before glyph_cache_prepare().
+ *
+ * @param cache Pointer to the glyph cache
+ * @param font Bitmap font, or NULL
+ */
+void glyph_cache_set_bitmap_font(GlyphCache* cache, const struct BitmapFont* font);
+
+/**
+ * @brief Create the atlas and fill it before the first frame
+ *
+ * Loads the saved atlas for the font with one mapping and one texture
+ * update. Without one, the hot set (ASCII, Latin-1, box drawing, blocks,
+ * common symbols) is rasterized and uploaded at once. Cheap when the
+ * atlas already exists for @p renderer.
+ *
+ * @param cache Pointer to the glyph cache
+ * @param renderer Renderer that owns the atlas
+ * @param font Font to rasterize with
+ * @return bool True if the atlas is usable
+ */
+bool glyph_cache_prepare(GlyphCache* cache, SDL_Renderer* renderer, TTF_Font* font);
+
+/**
+ * @brief Write the atlas to the cache directory if glyphs were added
+ *
+ * @param cache Pointer to the glyph cache
+ */
+void glyph_cache_save(GlyphCache* cache);
+
+/**
+ * @brief Render a glyph into the atlas and cache it
+ *
+ * Glyphs that come out in color go to the color page instead.
+ *
+ * @param font Primary font
+ * @param cache Glyph cache, prepared with glyph_cache_prepare()
  * @param c Character to render
- * @param fg Foreground color
- * @param bg Background color
  * @param attributes Character attributes
- * @param texture Output for the cached texture
- * @param w Output for texture width
- * @param h Output for texture height
- * @return bool True if rendering succeeded
- */
-bool render_and_cache_glyph(SDL_Renderer* renderer, TTF_Font* font, GlyphCache* cache,
-                            uint32_t c, SDL_Color fg, SDL_Color bg, unsigned char attributes,
-                            SDL_Texture** texture, int* w, int* h);
+ * @param font_index Font in the fallback chain (see font_fallback_resolve())
+ * @return GlyphCacheEntry* The new entry, or NULL if rendering failed
+ */
+GlyphCacheEntry* render_and_cache_glyph(TTF_Font* font, GlyphCache* cache, uint32_t c,
+                                        unsigned char attributes, unsigned font_index);
+
+/**
+ * @brief Find the glyph for a cell, rasterizing it on a miss
+ *
+ * Resolves the font in the fallback chain and caches the glyph under it.
+ *
+ * @param cache Glyph cache, prepared with glyph_cache_prepare()
+ * @param font Primary font
+ * @param c Character or cluster id
+ * @param attributes Character attributes
+ * @return GlyphCacheEntry* The entry, or NULL if the glyph cannot be drawn
+ */
+GlyphCacheEntry* glyph_cache_lookup(GlyphCache* cache, TTF_Font* font, uint32_t c, unsigned char attributes);
+
+/**
+ * @brief Set the color the next atlas draws are tinted with
+ *
+ * @param cache Glyph cache
+ * @param fg Foreground color
+ */
+void glyph_cache_tint(GlyphCache* cache, SDL_Color fg);
 
 #endif // GLYPH_CACHE_H
@@ -0,0 +1,55 @@
+/**
+ * @file glyph_cluster.h
+ * @brief Interned grapheme clusters for cells that hold more than one codepoint.
+ *
+ * A cell with combining marks or a ZWJ sequence stores a cluster id in
+ * Glyph.character instead of its first codepoint. Ids have
+ * GLYPH_CLUSTER_FLAG set, which no codepoint has, so the glyph cache keys
+ * a cluster like any single character. Ids stay valid for the whole
+ * session and are not meaningful across sessions.
+ */
+
+#ifndef GLYPH_CLUSTER_H
+#define GLYPH_CLUSTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GLYPH_CLUSTER_FLAG 0x80000000u
+#define GLYPH_CLUSTER_MAX_CHARS 8       // Codepoints kept per cluster
+#define GLYPH_CLUSTER_MAX 16384         // Distinct clusters per session
+
+static inline bool glyph_is_cluster(uint32_t character)
+{
+    return (character & GLYPH_CLUSTER_FLAG) != 0;
+}
+
+/**
+ * @brief Returns the character to store for a cell's codepoints.
+ *
+ * A single codepoint is returned as is. Once GLYPH_CLUSTER_MAX clusters
+ * exist, new ones degrade to their first codepoint.
+ * @param chars Codepoints of the cell, base character first.
+ * @param count Number of @p chars.
+ */
+uint32_t glyph_cluster_intern(const uint32_t* chars, int count);
+
+/**
+ * @brief Returns the codepoints of @p character.
+ * @param character Codepoint or cluster id.
+ * @param count Output for the number of codepoints.
+ * @return The codepoints; a plain codepoint yields NULL and *count = 0.
+ */
+const uint32_t* glyph_cluster_chars(uint32_t character, int* count);
+
+/**
+ * @brief Returns the base (first) codepoint of @p character.
+ */
+uint32_t glyph_cluster_base(uint32_t character);
+
+/**
+ * @brief Frees every cluster. Ids handed out before become invalid.
+ */
+void glyph_cluster_reset(void);
+
+#endif // GLYPH_CLUSTER_H
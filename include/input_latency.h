@@ -0,0 +1,62 @@
+/**
+ * @file input_latency.h
+ * @brief Keypress-to-photon latency measurement.
+ *
+ * An input event that results in a PTY write starts a measurement. It
+ * completes on the first presented frame after the child has answered
+ * (PTY data arrived) and the cursor row was repainted. Samples go into
+ * a histogram that is logged periodically and at exit.
+ */
+
+#ifndef INPUT_LATENCY_H
+#define INPUT_LATENCY_H
+
+#include <stdbool.h>
+
+#include "terminal_state.h"
+
+/**
+ * @brief Notes that a user input event is being handled.
+ */
+void input_latency_event(void);
+
+/**
+ * @brief Notes a write to the PTY; turns a pending input event into a measurement.
+ */
+void input_latency_pty_write(void);
+
+/**
+ * @brief Notes that output from the child arrived.
+ */
+void input_latency_pty_data(void);
+
+/**
+ * @brief Checks, before rendering, whether this frame shows the echo.
+ * @param term Terminal instance (dirty rows and cursor position).
+ */
+void input_latency_frame_begin(const Terminal* term);
+
+/**
+ * @brief Completes the measurement once the frame has been presented.
+ */
+void input_latency_frame_presented(void);
+
+/**
+ * @brief Drops input events that did not reach the PTY and logs periodically.
+ *
+ * Called once per main loop iteration.
+ */
+void input_latency_tick(void);
+
+/**
+ * @brief Gets percentiles over all samples so far.
+ * @return false if there are no samples yet.
+ */
+bool input_latency_percentiles(double* p50_ms, double* p99_ms);
+
+/**
+ * @brief Logs the full histogram.
+ */
+void input_latency_dump(void);
+
+#endif // INPUT_LATENCY_H
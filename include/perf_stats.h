@@ -0,0 +1,98 @@
+/**
+ * @file perf_stats.h
+ * @brief Always-on frame timing counters behind the performance HUD.
+ *
+ * Collection is a handful of counter adds per frame, so it stays compiled
+ * into release builds. Counters accumulate over a one-second window which
+ * is then published as a PerfSnapshot for the HUD.
+ */
+
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <SDL.h>
+
+#include "terminal_state.h"
+
+typedef enum {
+    PERF_STAGE_DRAIN,     // read() from the PTY
+    PERF_STAGE_PARSE,     // libvterm parsing, excluding cell conversion
+    PERF_STAGE_CONVERT,   // Damage callbacks converting cells into the grid
+    PERF_STAGE_DRAW,      // terminal_render
+    PERF_STAGE_PRESENT,   // SDL_RenderPresent
+    PERF_STAGE_COUNT
+} PerfStage;
+
+typedef struct {
+    uint64_t stage_ticks[PERF_STAGE_COUNT];
+    uint64_t pty_bytes;
+    uint64_t draw_calls;
+    uint32_t frames;
+} PerfCounters;
+
+typedef struct {
+    double stage_ms[PERF_STAGE_COUNT]; // Average per rendered frame
+    double frame_ms;                   // Sum of the stages
+    double fps;
+    double pty_bytes_per_s;
+    double draw_calls;                 // Average per rendered frame
+    double glyph_hit_rate;             // 0..1 over the window
+    int glyph_entries;
+    size_t scrollback_bytes;
+} PerfSnapshot;
+
+// Current window; written directly by the inline helpers below.
+extern PerfCounters g_perf;
+
+static inline uint64_t perf_now(void)
+{
+    return SDL_GetPerformanceCounter();
+}
+
+static inline void perf_stage_add(PerfStage stage, uint64_t ticks)
+{
+    g_perf.stage_ticks[stage] += ticks;
+}
+
+static inline void perf_count_draw_call(void)
+{
+    g_perf.draw_calls++;
+}
+
+static inline void perf_count_pty_bytes(size_t bytes)
+{
+    g_perf.pty_bytes += bytes;
+}
+
+/**
+ * @brief Closes a rendered frame and publishes the window once a second.
+ * @param term Terminal instance (glyph cache and scrollback figures).
+ * @return true if a new snapshot was published.
+ */
+bool perf_frame_end(Terminal* term);
+
+/**
+ * @brief Returns the most recently published snapshot.
+ */
+const PerfSnapshot* perf_snapshot(void);
+
+/**
+ * @brief Returns a counter that changes whenever a snapshot is published.
+ */
+uint32_t perf_snapshot_generation(void);
+
+/**
+ * @brief Shows or hides the HUD.
+ * @return The new visibility.
+ */
+bool perf_hud_toggle(void);
+
+/**
+ * @brief Returns true while the HUD is shown.
+ */
+bool perf_hud_visible(void);
+
+#endif // PERF_STATS_H
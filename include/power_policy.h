@@ -0,0 +1,88 @@
+/**
+ * @file power_policy.h
+ * @brief Battery- and temperature-aware render rate, blink and idle sleep.
+ *
+ * Battery state comes from the power_supply class and temperatures from
+ * the thermal class in sysfs. Both directories are configurable, so the
+ * policy can be driven from fake trees. Each PowerProfile has its own
+ * PowerProfileSettings in the Config.
+ */
+
+#ifndef POWER_POLICY_H
+#define POWER_POLICY_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "terminal_state.h"
+
+#define POWER_POLICY_POLL_MS 5000   // sysfs is re-read this often
+#define POWER_HOT_HYSTERESIS_C 5    // Cooling this far below hot_temp_c leaves POWER_PROFILE_HOT
+
+typedef struct {
+    bool has_battery;
+    bool on_battery;    // A battery is discharging and no charger is online
+    int capacity;       // Lowest battery capacity in %, -1 if unknown
+    int temp_c;         // Hottest thermal zone in degrees C, -1 if unknown
+} PowerState;
+
+/**
+ * @brief Reads battery and temperature state.
+ * @param supply_path power_supply class directory, or NULL.
+ * @param thermal_path thermal class directory, or NULL.
+ * @param out Filled in; missing files leave the defaults (AC, unknown).
+ */
+void power_policy_read(const char* supply_path, const char* thermal_path, PowerState* out);
+
+/**
+ * @brief Picks the profile for @p state.
+ *
+ * Heat wins over battery level. Once hot, the profile only changes when
+ * the temperature is POWER_HOT_HYSTERESIS_C below the limit.
+ * @param current The profile in effect, for the hysteresis.
+ */
+PowerProfile power_policy_classify(const PowerState* state, int low_battery_pct, int hot_temp_c,
+                                   PowerProfile current);
+
+/**
+ * @brief Returns the config file name of @p profile ("ac", "battery", ...).
+ */
+const char* power_profile_name(PowerProfile profile);
+
+/**
+ * @brief Takes paths, thresholds and profiles from @p config and reads the state once.
+ */
+void power_policy_init(const Config* config);
+
+/**
+ * @brief Re-reads the state now.
+ * @return true if the profile changed.
+ */
+bool power_policy_refresh(void);
+
+/**
+ * @brief Re-reads the state when POWER_POLICY_POLL_MS have passed since the last read.
+ * @return true if the profile changed.
+ */
+bool power_policy_poll(Uint32 now);
+
+/**
+ * @brief Returns the profile in effect.
+ */
+PowerProfile power_policy_profile(void);
+
+/**
+ * @brief Returns the render rate: the profile's, capped at @p target_fps.
+ */
+int power_policy_fps(int target_fps);
+
+/**
+ * @brief Returns false while the profile holds the cursor on.
+ */
+bool power_policy_blink(void);
+
+/**
+ * @brief Returns how long a main loop pass lasts while idle.
+ */
+Uint32 power_policy_idle_ms(void);
+
+#endif // POWER_POLICY_H
@@ -0,0 +1,79 @@
+/**
+ * @file quality_governor.h
+ * @brief Trades rendering quality for frame time under sustained load.
+ *
+ * The busy time of each rendered frame is compared with the frame budget of
+ * the effective rate: --fps, or less where the power profile caps it.
+ * When it stays above the high threshold, quality drops one tier at a
+ * time; when it stays below the low threshold, or nothing is drawn for a
+ * while, it climbs back. PTY parsing is never slowed down.
+ */
+
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include "terminal_state.h"
+
+typedef enum {
+    QUALITY_TIER_FULL,          // Everything on
+    QUALITY_TIER_SHADED_GLYPHS, // New glyphs rasterized with TTF_RenderUTF8_Shaded
+    QUALITY_TIER_NO_BACKGROUND, // Background image not blended under the grid
+    QUALITY_TIER_NO_BLINK,      // Cursor and blinking text held on
+    QUALITY_TIER_LOW_RATE,      // Half the frame rate, new glyphs Solid
+    QUALITY_TIER_COUNT
+} QualityTier;
+
+/**
+ * @brief Takes the budget and thresholds from @p config and starts at full quality.
+ */
+void quality_governor_init(const Config* config);
+
+/**
+ * @brief Takes the budget from the frame rate in effect, e.g. after a power profile change.
+ * @param fps Frames per second; 0 falls back to 30 as at init.
+ */
+void quality_governor_set_fps(int fps);
+
+/**
+ * @brief Accounts for a rendered frame.
+ * @param now SDL_GetTicks() after the frame.
+ * @param busy_ms Time spent drawing and presenting it.
+ * @return true if the tier changed.
+ */
+bool quality_governor_frame(Uint32 now, double busy_ms);
+
+/**
+ * @brief Lets the tier recover while nothing is being drawn.
+ * @return true if the tier changed.
+ */
+bool quality_governor_idle(Uint32 now);
+
+/**
+ * @brief Returns the current tier.
+ */
+QualityTier quality_governor_tier(void);
+
+/**
+ * @brief Returns the rasterization mode for glyphs added at this tier.
+ */
+GlyphRasterMode quality_governor_raster_mode(void);
+
+/**
+ * @brief Returns false while the background image blend is skipped.
+ */
+bool quality_governor_draw_background(void);
+
+/**
+ * @brief Returns false while the cursor is held on instead of blinking.
+ */
+bool quality_governor_blink(void);
+
+/**
+ * @brief Returns the least time between two renders, 0 when only the frame cap applies.
+ * @param frame_ms The effective frame interval.
+ */
+Uint32 quality_governor_render_gap(Uint32 frame_ms);
+
+#endif // QUALITY_GOVERNOR_H
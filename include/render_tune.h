@@ -0,0 +1,43 @@
+/**
+ * @file render_tune.h
+ * @brief First-run choice of the fastest renderer configuration.
+ *
+ * Every render driver SDL offers is timed on a standard frame mix with
+ * vsync off and on, at the color depth the user runs with. Only the driver
+ * and vsync are chosen: the depth changes what is drawn (RGB565 colors,
+ * 16 coverage levels), so it stays the user's choice. The winner is written
+ * to renderer.conf in the config directory together with an id of the
+ * device, and reused on later launches until the device or the depth
+ * changes, or --retune is given.
+ */
+
+#ifndef RENDER_TUNE_H
+#define RENDER_TUNE_H
+
+#include <SDL.h>
+#include <stdbool.h>
+
+typedef struct {
+    char driver[32];    // SDL render driver name
+    bool vsync;
+    int color_depth;    // Depth it was measured at, 16 or 32
+    double frame_ms;    // Busy time of one frame of the mix
+} RenderTuneResult;
+
+/**
+ * @brief Loads the saved choice for this device, or measures and saves one.
+ * @param win Window the renderers are created for.
+ * @param retune Measure even if a saved choice exists.
+ * @param color_depth Depth to measure at, 16 or 32; never changed by the tune.
+ * @param out The chosen configuration.
+ * @return true if @p out holds a configuration.
+ */
+bool render_tune_select(SDL_Window* win, bool retune, int color_depth, RenderTuneResult* out);
+
+/**
+ * @brief Creates a renderer for a configuration chosen by render_tune_select().
+ * @return The renderer, or NULL if the driver is gone or fails.
+ */
+SDL_Renderer* render_tune_create_renderer(SDL_Window* win, const RenderTuneResult* tune);
+
+#endif // RENDER_TUNE_H
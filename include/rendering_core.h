@@ -83,4 +83,23 @@ void render_glyph_at(SDL_Renderer* renderer, Terminal* term, TTF_Font* font,
  */
 void render_credit_screen(SDL_Renderer* renderer, TTF_Font* font, int win_w, int win_h);
 
+/**
+ * @brief Render the performance HUD in the top-right corner
+ *
+ * The panel is rebuilt only when perf_stats publishes a new snapshot.
+ *
+ * @param renderer SDL renderer
+ * @param font Font to use for rendering
+ * @param win_w Window width in pixels
+ */
+void render_perf_hud(SDL_Renderer* renderer, TTF_Font* font, int win_w);
+
+/**
+ * @brief Memory a texture takes at its pixel format
+ *
+ * @param texture Texture, may be NULL
+ * @return size_t Bytes, 0 for NULL
+ */
+size_t render_texture_bytes(SDL_Texture* texture);
+
 #endif // RENDERING_CORE_H
@@ -0,0 +1,94 @@
+/**
+ * @file resource_bundle.h
+ * @brief Precompiled cache of OSK layouts, key sets and colorschemes.
+ *
+ * The text files under res/ are parsed once and stored in a single binary
+ * bundle in the cache directory (see cache_file.h). An entry is valid while
+ * the source file keeps its mtime and size. On later starts the loaders
+ * hand out pointers into the read-only mapping instead of re-parsing:
+ * key sets get one allocation for the key array, with display names and
+ * sequences borrowed from the bundle (SpecialKeySet.borrowed_strings).
+ *
+ * Not thread-safe; callers load resources from one thread at a time.
+ */
+
+#ifndef RESOURCE_BUNDLE_H
+#define RESOURCE_BUNDLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <SDL.h>
+
+#include "terminal_state.h"
+
+// Bump when the record layout or the SpecialKeyType/InternalCommand numbering changes
+#define RESOURCE_BUNDLE_VERSION 1
+
+typedef enum {
+    THEME_SLOT_PALETTE,
+    THEME_SLOT_FOREGROUND,
+    THEME_SLOT_BACKGROUND,
+    THEME_SLOT_CURSOR
+} ThemeSlot;
+
+// One assignment from a colorscheme file, applied in file order
+typedef struct {
+    uint16_t slot;      // ThemeSlot
+    uint16_t index;     // Palette index for THEME_SLOT_PALETTE
+    SDL_Color color;
+} ThemeColor;
+
+/**
+ * @brief Loads a precompiled .kb layout.
+ * @param path Layout source path.
+ * @param sets_by_modifier Output row arrays per modifier bucket, as filled by parse_layout_content().
+ * @param num_rows Output row counts per modifier bucket.
+ * @return true on a hit, false if the layout has to be parsed.
+ */
+bool resource_bundle_load_layout(const char* path, SpecialKeySet** sets_by_modifier, int* num_rows);
+
+/**
+ * @brief Stores a freshly parsed .kb layout.
+ */
+void resource_bundle_store_layout(const char* path, SpecialKeySet* const* sets_by_modifier, const int* num_rows);
+
+/**
+ * @brief Loads the keys of a precompiled .keys file into @p set.
+ *
+ * Only keys, num_keys and borrowed_strings are set.
+ * @return true on a hit, false if the file has to be parsed.
+ */
+bool resource_bundle_load_key_set(const char* path, SpecialKeySet* set);
+
+/**
+ * @brief Stores the keys of a freshly parsed .keys file.
+ */
+void resource_bundle_store_key_set(const char* path, const SpecialKeySet* set);
+
+/**
+ * @brief Loads a precompiled colorscheme.
+ * @param path Colorscheme source path.
+ * @param count Output for the number of assignments.
+ * @return Assignments inside the bundle, or NULL if the file has to be parsed.
+ */
+const ThemeColor* resource_bundle_load_theme(const char* path, size_t* count);
+
+/**
+ * @brief Stores the assignments of a freshly parsed colorscheme.
+ */
+void resource_bundle_store_theme(const char* path, const ThemeColor* colors, size_t count);
+
+/**
+ * @brief Writes the bundle if entries were stored since the last commit.
+ */
+void resource_bundle_commit(void);
+
+/**
+ * @brief Commits and releases the bundle.
+ *
+ * Borrowed key strings become invalid; call after the OSK has been freed.
+ */
+void resource_bundle_close(void);
+
+#endif // RESOURCE_BUNDLE_H
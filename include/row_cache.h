@@ -0,0 +1,101 @@
+/**
+ * @file row_cache.h
+ * @brief LRU of fully rendered terminal rows.
+ *
+ * Rows are keyed by a hash of their cells, so a row that comes back into
+ * view while scrolling through history, or a line that repeats (blank
+ * lines, separators, progress bar frames), is drawn with one blit instead
+ * of one per cell.
+ *
+ * @author VaixTerm Team
+ * @date 2024
+ */
+
+#ifndef ROW_CACHE_H
+#define ROW_CACHE_H
+
+#include <SDL.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "terminal_state.h"
+
+#define ROW_CACHE_SIZE 64       // Row textures kept, win_w * char_h pixels each in the screen's format
+#define ROW_CACHE_SEEN 256      // Hashes remembered to spot repeated live rows
+
+typedef struct RowCache RowCache;
+
+/**
+ * @brief Create an empty row cache
+ *
+ * @return RowCache* The cache, or NULL on allocation failure
+ */
+RowCache* row_cache_create(void);
+
+/**
+ * @brief Destroy the cache and its textures
+ *
+ * @param cache Row cache (may be NULL)
+ */
+void row_cache_destroy(RowCache* cache);
+
+/**
+ * @brief Drop every row, e.g. after render targets were lost
+ *
+ * @param cache Row cache (may be NULL)
+ */
+void row_cache_clear(RowCache* cache);
+
+/**
+ * @brief Combine everything besides the cells that row pixels depend on
+ *
+ * @param fields Values such as cell size, window width, colors
+ * @param count Number of @p fields
+ * @return uint64_t Salt for row_cache_hash(), also checked on every hit
+ */
+uint64_t row_cache_salt(const uint64_t* fields, size_t count);
+
+/**
+ * @brief Hash a row of cells
+ *
+ * @param line Cells of the row
+ * @param cols Number of cells
+ * @param salt From row_cache_salt()
+ * @return uint64_t Row hash
+ */
+uint64_t row_cache_hash(const Glyph* line, int cols, uint64_t salt);
+
+/**
+ * @brief Draw a cached row
+ *
+ * @param cache Row cache
+ * @param renderer Renderer, targeting the screen texture
+ * @param hash Hash from row_cache_hash()
+ * @param salt Salt the hash was made with, compared against the cached one
+ * @param line Cells of the row, compared against the cached copy
+ * @param cols Number of cells
+ * @param dst Destination rectangle of the row
+ * @return bool True if the row was drawn from the cache
+ */
+bool row_cache_blit(RowCache* cache, SDL_Renderer* renderer, uint64_t hash, uint64_t salt,
+                    const Glyph* line, int cols, const SDL_Rect* dst);
+
+/**
+ * @brief Keep a row that was just drawn glyph by glyph
+ *
+ * Rows are admitted on their second sighting unless @p admit is set, so
+ * live rows that change every frame do not churn the cache.
+ *
+ * @param cache Row cache
+ * @param renderer Renderer, targeting @p source; the target is restored
+ * @param source Texture the row was drawn into
+ * @param hash Hash from row_cache_hash()
+ * @param salt Salt the hash was made with
+ * @param line Cells of the row
+ * @param cols Number of cells
+ * @param rect Rectangle of the row in @p source
+ * @param admit Store the row on first sight (history rows)
+ */
+void row_cache_capture(RowCache* cache, SDL_Renderer* renderer, SDL_Texture* source, uint64_t hash,
+                       uint64_t salt, const Glyph* line, int cols, const SDL_Rect* rect, bool admit);
+
+#endif // ROW_CACHE_H
@@ -0,0 +1,107 @@
+/**
+ * @file session_record.h
+ * @brief Timestamped PTY session recording and deterministic replay.
+ */
+
+#ifndef SESSION_RECORD_H
+#define SESSION_RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "terminal_state.h"
+
+typedef enum {
+    SESSION_EVENT_OUTPUT,   // Bytes read from the PTY (fed to the terminal)
+    SESSION_EVENT_INPUT,    // Bytes written to the PTY (keys, replies)
+    SESSION_EVENT_RESIZE    // Terminal grid resized
+} SessionEventType;
+
+typedef struct {
+    SessionEventType type;
+    uint64_t time_us;       // Microseconds since the recording started
+    const char* data;       // OUTPUT/INPUT payload, valid until the replay is closed
+    uint32_t len;
+    int cols, rows;         // RESIZE only
+} SessionEvent;
+
+/**
+ * @brief Starts recording to @p path, truncating any existing file.
+ * @param path Recording file path.
+ * @param cols Initial terminal columns.
+ * @param rows Initial terminal rows.
+ * @return true on success, false on failure.
+ */
+bool session_record_start(const char* path, int cols, int rows);
+
+/**
+ * @brief Flushes and closes the recording, if any.
+ */
+void session_record_stop(void);
+
+/**
+ * @brief Flushes buffered events so a kill does not lose them.
+ */
+void session_record_flush(void);
+
+/**
+ * @brief Records a chunk read from the PTY. No-op when not recording.
+ */
+void session_record_output(const char* data, size_t len);
+
+/**
+ * @brief Records a resize of the terminal grid. No-op when not recording.
+ */
+void session_record_resize(int cols, int rows);
+
+/**
+ * @brief Writes input to the PTY and records it.
+ *
+ * All writes to the PTY master go through here so recordings carry input
+ * timing and input latency measurements start at the write. A negative
+ * @p fd (replay) records nothing and writes nothing.
+ * @return Result of write(), or @p len when there is no PTY.
+ */
+ssize_t session_record_write(int fd, const char* data, size_t len);
+
+/**
+ * @brief Loads a recording for replay.
+ * @param path Recording file path.
+ * @param cols Output for the recorded initial columns (may be NULL).
+ * @param rows Output for the recorded initial rows (may be NULL).
+ * @return true on success, false on failure.
+ */
+bool session_replay_open(const char* path, int* cols, int* rows);
+
+/**
+ * @brief Returns the next event of the open recording.
+ * @return false at the end of the recording.
+ */
+bool session_replay_next(SessionEvent* event);
+
+/**
+ * @brief Returns true while a recording is open for replay.
+ */
+bool session_replay_active(void);
+
+/**
+ * @brief Feeds the terminal with the events that are due.
+ *
+ * In real-time mode events are due once their timestamp has elapsed since
+ * the first pump; in fast mode a fixed byte budget is fed per call. Output
+ * chunks are fed with their recorded boundaries and resizes are applied, so
+ * the resulting screen is identical on every run. Input events are skipped.
+ * @param term Terminal instance.
+ * @param fast Ignore recorded timing.
+ * @return Bytes fed, or -1 once the recording is exhausted.
+ */
+long session_replay_pump(Terminal* term, bool fast);
+
+/**
+ * @brief Releases the replayed recording.
+ */
+void session_replay_close(void);
+
+#endif // SESSION_RECORD_H
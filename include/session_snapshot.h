@@ -0,0 +1,45 @@
+/**
+ * @file session_snapshot.h
+ * @brief Saving and restoring terminal sessions across app restarts.
+ */
+
+#ifndef SESSION_SNAPSHOT_H
+#define SESSION_SNAPSHOT_H
+
+#include <stdbool.h>
+
+#include "terminal_state.h"
+
+/**
+ * @brief Writes the terminal and OSK state to a snapshot file.
+ *
+ * The file is written next to @p path and renamed into place, so a kill
+ * during the save leaves the previous snapshot intact.
+ * @param path Snapshot file path.
+ * @param term Terminal instance.
+ * @param osk OSK instance (may be NULL).
+ * @return true on success, false on failure.
+ */
+bool session_snapshot_save(const char* path, Terminal* term, const OnScreenKeyboard* osk);
+
+/**
+ * @brief Restores a snapshot written by session_snapshot_save().
+ *
+ * Restores scrollback, screen cells, cursor, cursor modes, the scroll
+ * position and the OSK selection. The terminal should already have its
+ * final size; mismatched snapshots are clipped or padded.
+ * @param path Snapshot file path.
+ * @param term Terminal instance.
+ * @param osk OSK instance (may be NULL).
+ * @return true if a snapshot was found and restored. A corrupt or truncated
+ *         snapshot leaves the terminal reset, is removed, and returns false.
+ */
+bool session_snapshot_restore(const char* path, Terminal* term, OnScreenKeyboard* osk);
+
+/**
+ * @brief Removes a snapshot so the next launch starts fresh.
+ * @param path Snapshot file path.
+ */
+void session_snapshot_discard(const char* path);
+
+#endif // SESSION_SNAPSHOT_H
@@ -0,0 +1,90 @@
+/**
+ * @file soft_render.h
+ * @brief CPU compositor for the terminal grid on the software renderer.
+ *
+ * With SDL's software renderer every glyph SDL_RenderCopy is a generic
+ * blit with color modulation. Instead, cells are composited into a frame
+ * buffer straight from the glyph atlas coverage, and only the pixel rows
+ * that changed are copied into a streaming screen texture.
+ */
+
+#ifndef SOFT_RENDER_H
+#define SOFT_RENDER_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "terminal_state.h"
+
+/**
+ * @brief Returns true if @p renderer draws on the CPU.
+ */
+bool soft_render_supported(SDL_Renderer* renderer);
+
+/**
+ * @brief Creates a streaming screen texture and a frame buffer to match.
+ *
+ * The frame buffer is always ARGB8888; rows are converted while they are
+ * uploaded when @p format differs. The previous frame buffer is kept if
+ * anything fails, so the caller can fall back to a render target texture.
+ * @return The texture, owned by the caller, or NULL.
+ */
+SDL_Texture* soft_render_create_target(SDL_Renderer* renderer, int w, int h, Uint32 format);
+
+/**
+ * @brief Returns true if @p screen_texture is the compositor's texture.
+ */
+bool soft_render_active(SDL_Texture* screen_texture);
+
+/**
+ * @brief Fills the whole frame with @p bg.
+ */
+void soft_render_clear(SDL_Color bg);
+
+/**
+ * @brief Composites view row @p y: default background, cell backgrounds, glyphs.
+ */
+void soft_render_row(Terminal* term, TTF_Font* font, int y, int char_w, int char_h);
+
+/**
+ * @brief Composites only the cells of view row @p y that have ATTR_BLINK.
+ */
+void soft_render_blink_cells(Terminal* term, TTF_Font* font, int y, int char_w, int char_h);
+
+/**
+ * @brief Copies the pixel rows changed since the last flush into @p texture.
+ */
+void soft_render_flush(SDL_Texture* texture);
+
+/**
+ * @brief Returns the number of pixels in the frame buffer, 0 without one.
+ */
+size_t soft_render_frame_pixels(void);
+
+/**
+ * @brief Copies the frame buffer into @p dst, soft_render_frame_pixels() long.
+ */
+void soft_render_save(uint32_t* dst);
+
+/**
+ * @brief Replaces the frame buffer with a copy made by soft_render_save().
+ *
+ * Every row is uploaded by the next soft_render_flush().
+ */
+void soft_render_restore(const uint32_t* src);
+
+/**
+ * @brief Blends a coverage span tinted with @p fg over ARGB8888 pixels.
+ *
+ * The kernel soft_render_row() uses, exposed so the renderer tuner can
+ * time it.
+ */
+void soft_render_blend_span(uint32_t* dst, const uint8_t* mask, int n, SDL_Color fg);
+
+/**
+ * @brief Frees the frame buffer.
+ */
+void soft_render_cleanup(void);
+
+#endif // SOFT_RENDER_H
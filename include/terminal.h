@@ -11,11 +11,14 @@ void terminal_resize(Terminal* term, int new_cols, int new_rows);
 
 // --- Terminal Grid Operations ---
 Glyph* terminal_get_view_line(Terminal* term, int y);
+int terminal_get_blink_cells(Terminal* term, int y);   // Cells with ATTR_BLINK in live row y
+bool terminal_has_blink_text(Terminal* term);
 
 // --- ANSI Parser ---
 void terminal_handle_input(Terminal* term, const char* buf, size_t len);
 void terminal_load_colorscheme(Terminal* term, const char* path);
 void sgr_to_color(Terminal* term, int color_index, SDL_Color* color);
 int terminal_get_scrollback_count(Terminal* term);
+bool terminal_sync_output_held(const Terminal* term, Uint32 now);   // Mode 2026 update in progress, within its timeout
 
 #endif // TERMINAL_H
@@ -1,6 +1,7 @@
 #ifndef TERMINAL_LIBVTERM_H
 #define TERMINAL_LIBVTERM_H
 
+#include <stdio.h>
 #include <vterm.h>
 #include "terminal_state.h"
 
@@ -26,7 +27,28 @@ void terminal_libvterm_flush_damage(Terminal* term);
 size_t terminal_libvterm_flush_output(Terminal* term, char* dst, size_t dst_len);
 
 Glyph* terminal_libvterm_get_view_line(Terminal* term, int y);
+int terminal_libvterm_get_blink_cells(Terminal* term, int y);
 int terminal_libvterm_get_scrollback_count(Terminal* term);
+size_t terminal_libvterm_get_scrollback_bytes(Terminal* term);
+
+/**
+ * @brief Serializes the scrollback, screen cells, cursor and cursor modes.
+ *
+ * While the alternate screen is up, the primary screen as it was at the
+ * switch is written instead.
+ * @return true if everything was written; false also if the primary
+ *         screen could not be kept
+ */
+bool terminal_libvterm_save_state(Terminal* term, FILE* file);
+
+/**
+ * @brief Restores state written by terminal_libvterm_save_state().
+ *
+ * The snapshot may come from a different terminal size: lines are clipped
+ * or padded, and rows that no longer fit go to scrollback.
+ * @return true if the whole state was read
+ */
+bool terminal_libvterm_load_state(Terminal* term, FILE* file);
 
 #ifdef __cplusplus
 }
@@ -8,14 +8,15 @@
 #include <stdint.h> // For uint32_t, uint64_t
 
 // --- Constants ---
-#define CURSOR_BLINK_INTERVAL_MS 500 // Milliseconds for cursor blink toggle
+#define CURSOR_BLINK_INTERVAL_MS 500 // Milliseconds for cursor and text blink toggle
+#define SYNC_OUTPUT_TIMEOUT_MS 200   // Longest a synchronized update (mode 2026) holds rendering
 
 #define MOUSE_WHEEL_SCROLL_AMOUNT 3
 
 // --- Data Structures ---
 
 typedef struct {
-    uint32_t character; // Unicode codepoint. Can store multi-byte chars.
+    uint32_t character; // Unicode codepoint, or a cluster id (see glyph_cluster.h)
     SDL_Color fg; // Foreground color
     SDL_Color bg; // Background color
     unsigned char attributes; // Bitfield for text attributes
@@ -39,19 +40,61 @@ typedef struct {
 // --- Glyph Cache ---
 #define GLYPH_CACHE_SIZE 8192 // Increased cache size for better performance
 #define GLYPH_CACHE_LRU_SIZE 256 // LRU eviction tracking
+#define GLYPH_ATLAS_MAX_SIZE 2048 // Atlas edge, clamped to the renderer's texture limit
+#define GLYPH_COLOR_PAGE_SIZE 1024 // RGBA page for color glyphs, caps them at 4 MiB
+#define FONT_FALLBACK_MAX 8 // Fallback fonts after the primary
+
+// How new glyphs are rasterized; lower modes are cheaper
+typedef enum {
+    GLYPH_RASTER_BLENDED,   // Antialiased, the default
+    GLYPH_RASTER_SHADED,    // Antialiased against a solid background
+    GLYPH_RASTER_SOLID      // No antialiasing
+} GlyphRasterMode;
 
 typedef struct {
     uint64_t key;
-    SDL_Texture* texture;
+    SDL_Texture* texture; // The atlas texture, or the color page
+    SDL_Rect src;         // Glyph coverage inside the atlas
     int w, h;
+    bool color;           // Drawn as is from the color page, never tinted
+    bool coarse;          // Rasterized below GLYPH_RASTER_BLENDED, never saved
 } GlyphCacheEntry;
 
 typedef struct {
     GlyphCacheEntry entries[GLYPH_CACHE_SIZE];
     uint32_t access_counter; // Global access counter for LRU
     uint32_t last_access[GLYPH_CACHE_SIZE]; // Last access time for each entry
-    int hits;    // Cache hit counter
-    int misses;  // Cache miss counter
+    int hits;    // Lookups that found a glyph
+    int misses;  // Lookups that had to rasterize
+    int count;   // Entries in use
+
+    // Alpha-mask atlas: glyphs are stored white and tinted when drawn
+    SDL_Renderer* renderer;
+    SDL_Texture* atlas;
+    uint8_t* atlas_alpha;       // CPU copy of the coverage, atlas_size^2 bytes
+    int atlas_size;
+    int pen_x, pen_y, shelf_h;  // Shelf packer state
+    SDL_Color tint;             // Current color/alpha mod of the atlas
+    bool premultiplied;         // Atlas texels are (a, a, a, a), drawn with a premultiplied blend
+
+    // Identity of the on-disk atlas
+    char* font_file;
+    int font_size;
+    uint64_t font_id;           // 0 until glyph_cache_prepare() ran
+    bool dirty;                 // Glyphs were added since the atlas was loaded
+
+    const struct BitmapFont* bitmap_font; // Preferred over the TTF font, not owned
+    int color_depth;            // 16 stores the atlas as ARGB4444
+    GlyphRasterMode raster_mode; // Applies to glyphs rasterized from now on
+
+    // Fallback faces at font_size, opened on first use; [i] is font index i + 1
+    TTF_Font* fallback_faces[FONT_FALLBACK_MAX];
+    bool fallback_tried[FONT_FALLBACK_MAX];
+
+    // Color glyphs (emoji) live in their own RGBA page
+    SDL_Texture* color_page;
+    uint32_t* color_pixels;     // CPU copy of the color page for the software compositor
+    int color_pen_x, color_pen_y, color_shelf_h;
 } GlyphCache;
 
 // --- OSK Key Cache ---
@@ -109,13 +152,18 @@ typedef struct {
     bool cursor_style_blinking;
     bool cursor_visible;               // DECTCEM: Text Cursor Enable Mode (CSI ? 25 h/l)
     bool alt_screen_active;            // True if alternate screen is active
+    bool sync_output_active;           // Synchronized output (CSI ? 2026 h/l)
+    Uint32 sync_output_since;
 
     // Performance
     GlyphCache* glyph_cache;
+    struct RowCache* row_cache;        // Rendered rows by content, created on first render
+    struct AltScreenCache* alt_cache;  // Primary screen frame while the alternate screen is up
 
-    // Blinking cursor state
+    // Blink phase, shared by the cursor and text with ATTR_BLINK
     bool cursor_blink_on;
     Uint32 last_blink_toggle_time;
+    bool blink_repaint_needed;         // Phase changed: redraw the blinking cells of clean rows
 
     // Dirty line tracking for render optimization
     bool* dirty_lines;
@@ -127,6 +175,7 @@ typedef struct {
 
     // Color palette and background
     SDL_Color palette[256];  // Color palette for indexed colors
+    int color_depth;         // 16: every color above is kept RGB565-exact
 
     // Double buffering
     SDL_Texture* screen_texture;
@@ -137,23 +186,54 @@ typedef struct {
 
     // Background image
     SDL_Texture* background_texture;
+    SDL_Texture* background_scaled;  // background_texture at window size, built on first use
 
     // libvterm backend
     void* backend;
 } Terminal;
 
+// --- Power Profiles ---
+typedef enum {
+    POWER_PROFILE_AC,           // On mains power, or no battery at all
+    POWER_PROFILE_BATTERY,
+    POWER_PROFILE_LOW_BATTERY,  // Discharging at or below low_battery_pct
+    POWER_PROFILE_HOT,          // A thermal zone at or above hot_temp_c
+    POWER_PROFILE_COUNT
+} PowerProfile;
+
+typedef struct {
+    int fps;        // Render rate, capped at target_fps; 0 = target_fps
+    bool blink;     // Cursor blinks; held on otherwise
+    int idle_ms;    // Sleep per main loop pass while nothing changes
+} PowerProfileSettings;
+
 // --- Main Configuration Struct ---
 typedef struct {
     int win_w;
     int win_h;
     char* font_path;
     int font_size;
+    char* bitmap_font_path;     // PSF/BDF font for the grid, NULL = use font_path
+    char** fallback_fonts;      // Tried in order for codepoints font_path lacks
+    int num_fallback_fonts;
     char* custom_command;
     int scrollback_lines;
     bool force_full_render;
     char* background_image_path;
     char* colorscheme_path;
     int target_fps;
+    int color_depth;           // 32, or 16 for the RGB565 low-memory pipeline (only on request)
+    bool retune_renderer;      // Measure renderer configurations again at startup
+    int governor_high_pct;     // Frame time, in % of the --fps budget, that lowers quality; 0 = off
+    int governor_low_pct;      // Frame time, in % of the budget, below which quality recovers
+    int governor_hold_ms;      // How long either must last before a tier changes
+    char* power_supply_path;   // sysfs power_supply class directory, NULL = always AC
+    char* thermal_path;        // sysfs thermal class directory, NULL = never hot
+    int low_battery_pct;
+    int hot_temp_c;
+    PowerProfileSettings power_profiles[POWER_PROFILE_COUNT];
+    bool pause_unfocused;      // Losing focus stops rendering like hiding the window
+    bool release_hidden;       // Free the glyph atlas and cached textures while not visible
     bool read_only;
     bool no_credit;
     int log_level;             // Runtime log level (0=debug..4=fatal)
@@ -170,6 +250,12 @@ typedef struct {
     // OSK appearance
     int osk_alpha;          // 0-255, default 220
     int osk_bar_height;     // pixels, 0 = use char_h
+
+    char* session_path;     // Session snapshot file, NULL = no save/resume
+    char* record_path;      // PTY recording output file, NULL = off
+    char* replay_path;      // Recording to play back instead of a shell
+    bool replay_fast;       // Ignore recorded timing during replay
+    char* trace_path;       // Chrome trace output file, NULL = off
 } Config;
 
 // --- On-Screen Keyboard ---
@@ -189,6 +275,7 @@ typedef struct {
     bool is_dynamic;     // True if this set was loaded from a file and needs to be freed
     char* file_path;     // Path to the .keys file if loaded dynamically
     int active_mod_mask; // Modifiers that are active for this layer
+    bool borrowed_strings; // Key strings point into the resource bundle and are not freed
 } SpecialKeySet;
 
 // --- Special Keys for OSK ---
@@ -289,8 +376,9 @@ typedef enum {
     CMD_TERMINAL_RESET,
     CMD_TERMINAL_CLEAR,
     CMD_OSK_TOGGLE_POSITION,
-    CMD_RELOAD_THEME
-} InternalCommand;
+    CMD_RELOAD_THEME,
+    CMD_PERF_HUD_TOGGLE
+} InternalCommand; // Stored in the resource bundle: append only, or bump RESOURCE_BUNDLE_VERSION
 
 typedef struct SpecialKey {
     char* display_name;
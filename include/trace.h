@@ -0,0 +1,62 @@
+/**
+ * @file trace.h
+ * @brief Scoped timing events exported as Chrome trace JSON (Perfetto).
+ *
+ * Each thread records into its own fixed ring buffer with no locking; the
+ * buffer keeps the most recent TRACE_BUFFER_EVENTS events. The file is
+ * written at exit and whenever the process receives SIGUSR1.
+ *
+ * Usage:
+ *   uint64_t t = trace_begin();
+ *   ... work ...
+ *   trace_end("pty_read", t, bytes);
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRACE_BUFFER_EVENTS (1 << 17) // Per thread, 24 bytes each
+
+extern bool g_trace_enabled;
+
+/**
+ * @brief Starts collecting events and arms the SIGUSR1 dump.
+ * @param path Output file, rewritten on every dump.
+ * @return true on success, false on failure.
+ */
+bool trace_start(const char* path);
+
+/**
+ * @brief Writes the trace file and stops collecting.
+ */
+void trace_stop(void);
+
+/**
+ * @brief Writes the trace file if SIGUSR1 arrived since the last call.
+ *
+ * Called from the main loop; the signal handler only sets a flag.
+ */
+void trace_poll(void);
+
+/**
+ * @brief Microsecond timestamp for trace_end(), 0 when tracing is off.
+ */
+uint64_t trace_begin(void);
+
+/**
+ * @brief Records a complete event that started at @p start.
+ * @param name Static event name (the pointer is stored, not copied).
+ * @param start Value returned by trace_begin().
+ * @param arg Event argument shown as args.v (bytes, row, codepoint...).
+ */
+void trace_end(const char* name, uint64_t start, int64_t arg);
+
+/**
+ * @brief Records a zero-duration event.
+ */
+void trace_instant(const char* name, int64_t arg);
+
+#endif // TRACE_H
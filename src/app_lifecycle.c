@@ -16,6 +16,8 @@
 #include <pwd.h>
 #include <sys/select.h>
 #include <time.h>
+#include <poll.h>
+#include <pthread.h>
 
 // PTY headers vary by OS
 #if defined(__linux__)
@@ -34,9 +36,21 @@
 #include "terminal.h"
 #include "terminal_libvterm.h"
 #include "rendering_core.h"
+#include "row_cache.h"
+#include "alt_screen_cache.h"
+#include "soft_render.h"
+#include "render_tune.h"
+#include "quality_governor.h"
+#include "power_policy.h"
 #include "event_handler.h"
 #include "font_manager.h"
 #include "config_manager.h"
+#include "session_snapshot.h"
+#include "session_record.h"
+#include "perf_stats.h"
+#include "trace.h"
+#include "input_latency.h"
+#include "resource_bundle.h"
 #include "error_codes.h"
 #include "config.h"
 #include "dirty_region_tracker.h"
@@ -44,6 +58,8 @@
 #include "osk_core.h"
 #include "osk_renderer.h"
 #include "glyph_cache.h"
+#include "font_fallback.h"
+#include "glyph_cluster.h"
 
 /**
  * @brief Sets up SDL video hints for cross-platform compatibility.
@@ -92,7 +108,7 @@ static void setup_gl_attributes(void)
  * @brief Initializes SDL subsystems and creates the main window and renderer.
  */
 bool app_init_sdl(SDL_Window** win, SDL_Renderer** renderer, TTF_Font** font, 
-                  const Config* config, int* char_w, int* char_h)
+                  Config* config, int* char_w, int* char_h)
 {
     // Set up video hints before initializing SDL
     setup_video_hints();
@@ -184,8 +200,19 @@ bool app_init_sdl(SDL_Window** win, SDL_Renderer** renderer, TTF_Font** font,
         {"Auto (no flags)", 0}
     };
     
+    // The first run measures every driver; later runs reuse the fastest
     bool renderer_created = false;
-    for (size_t i = 0; i < sizeof(renderer_configs) / sizeof(renderer_configs[0]); i++) {
+    RenderTuneResult tune;
+    bool tuned = render_tune_select(*win, config->retune_renderer, config->color_depth, &tune);
+    if (tuned) {
+        *renderer = render_tune_create_renderer(*win, &tune);
+        renderer_created = *renderer != NULL;
+        if (!renderer_created) {
+            WARN_LOG("Tuned renderer %s failed (%s), trying the default order", tune.driver, SDL_GetError());
+        }
+    }
+
+    for (size_t i = 0; !renderer_created && i < sizeof(renderer_configs) / sizeof(renderer_configs[0]); i++) {
         DEBUG_LOG("Trying renderer: %s", renderer_configs[i].name);
         *renderer = SDL_CreateRenderer(*win, -1, renderer_configs[i].flags);
         
@@ -223,7 +250,7 @@ bool app_init_sdl(SDL_Window** win, SDL_Renderer** renderer, TTF_Font** font,
 
     // Load the font
     DEBUG_LOG("Loading font: %s (size: %d)", config->font_path, config->font_size);
-    *font = TTF_OpenFont(config->font_path, config->font_size);
+    *font = font_open(config->font_path, config->font_size);
     if (!*font) {
         ERROR_LOG("Failed to load font! SDL_ttf Error: %s", TTF_GetError());
         // Try fallback font
@@ -241,10 +268,21 @@ bool app_init_sdl(SDL_Window** win, SDL_Renderer** renderer, TTF_Font** font,
     }
     DEBUG_LOG("Font loaded successfully");
 
+    // A bitmap font draws the grid; the TTF font stays for the OSK and HUD
+    if (config->bitmap_font_path && !font_manager_open_bitmap(config->bitmap_font_path)) {
+        WARN_LOG("Using %s for the terminal instead", config->font_path);
+    }
+
+    font_fallback_init(config->font_path, *font, config->fallback_fonts, config->num_fallback_fonts);
+    const BitmapFont* bitmap = font_manager_bitmap();
+    for (uint32_t i = 0; bitmap && i < bitmap->map_len; i++) {
+        font_fallback_add_primary(bitmap->map[i].codepoint);
+    }
+
     // Get character dimensions
     DEBUG_LOG("Getting font metrics...");
     int w, h;
-    if (TTF_SizeText(*font, "W", &w, &h) != 0) {
+    if (!font_cell_size(*font, &w, &h)) {
         ERROR_LOG("Failed to get font metrics! SDL_ttf Error: %s", TTF_GetError());
         TTF_CloseFont(*font);
         SDL_DestroyRenderer(*renderer);
@@ -302,6 +340,42 @@ void app_run_child_process(const Config* config)
     exit(1);
 }
 
+/**
+ * @brief Creates the texture the grid is drawn into.
+ *
+ * On the software renderer the grid is composited on the CPU into a
+ * streaming texture; a background image needs the render target path.
+ * At 16 bits the texture takes the window's format when that is 16-bit
+ * too, so presenting copies instead of converting.
+ */
+static SDL_Texture* create_screen_texture(SDL_Renderer* renderer, const Terminal* term, const Config* config)
+{
+    int w = config->win_w, h = config->win_h;
+    Uint32 format = SDL_PIXELFORMAT_RGBA8888;
+    if (config->color_depth == 16) {
+        SDL_Window* win = SDL_RenderGetWindow(renderer);
+        Uint32 native = win ? SDL_GetWindowPixelFormat(win) : SDL_PIXELFORMAT_UNKNOWN;
+        format = SDL_BITSPERPIXEL(native) == 16 ? native : SDL_PIXELFORMAT_RGB565;
+    }
+
+    SDL_Texture* texture = NULL;
+    if (!term->background_texture && soft_render_supported(renderer)) {
+        texture = soft_render_create_target(renderer, w, h, config->color_depth == 16 ? format : SDL_PIXELFORMAT_ARGB8888);
+    }
+    if (!texture) {
+        texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_TARGET, w, h);
+    }
+    if (!texture && format != SDL_PIXELFORMAT_RGB565 && config->color_depth == 16) {
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_TARGET, w, h);
+    }
+    if (texture) {
+        SDL_QueryTexture(texture, &format, NULL, NULL, NULL);
+        INFO_LOG("Screen texture %dx%d %s: %zu KiB (%zu KiB at 32 bits)", w, h, SDL_GetPixelFormatName(format),
+                 render_texture_bytes(texture) / 1024, (size_t)w * h * 4 / 1024);
+    }
+    return texture;
+}
+
 /**
  * @brief Initializes the terminal instance and related resources.
  */
@@ -316,10 +390,7 @@ Terminal* app_init_terminal(const Config* config, SDL_Renderer* renderer, int ch
         return NULL;
     }
 
-    term->screen_texture = SDL_CreateTexture(renderer,
-                           SDL_PIXELFORMAT_RGBA8888,
-                           SDL_TEXTUREACCESS_TARGET,
-                           config->win_w, config->win_h);
+    term->screen_texture = create_screen_texture(renderer, term, config);
     if (!term->screen_texture) {
         ERROR_LOG("Failed to create screen texture: %s", SDL_GetError());
         terminal_destroy(term);
@@ -341,14 +412,17 @@ Terminal* app_init_terminal(const Config* config, SDL_Renderer* renderer, int ch
         terminal_destroy(term);
         return NULL;
     }
+    glyph_cache_set_font(term->glyph_cache, config->font_path, config->font_size);
+    glyph_cache_set_bitmap_font(term->glyph_cache, font_manager_bitmap());
+    glyph_cache_set_color_depth(term->glyph_cache, config->color_depth);
 
     return term;
 }
 
 /**
- * @brief Initializes the On-Screen Keyboard.
+ * @brief Loads OSK layouts and key sets without touching SDL.
  */
-bool app_init_osk(OnScreenKeyboard* osk, const Config* config)
+bool app_load_osk(OnScreenKeyboard* osk, const Config* config)
 {
     // Initialize OSK structure
     *osk = (OnScreenKeyboard) {
@@ -423,11 +497,147 @@ bool app_init_osk(OnScreenKeyboard* osk, const Config* config)
         }
     }
 
+    return true;
+}
+
+/**
+ * @brief Initializes the On-Screen Keyboard.
+ */
+bool app_init_osk(OnScreenKeyboard* osk, const Config* config)
+{
+    if (!app_load_osk(osk, config)) {
+        return false;
+    }
     init_input_devices(osk, config);
-    
     return true;
 }
 
+// --- Overlapped startup ---
+//
+// The shell is forked before SDL comes up. Until the terminal exists a
+// reader thread keeps the PTY drained so the shell's startup output never
+// blocks on a full PTY buffer, while a second thread parses OSK files.
+
+#define STARTUP_BUFFER_MAX (4 * 1024 * 1024)
+
+struct AppStartup {
+    int master_fd;
+    pthread_t reader;
+    bool reader_started;
+    int stop;                 // Set with __atomic ops by the main thread
+    char* buf;
+    size_t len;
+    size_t cap;
+
+    OnScreenKeyboard* osk;
+    const Config* config;
+    pthread_t osk_thread;
+    bool osk_started;
+    bool osk_ok;
+};
+
+static void* startup_reader_main(void* arg)
+{
+    AppStartup* s = (AppStartup*)arg;
+    struct pollfd pfd = { .fd = s->master_fd, .events = POLLIN };
+
+    while (!__atomic_load_n(&s->stop, __ATOMIC_ACQUIRE)) {
+        if (poll(&pfd, 1, 20) <= 0) {
+            continue;
+        }
+        if (s->len == s->cap) {
+            size_t cap = s->cap ? s->cap * 2 : 16384;
+            if (cap > STARTUP_BUFFER_MAX) {
+                break; // Let the shell block; the main loop catches up
+            }
+            char* grown = realloc(s->buf, cap);
+            if (!grown) {
+                break;
+            }
+            s->buf = grown;
+            s->cap = cap;
+        }
+        ssize_t n = read(s->master_fd, s->buf + s->len, s->cap - s->len);
+        if (n > 0) {
+            s->len += (size_t)n;
+        } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            break; // EOF/EIO: the main loop sees it again and exits
+        }
+    }
+    return NULL;
+}
+
+static void* startup_osk_main(void* arg)
+{
+    AppStartup* s = (AppStartup*)arg;
+    s->osk_ok = app_load_osk(s->osk, s->config);
+    return NULL;
+}
+
+AppStartup* app_startup_begin(int master_fd, OnScreenKeyboard* osk, const Config* config)
+{
+    AppStartup* s = calloc(1, sizeof(AppStartup));
+    if (!s) {
+        return NULL;
+    }
+    s->master_fd = master_fd;
+    s->osk = osk;
+    s->config = config;
+
+    if (master_fd >= 0) {
+        s->reader_started = pthread_create(&s->reader, NULL, startup_reader_main, s) == 0;
+        if (!s->reader_started) {
+            WARN_LOG("Could not start PTY reader thread; early output stays in the PTY");
+        }
+    }
+    s->osk_started = pthread_create(&s->osk_thread, NULL, startup_osk_main, s) == 0;
+    if (!s->osk_started) {
+        WARN_LOG("Could not start OSK loader thread; loading inline");
+    }
+    return s;
+}
+
+bool app_startup_finish_osk(AppStartup* s, OnScreenKeyboard* osk, const Config* config)
+{
+    bool ok;
+    if (s && s->osk_started) {
+        pthread_join(s->osk_thread, NULL);
+        s->osk_started = false;
+        ok = s->osk_ok;
+    } else {
+        ok = app_load_osk(osk, config);
+    }
+    // Controller setup needs SDL, so it stays on the main thread
+    if (ok) {
+        init_input_devices(osk, config);
+    }
+    return ok;
+}
+
+void app_startup_finish(AppStartup* s, Terminal* term)
+{
+    if (!s) {
+        return;
+    }
+    if (s->reader_started) {
+        __atomic_store_n(&s->stop, 1, __ATOMIC_RELEASE);
+        pthread_join(s->reader, NULL);
+    }
+    if (s->osk_started) {
+        pthread_join(s->osk_thread, NULL);
+    }
+
+    if (term && s->len > 0) {
+        DEBUG_LOG("Feeding %zu bytes of startup output", s->len);
+        session_record_output(s->buf, s->len);
+        perf_count_pty_bytes(s->len);
+        terminal_handle_input(term, s->buf, s->len);
+        terminal_libvterm_flush_damage(term);
+    }
+    free(s->buf);
+    free(s);
+}
+
 /**
  * @brief Runs the credit screen if enabled.
  */
@@ -494,20 +704,17 @@ static void handle_window_resize(SDL_Window* win, SDL_Renderer* renderer,
     int new_cols = config->win_w / *char_w;
     int new_rows = config->win_h / *char_h;
 
-    terminal_resize(term, new_cols, new_rows);
-    if (term->glyph_cache) {
-        glyph_cache_cleanup(term->glyph_cache);
-        glyph_cache_init(term->glyph_cache, GLYPH_CACHE_SIZE);
+    // A replay keeps the recorded grid size so its output stays identical
+    if (!session_replay_active()) {
+        terminal_resize(term, new_cols, new_rows);
     }
+    // Glyph rasters do not depend on the window size, so the glyph cache is kept
     osk_key_cache_destroy(osk->key_cache);
     osk->key_cache = osk_key_cache_create();
     osk_invalidate_render_cache(osk);
 
     // Create new texture first, only destroy old on success (BUG 2)
-    SDL_Texture* new_tex = SDL_CreateTexture(renderer,
-                           SDL_PIXELFORMAT_RGBA8888,
-                           SDL_TEXTUREACCESS_TARGET,
-                           config->win_w, config->win_h);
+    SDL_Texture* new_tex = create_screen_texture(renderer, term, config);
     if (new_tex) {
         if (term->screen_texture) SDL_DestroyTexture(term->screen_texture);
         term->screen_texture = new_tex;
@@ -525,15 +732,80 @@ static void handle_window_resize(SDL_Window* win, SDL_Renderer* renderer,
     *needs_render = true;
 }
 
+#define HIDDEN_POLL_MS 250  // Main loop pass while nothing is shown
+
+// Why the window cannot be seen; nothing is drawn while any of them holds
+typedef struct {
+    bool hidden;        // Hidden or minimized
+    bool unfocused;     // Only counts with config->pause_unfocused
+    bool background;    // Sent to the background by the frontend
+} WindowVisibility;
+
+static bool window_visible(const WindowVisibility* vis, const Config* config)
+{
+    return !vis->hidden && !vis->background && !(vis->unfocused && config->pause_unfocused);
+}
+
+// Drops the textures rebuilt from the grid on demand
+static void drop_render_textures(Terminal* term)
+{
+    row_cache_clear(term->row_cache);
+    alt_screen_cache_drop(term->alt_cache);
+    if (term->background_scaled) {
+        SDL_DestroyTexture(term->background_scaled);
+        term->background_scaled = NULL;
+    }
+}
+
+/**
+ * @brief Pauses or resumes drawing as the window is hidden or shown.
+ */
+static void window_visibility_changed(bool visible, Terminal* term, OnScreenKeyboard* osk,
+                                      const Config* config, bool* needs_render)
+{
+    if (visible) {
+        INFO_LOG("Window visible, rebuilding the screen");
+        term->full_redraw_needed = true;
+        term->cursor_blink_on = true;
+        term->last_blink_toggle_time = SDL_GetTicks();
+        *needs_render = true;
+        return;
+    }
+    INFO_LOG("Window not visible, rendering paused");
+    if (config->release_hidden) {
+        // Everything here is rebuilt by the first render after showing again
+        drop_render_textures(term);
+        glyph_cache_release(term->glyph_cache);
+        if (osk) {
+            osk_key_cache_destroy(osk->key_cache);
+            osk->key_cache = osk_key_cache_create();
+            osk_invalidate_render_cache(osk);
+        }
+    }
+}
+
 static bool drain_pty(int master_fd, Terminal* term)
 {
     bool got_data = false;
     char buf[4096];
     for (;;) {
+        uint64_t t0 = perf_now();
+        uint64_t trace_t0 = trace_begin();
         ssize_t bytes_read = read(master_fd, buf, sizeof(buf) - 1);
         if (bytes_read > 0) {
+            // EAGAIN ends every drain; only reads that returned data are events
+            trace_end("pty_read", trace_t0, bytes_read);
+        }
+        perf_stage_add(PERF_STAGE_DRAIN, perf_now() - t0);
+        if (bytes_read > 0) {
+            perf_count_pty_bytes((size_t)bytes_read);
+            input_latency_pty_data();
             buf[bytes_read] = '\0';
-            if (term->view_offset != 0) term->view_offset = 0;
+            session_record_output(buf, (size_t)bytes_read);
+            if (term->view_offset != 0) {
+                term->view_offset = 0;
+                term->full_redraw_needed = true;
+            }
             terminal_handle_input(term, buf, bytes_read);
             got_data = true;
         } else if (bytes_read == 0) {
@@ -562,6 +834,10 @@ void app_main_loop(SDL_Renderer* renderer, Terminal* term, TTF_Font** font, Conf
     bool running = true;
     bool needs_render = true;
     ButtonRepeatState repeat_state = { .is_held = false, .action = ACTION_NONE };
+    WindowVisibility visibility = { false, false, false };
+    bool visible = true;
+    quality_governor_init(config);
+    power_policy_init(config);
     
     // Initial render
     terminal_render(renderer, term, *font, *char_w, *char_h, osk, true, config->win_w, config->win_h, config);
@@ -569,6 +845,15 @@ void app_main_loop(SDL_Renderer* renderer, Terminal* term, TTF_Font** font, Conf
 
     while (running) {
         Uint32 frame_start = SDL_GetTicks();
+        trace_poll();
+        if (power_policy_poll(frame_start)) {
+            // A profile without blink may have left the cursor and text off
+            term->cursor_blink_on = true;
+            term->blink_repaint_needed = true;
+            needs_render = true;
+        }
+        int fps = power_policy_fps(config->target_fps);
+        quality_governor_set_fps(fps);
         
         // Process all pending events first
         SDL_Event event;
@@ -582,17 +867,30 @@ void app_main_loop(SDL_Renderer* renderer, Terminal* term, TTF_Font** font, Conf
                 case SDL_WINDOWEVENT:
                     if (event.window.event == SDL_WINDOWEVENT_EXPOSED ||
                         event.window.event == SDL_WINDOWEVENT_SHOWN) {
+                        visibility.hidden = false;
+                        term->full_redraw_needed = true;
                         needs_render = true;
                     } else if (event.window.event == SDL_WINDOWEVENT_RESIZED ||
                                event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
                         SDL_Window* win = SDL_GetWindowFromID(event.window.windowID);
                         handle_window_resize(win, renderer, config, term, osk,
                                            char_w, char_h, master_fd, &needs_render);
+                    } else if (event.window.event == SDL_WINDOWEVENT_HIDDEN ||
+                               event.window.event == SDL_WINDOWEVENT_MINIMIZED) {
+                        visibility.hidden = true;
+                    } else if (event.window.event == SDL_WINDOWEVENT_RESTORED ||
+                               event.window.event == SDL_WINDOWEVENT_MAXIMIZED) {
+                        visibility.hidden = false;
+                    } else if (event.window.event == SDL_WINDOWEVENT_FOCUS_LOST) {
+                        visibility.unfocused = true;
+                    } else if (event.window.event == SDL_WINDOWEVENT_FOCUS_GAINED) {
+                        visibility.unfocused = false;
                     }
                     break;
                     
                 case SDL_KEYDOWN:
                 case SDL_KEYUP:
+                case SDL_TEXTINPUT:
                 case SDL_MOUSEBUTTONDOWN:
                 case SDL_MOUSEBUTTONUP:
                 case SDL_MOUSEMOTION:
@@ -602,10 +900,38 @@ void app_main_loop(SDL_Renderer* renderer, Terminal* term, TTF_Font** font, Conf
                 case SDL_CONTROLLERDEVICEADDED:
                 case SDL_CONTROLLERDEVICEREMOVED:
                     // Handle input events
-                    event_handle(&event, &running, &needs_render, term, osk, master_fd, 
-                               font, config, char_w, char_h, &repeat_state);
+                    {
+                        uint64_t input_start = trace_begin();
+                        event_handle(&event, &running, &needs_render, term, osk, master_fd,
+                                   font, config, char_w, char_h, &repeat_state);
+                        trace_end("input", input_start, event.type);
+                    }
                     break;
                     
+                case SDL_APP_WILLENTERBACKGROUND:
+                case SDL_APP_TERMINATING:
+                    if (event.type == SDL_APP_WILLENTERBACKGROUND) {
+                        visibility.background = true;
+                    }
+                    // Frontends may kill us without another chance to save
+                    if (config->session_path) {
+                        session_snapshot_save(config->session_path, term, osk);
+                    }
+                    session_record_flush();
+                    break;
+
+                case SDL_APP_DIDENTERFOREGROUND:
+                    visibility.background = false;
+                    break;
+
+                case SDL_RENDER_TARGETS_RESET:
+                case SDL_RENDER_DEVICE_RESET:
+                    // Target texture contents are lost; rebuild from the grid
+                    drop_render_textures(term);
+                    term->full_redraw_needed = true;
+                    needs_render = true;
+                    break;
+
                 default:
                     // Handle other events
                     event_handle(&event, &running, &needs_render, term, osk, master_fd,
@@ -614,25 +940,45 @@ void app_main_loop(SDL_Renderer* renderer, Terminal* term, TTF_Font** font, Conf
             }
         }
 
-        // Read from PTY — drain all available data before rendering to avoid
-        // redundant intermediate renders on burst output (embedded/battery optimization)
-        struct timeval tv;
-        tv.tv_sec = 0;
-        tv.tv_usec = (needs_render || term->has_dirty_regions) ? 1000 : 16000;
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(master_fd, &fds);
-        
-        int ret = select(master_fd + 1, &fds, NULL, NULL, &tv);
-        if (ret > 0 && FD_ISSET(master_fd, &fds)) {
-            if (!drain_pty(master_fd, term)) {
+        if (window_visible(&visibility, config) != visible) {
+            visible = !visible;
+            window_visibility_changed(visible, term, osk, config, &needs_render);
+        }
+
+        // Replay drives the terminal from a recording instead of a PTY
+        if (master_fd < 0 && session_replay_active()) {
+            long fed = session_replay_pump(term, config->replay_fast);
+            if (fed < 0) {
+                INFO_LOG("Replay finished");
                 running = false;
-            } else {
+            } else if (fed > 0) {
                 needs_render = true;
             }
-        } else if (ret < 0) {
-            if (errno != EINTR) {
-                ERROR_LOG("select() error: %s", strerror(errno));
+        } else {
+            // Read from PTY — drain all available data before rendering to avoid
+            // redundant intermediate renders on burst output (embedded/battery optimization)
+            struct timeval tv;
+            tv.tv_sec = 0;
+            // New data wakes select; an update held by mode 2026 only waits for that
+            tv.tv_usec = (needs_render || term->has_dirty_regions) && !term->sync_output_active ? 1000 : 16000;
+            if (!visible) {
+                tv.tv_usec = HIDDEN_POLL_MS * 1000;
+            }
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(master_fd, &fds);
+
+            int ret = select(master_fd + 1, &fds, NULL, NULL, &tv);
+            if (ret > 0 && FD_ISSET(master_fd, &fds)) {
+                if (!drain_pty(master_fd, term)) {
+                    running = false;
+                } else {
+                    needs_render = true;
+                }
+            } else if (ret < 0) {
+                if (errno != EINTR) {
+                    ERROR_LOG("select() error: %s", strerror(errno));
+                }
             }
         }
 
@@ -653,7 +999,7 @@ void app_main_loop(SDL_Renderer* renderer, Terminal* term, TTF_Font** font, Conf
             char vterm_out[4096];
             size_t n = terminal_libvterm_flush_output(term, vterm_out, sizeof(vterm_out));
             if (n > 0) {
-                ssize_t written = write(master_fd, vterm_out, n);
+                ssize_t written = session_record_write(master_fd, vterm_out, n);
                 (void)written;
             }
         }
@@ -667,31 +1013,72 @@ void app_main_loop(SDL_Renderer* renderer, Terminal* term, TTF_Font** font, Conf
             repeat_state.next_repeat_time = current_time + BUTTON_REPEAT_INTERVAL_MS;
         }
 
-        // Handle cursor blinking
-        if (current_time - term->last_blink_toggle_time >= CURSOR_BLINK_INTERVAL_MS) {
+        // Handle blinking; under load or to save power cursor and text are held on instead.
+        // The cursor is drawn over the screen texture, so only blinking text repaints cells.
+        if (!visible) {
+            // Nothing blinks unseen; the phase restarts when shown
+        } else if (!quality_governor_blink() || !power_policy_blink()) {
+            if (!term->cursor_blink_on) {
+                term->cursor_blink_on = true;
+                term->blink_repaint_needed = true;
+                needs_render = true;
+            }
+        } else if (current_time - term->last_blink_toggle_time >= CURSOR_BLINK_INTERVAL_MS) {
             term->cursor_blink_on = !term->cursor_blink_on;
             term->last_blink_toggle_time = current_time;
-            if (term->view_offset == 0 && term->cursor_y >= 0 && term->cursor_y < term->rows) {
-                terminal_mark_line_dirty(term, term->cursor_y);
-                needs_render = true;
+            if (term->view_offset == 0) {
+                if (terminal_has_blink_text(term)) {
+                    term->blink_repaint_needed = true;
+                    needs_render = true;
+                }
+                if (term->cursor_visible && term->cursor_style_blinking) {
+                    needs_render = true;
+                }
             }
         }
 
         // Handle rendering
         // Use configured FPS instead of hardcoded values
         Uint32 render_interval = (term->has_dirty_regions || needs_render) ? 
-            (1000 / config->target_fps) : 2000;  // Use target FPS when dirty, 0.5 FPS when idle
+            (1000 / fps) : 2000;  // Use the profile's FPS when dirty, 0.5 FPS when idle
+        // At the lowest quality tier renders are spaced out while the PTY is
+        // still drained every pass. A synchronized update (mode 2026) is
+        // rendered once it is complete, or when it times out.
+        bool render_held = (needs_render || term->has_dirty_regions) &&
+                           ((current_time - term->last_render_time) < quality_governor_render_gap(1000 / fps) ||
+                            terminal_sync_output_held(term, current_time));
         
-        if (needs_render || (current_time - term->last_render_time) >= render_interval) {
+        if (!visible) {
+            // Parsing goes on; the screen is rebuilt once it can be seen
+        } else if (render_held) {
+            // Keep needs_render for when the gap has passed
+        } else if (needs_render || (current_time - term->last_render_time) >= render_interval) {
             Uint32 render_start = SDL_GetTicks();
+            uint64_t draw_start = perf_now();
+            uint64_t render_trace = trace_begin();
+            input_latency_frame_begin(term);
             
-            // Render the terminal content (no need to clear, terminal_render handles it)
+            // Render the terminal content. Rows are repainted from damage
+            // tracking; a full repaint is only forced by config or by
+            // term->full_redraw_needed.
+            if (glyph_cache_set_raster_mode(term->glyph_cache, quality_governor_raster_mode())) {
+                // Back to full quality: replace the coarse glyphs on screen
+                row_cache_clear(term->row_cache);
+                term->full_redraw_needed = true;
+            }
             terminal_render(renderer, term, *font, *char_w, *char_h, osk, 
-                          needs_render || config->force_full_render, 
+                          config->force_full_render, 
                           config->win_w, config->win_h, config);
+            trace_end("terminal_render", render_trace, term->dirty_max_y - term->dirty_min_y + 1);
+            uint64_t present_start = perf_now();
+            perf_stage_add(PERF_STAGE_DRAW, present_start - draw_start);
             
             // Update the screen
+            uint64_t trace_t0 = trace_begin();
             SDL_RenderPresent(renderer);
+            trace_end("present", trace_t0, 0);
+            input_latency_frame_presented();
+            perf_stage_add(PERF_STAGE_PRESENT, perf_now() - present_start);
             
             Uint32 render_time = SDL_GetTicks() - render_start;
             if (render_time > 16) {  // Warn about slow rendering
@@ -699,20 +1086,44 @@ void app_main_loop(SDL_Renderer* renderer, Terminal* term, TTF_Font** font, Conf
             }
             
             term->last_render_time = render_start;
-            needs_render = false;
+            // A fresh snapshot is shown on the next frame
+            needs_render = perf_frame_end(term) && perf_hud_visible();
+
+            double busy_ms = (double)(perf_now() - draw_start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+            if (quality_governor_frame(SDL_GetTicks(), busy_ms)) {
+                // The background and cursor change with the tier
+                term->full_redraw_needed = true;
+                needs_render = true;
+            }
+        } else if (quality_governor_idle(current_time)) {
+            term->full_redraw_needed = true;
+            needs_render = true;
         }
 
-        // Frame rate limiting - use configured FPS when active, longer sleep when idle
+        input_latency_tick();
+
+        // Frame rate limiting - use the profile's FPS when active, its idle sleep when idle
         Uint32 frame_time = SDL_GetTicks() - frame_start;
-        Uint32 target_frame_time = 1000 / config->target_fps;
-        if (frame_time < target_frame_time) {
-            Uint32 delay = target_frame_time - frame_time;
-            if (!term->has_dirty_regions && !needs_render) {
-                Uint32 idle_delay = delay > 50 ? 50 : delay;
-                if (idle_delay > 0) SDL_Delay(idle_delay);
-            } else {
-                SDL_Delay(delay);
+        Uint32 target_frame_time = 1000 / fps;
+        if (config->replay_fast && session_replay_active()) {
+            // Benchmark replays run unthrottled
+        } else if (!visible) {
+            // select() waits for PTY data; a replay is paced here, without prewarming glyphs
+            if (master_fd < 0) {
+                SDL_Delay(HIDDEN_POLL_MS);
             }
+        } else if (render_held) {
+            // Parsing keeps its full rate while renders are spaced out
+            SDL_Delay(1);
+        } else if (!term->has_dirty_regions && !needs_render) {
+            Uint32 idle_time = power_policy_idle_ms();
+            if (frame_time < idle_time) {
+                font_manager_prewarm(renderer, config);
+                Uint32 idle_delay = idle_time - (SDL_GetTicks() - frame_start);
+                if (idle_delay > 0 && idle_delay <= idle_time) SDL_Delay(idle_delay);
+            }
+        } else if (frame_time < target_frame_time) {
+            SDL_Delay(target_frame_time - frame_time);
         }
     }
 
@@ -779,20 +1190,28 @@ void app_cleanup_resources(const Config* config, Terminal* term, OnScreenKeyboar
         close(master_fd);
     }
     
-    // Clean up SDL resources
+    // Clean up SDL resources. Retained zoom sizes hold atlas textures, so
+    // they go before the renderer.
+    if (font) {
+        TTF_CloseFont(font);
+    }
+    font_manager_cleanup();
+    font_fallback_cleanup();
+    glyph_cluster_reset();
+    soft_render_cleanup();
     if (renderer) {
         SDL_DestroyRenderer(renderer);
     }
     if (win) {
         SDL_DestroyWindow(win);
     }
-    if (font) {
-        TTF_CloseFont(font);
-    }
     
     IMG_Quit();
     TTF_Quit();
     SDL_Quit();
+
+    // After the OSK is freed: its key strings may point into the bundle
+    resource_bundle_close();
 }
 
 /**
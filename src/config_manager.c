@@ -6,8 +6,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 #include "config_manager.h"
+#include "power_policy.h"
 #include "error_codes.h"
 #include "config.h"
 
@@ -20,12 +23,30 @@ void config_init_defaults(Config* config)
     config->win_h = DEFAULT_WINDOW_HEIGHT;
     config->font_path = strdup(DEFAULT_FONT_FILE_PATH);
     config->font_size = DEFAULT_FONT_SIZE_POINTS;
+    config->bitmap_font_path = NULL;
+    config->fallback_fonts = NULL;
+    config->num_fallback_fonts = 0;
     config->custom_command = NULL;
     config->scrollback_lines = DEFAULT_SCROLLBACK_LINES;
     config->force_full_render = false;
     config->background_image_path = DEFAULT_BACKGROUND_IMAGE_PATH;
     config->colorscheme_path = NULL;
     config->target_fps = 30;
+    config->color_depth = 32;
+    config->retune_renderer = false;
+    config->governor_high_pct = 90;
+    config->governor_low_pct = 50;
+    config->governor_hold_ms = 1000;
+    config->power_supply_path = strdup(DEFAULT_POWER_SUPPLY_PATH);
+    config->thermal_path = strdup(DEFAULT_THERMAL_PATH);
+    config->low_battery_pct = DEFAULT_LOW_BATTERY_PERCENT;
+    config->hot_temp_c = DEFAULT_HOT_TEMP_CELSIUS;
+    config->power_profiles[POWER_PROFILE_AC] = (PowerProfileSettings){ 0, true, 33 };
+    config->power_profiles[POWER_PROFILE_BATTERY] = (PowerProfileSettings){ 24, true, 100 };
+    config->power_profiles[POWER_PROFILE_LOW_BATTERY] = (PowerProfileSettings){ 15, false, 250 };
+    config->power_profiles[POWER_PROFILE_HOT] = (PowerProfileSettings){ 10, false, 250 };
+    config->pause_unfocused = false;
+    config->release_hidden = false;
     config->read_only = false;
     config->no_credit = false;
     config->raw = false;
@@ -35,6 +56,11 @@ void config_init_defaults(Config* config)
     config->osk_bar_height = 0;
     config->key_sets = NULL;
     config->num_key_sets = 0;
+    config->session_path = NULL;
+    config->record_path = NULL;
+    config->replay_path = NULL;
+    config->replay_fast = false;
+    config->trace_path = NULL;
 }
 
 /**
@@ -75,6 +101,54 @@ bool config_validate(Config* config)
         valid = false;
     }
     
+    if (config->color_depth != 16 && config->color_depth != 32) {
+        WARN_LOG("Invalid color depth %d, using 32", config->color_depth);
+        config->color_depth = 32;
+        valid = false;
+    }
+    
+    if (config->governor_high_pct < 0 || config->governor_high_pct > 1000 ||
+        config->governor_low_pct < 0 ||
+        (config->governor_high_pct > 0 && config->governor_low_pct >= config->governor_high_pct)) {
+        WARN_LOG("Invalid governor thresholds %d/%d%%, using 90/50%%",
+                 config->governor_high_pct, config->governor_low_pct);
+        config->governor_high_pct = 90;
+        config->governor_low_pct = 50;
+        valid = false;
+    }
+    
+    if (config->governor_hold_ms < 100 || config->governor_hold_ms > 60000) {
+        WARN_LOG("Invalid governor hold %d ms, using 1000", config->governor_hold_ms);
+        config->governor_hold_ms = 1000;
+        valid = false;
+    }
+    
+    if (config->low_battery_pct < 0 || config->low_battery_pct > 100) {
+        WARN_LOG("Invalid low battery level %d%%, using %d%%", config->low_battery_pct, DEFAULT_LOW_BATTERY_PERCENT);
+        config->low_battery_pct = DEFAULT_LOW_BATTERY_PERCENT;
+        valid = false;
+    }
+    
+    if (config->hot_temp_c < 30 || config->hot_temp_c > 150) {
+        WARN_LOG("Invalid hot temperature %d C, using %d C", config->hot_temp_c, DEFAULT_HOT_TEMP_CELSIUS);
+        config->hot_temp_c = DEFAULT_HOT_TEMP_CELSIUS;
+        valid = false;
+    }
+    
+    for (int p = 0; p < POWER_PROFILE_COUNT; p++) {
+        PowerProfileSettings* s = &config->power_profiles[p];
+        if (s->fps < 0 || s->fps > 120) {
+            WARN_LOG("Invalid %s_fps %d, using the --fps cap", power_profile_name(p), s->fps);
+            s->fps = 0;
+            valid = false;
+        }
+        if (s->idle_ms < 0 || s->idle_ms > 2000) {
+            WARN_LOG("Invalid %s_idle_ms %d, using 33", power_profile_name(p), s->idle_ms);
+            s->idle_ms = 33;
+            valid = false;
+        }
+    }
+    
     if (!config->font_path || config->font_path[0] == '\0') {
         WARN_LOG("Empty font path, using default");
         free(config->font_path);
@@ -91,6 +165,51 @@ bool config_validate(Config* config)
     return valid;
 }
 
+/**
+ * @brief Appends a font to the fallback chain.
+ */
+static void config_add_fallback_font(Config* config, const char* path)
+{
+    if (!path || path[0] == '\0') {
+        return;
+    }
+    char** fonts = realloc(config->fallback_fonts, sizeof(char*) * (size_t)(config->num_fallback_fonts + 1));
+    if (!fonts) {
+        ERROR_LOG("Could not allocate memory for fallback fonts");
+        exit(1);
+    }
+    config->fallback_fonts = fonts;
+    config->fallback_fonts[config->num_fallback_fonts++] = strdup(path);
+}
+
+/**
+ * @brief Applies a <profile>_fps, <profile>_blink or <profile>_idle_ms key.
+ * @return false if @p key is not a power profile key.
+ */
+static bool config_set_profile_key(Config* config, const char* key, const char* value)
+{
+    for (int p = 0; p < POWER_PROFILE_COUNT; p++) {
+        const char* name = power_profile_name(p);
+        size_t len = strlen(name);
+        if (strncmp(key, name, len) != 0 || key[len] != '_') {
+            continue;
+        }
+        const char* setting = key + len + 1;
+        PowerProfileSettings* s = &config->power_profiles[p];
+        if (strcmp(setting, "fps") == 0) {
+            s->fps = atoi(value);
+        } else if (strcmp(setting, "blink") == 0) {
+            s->blink = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(setting, "idle_ms") == 0) {
+            s->idle_ms = atoi(value);
+        } else {
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
 /**
  * @brief Parses command-line arguments and updates the Config struct.
  */
@@ -106,6 +225,11 @@ void config_parse_args(int argc, char* argv[], Config* config)
             config->font_path = strdup(argv[++i]);
         } else if ((strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--size") == 0) && i + 1 < argc) {
             config->font_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bitmap-font") == 0 && i + 1 < argc) {
+            free(config->bitmap_font_path);
+            config->bitmap_font_path = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--fallback-font") == 0 && i + 1 < argc) {
+            config_add_fallback_font(config, argv[++i]);
         } else if ((strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--scrollback") == 0) && i + 1 < argc) {
             config->scrollback_lines = atoi(argv[++i]);
         } else if ((strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--exec") == 0) && i + 1 < argc) {
@@ -119,6 +243,26 @@ void config_parse_args(int argc, char* argv[], Config* config)
             config->colorscheme_path = strdup(argv[++i]);
         } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
             config->target_fps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--color-depth") == 0 && i + 1 < argc) {
+            config->color_depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--retune") == 0) {
+            config->retune_renderer = true;
+        } else if (strcmp(argv[i], "--governor-high") == 0 && i + 1 < argc) {
+            config->governor_high_pct = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--governor-low") == 0 && i + 1 < argc) {
+            config->governor_low_pct = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--governor-hold") == 0 && i + 1 < argc) {
+            config->governor_hold_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--power-supply") == 0 && i + 1 < argc) {
+            free(config->power_supply_path);
+            config->power_supply_path = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--thermal") == 0 && i + 1 < argc) {
+            free(config->thermal_path);
+            config->thermal_path = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--pause-unfocused") == 0) {
+            config->pause_unfocused = true;
+        } else if (strcmp(argv[i], "--release-hidden") == 0) {
+            config->release_hidden = true;
         } else if (strcmp(argv[i], "--read-only") == 0) {
             config->read_only = true;
         } else if (strcmp(argv[i], "--no-credit") == 0) {
@@ -165,6 +309,20 @@ void config_parse_args(int argc, char* argv[], Config* config)
         } else if (strcmp(argv[i], "--osk-height") == 0 && i + 1 < argc) {
             config->osk_bar_height = atoi(argv[++i]);
             if (config->osk_bar_height < 8) config->osk_bar_height = 8;
+        } else if (strcmp(argv[i], "--session") == 0 && i + 1 < argc) {
+            free(config->session_path);
+            config->session_path = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            free(config->record_path);
+            config->record_path = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            free(config->replay_path);
+            config->replay_path = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--replay-fast") == 0) {
+            config->replay_fast = true;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            free(config->trace_path);
+            config->trace_path = strdup(argv[++i]);
         } else if (strcmp(argv[i], "--version") == 0 || strcmp(argv[i], "-v") == 0) {
             fprintf(stdout, "vaixterm %s\n", VERSION);
             exit(0);
@@ -191,11 +349,22 @@ void config_print_help(const char* program_name)
     fprintf(stdout, "  -h, --height <pixels>      Set window height (default: %d)\n", DEFAULT_WINDOW_HEIGHT);
     fprintf(stdout, "  -f, --font <path>          Set font path (default: %s)\n", DEFAULT_FONT_FILE_PATH);
     fprintf(stdout, "  -s, --size <points>        Set font size (default: %d)\n", DEFAULT_FONT_SIZE_POINTS);
+    fprintf(stdout, "  --bitmap-font <path>       Draw the terminal with a PSF/BDF bitmap font.\n");
+    fprintf(stdout, "  --fallback-font <path>     Add a font for characters the main font lacks (repeatable).\n");
     fprintf(stdout, "  -l, --scrollback <lines>   Set scrollback lines (default: %d)\n", DEFAULT_SCROLLBACK_LINES);
     fprintf(stdout, "  -e, --exec <command>       Execute command instead of default shell.\n");
     fprintf(stdout, "  -b, --background <path>    Set background image (optional).\n");
     fprintf(stdout, "  -cs, --colorscheme <path>  Set colorscheme (optional).\n");
     fprintf(stdout, "  --fps <value>              Set framerate cap (default: 30 fps).\n");
+    fprintf(stdout, "  --color-depth <16|32>      16 renders in RGB565 to save memory (default: 32).\n");
+    fprintf(stdout, "  --retune                   Measure renderer configurations again and keep the fastest.\n");
+    fprintf(stdout, "  --governor-high <percent>  Lower quality when frames take this much of the fps budget (default: 90, 0 = never).\n");
+    fprintf(stdout, "  --governor-low <percent>   Restore quality when frames take less than this (default: 50).\n");
+    fprintf(stdout, "  --governor-hold <ms>       How long the load must last before quality changes (default: 1000).\n");
+    fprintf(stdout, "  --power-supply <dir>       Read battery state from this directory (default: %s).\n", DEFAULT_POWER_SUPPLY_PATH);
+    fprintf(stdout, "  --thermal <dir>            Read temperatures from this directory (default: %s).\n", DEFAULT_THERMAL_PATH);
+    fprintf(stdout, "  --pause-unfocused          Stop rendering while the window is unfocused, not only when hidden.\n");
+    fprintf(stdout, "  --release-hidden           Free glyph and texture caches while the window is hidden.\n");
     fprintf(stdout, "  --read-only                Run in read-only mode (input disabled).\n");
     fprintf(stdout, "  --no-credit                Start shell directly, skip credits.\n");
     fprintf(stdout, "  --raw                      Raw mode: pass all input directly to child process.\n");
@@ -205,9 +374,20 @@ void config_print_help(const char* program_name)
     fprintf(stdout, "  --osk-layout <path>        Use a custom OSK layout file.\n");
     fprintf(stdout, "  --osk-alpha <0-255>        OSK bar transparency (default: 220).\n");
     fprintf(stdout, "  --osk-height <pixels>      OSK bar height in pixels (default: char height).\n");
+    fprintf(stdout, "  --session <path>           Save the session on exit and resume it on launch.\n");
+    fprintf(stdout, "  --record <path>            Record PTY output and input with timestamps.\n");
+    fprintf(stdout, "  --replay <path>            Replay a recording instead of starting a shell.\n");
+    fprintf(stdout, "  --replay-fast              Replay as fast as possible instead of in real time.\n");
+    fprintf(stdout, "  --trace <path>             Write a Chrome/Perfetto trace at exit and on SIGUSR1.\n");
     fprintf(stdout, "  key_set=[+-]<path>         Config file equivalent of --key-set.\n");
     fprintf(stdout, "  osk_alpha=<0-255>          Config file equivalent of --osk-alpha.\n");
     fprintf(stdout, "  osk_height=<pixels>        Config file equivalent of --osk-height.\n");
+    fprintf(stdout, "  fallback_font=<path>       Config file equivalent of --fallback-font.\n");
+    fprintf(stdout, "  low_battery=<percent>      Battery level for the low_battery profile (default: %d).\n", DEFAULT_LOW_BATTERY_PERCENT);
+    fprintf(stdout, "  hot_temp=<celsius>         Temperature for the hot profile (default: %d).\n", DEFAULT_HOT_TEMP_CELSIUS);
+    fprintf(stdout, "  <profile>_fps=<value>      Frame rate for ac/battery/low_battery/hot, capped at --fps.\n");
+    fprintf(stdout, "  <profile>_blink=<bool>     Cursor blink for the profile.\n");
+    fprintf(stdout, "  <profile>_idle_ms=<ms>     Main loop sleep while idle for the profile.\n");
     fprintf(stdout, "  --version                  Show version and exit.\n");
 }
 
@@ -221,24 +401,44 @@ void config_cleanup(Config* config)
     }
     
     free(config->font_path);
+    free(config->bitmap_font_path);
     free(config->custom_command);
     free(config->background_image_path);
     free(config->colorscheme_path);
     free(config->osk_layout_path);
+    free(config->session_path);
+    free(config->record_path);
+    free(config->replay_path);
+    free(config->trace_path);
+    free(config->power_supply_path);
+    free(config->thermal_path);
     
     for (int i = 0; i < config->num_key_sets; ++i) {
         free(config->key_sets[i].path);
     }
     free(config->key_sets);
+    for (int i = 0; i < config->num_fallback_fonts; ++i) {
+        free(config->fallback_fonts[i]);
+    }
+    free(config->fallback_fonts);
     
     // Reset to safe state
     config->font_path = NULL;
+    config->bitmap_font_path = NULL;
     config->custom_command = NULL;
     config->background_image_path = NULL;
     config->colorscheme_path = NULL;
     config->osk_layout_path = NULL;
+    config->session_path = NULL;
+    config->record_path = NULL;
+    config->replay_path = NULL;
+    config->trace_path = NULL;
+    config->power_supply_path = NULL;
+    config->thermal_path = NULL;
     config->key_sets = NULL;
     config->num_key_sets = 0;
+    config->fallback_fonts = NULL;
+    config->num_fallback_fonts = 0;
 }
 
 /**
@@ -323,6 +523,11 @@ bool config_load_from_file(Config* config, const char* explicit_path)
             config->font_path = strdup(value);
         } else if (strcmp(key, "font_size") == 0) {
             config->font_size = atoi(value);
+        } else if (strcmp(key, "bitmap_font") == 0) {
+            free(config->bitmap_font_path);
+            config->bitmap_font_path = strdup(value);
+        } else if (strcmp(key, "fallback_font") == 0) {
+            config_add_fallback_font(config, value);
         } else if (strcmp(key, "scrollback") == 0) {
             config->scrollback_lines = atoi(value);
         } else if (strcmp(key, "exec") == 0) {
@@ -336,6 +541,30 @@ bool config_load_from_file(Config* config, const char* explicit_path)
             config->colorscheme_path = strdup(value);
         } else if (strcmp(key, "fps") == 0) {
             config->target_fps = atoi(value);
+        } else if (strcmp(key, "color_depth") == 0) {
+            config->color_depth = atoi(value);
+        } else if (strcmp(key, "governor_high") == 0) {
+            config->governor_high_pct = atoi(value);
+        } else if (strcmp(key, "governor_low") == 0) {
+            config->governor_low_pct = atoi(value);
+        } else if (strcmp(key, "governor_hold") == 0) {
+            config->governor_hold_ms = atoi(value);
+        } else if (strcmp(key, "power_supply") == 0) {
+            free(config->power_supply_path);
+            config->power_supply_path = strdup(value);
+        } else if (strcmp(key, "thermal") == 0) {
+            free(config->thermal_path);
+            config->thermal_path = strdup(value);
+        } else if (strcmp(key, "low_battery") == 0) {
+            config->low_battery_pct = atoi(value);
+        } else if (strcmp(key, "hot_temp") == 0) {
+            config->hot_temp_c = atoi(value);
+        } else if (config_set_profile_key(config, key, value)) {
+            // Power profile setting
+        } else if (strcmp(key, "pause_unfocused") == 0) {
+            config->pause_unfocused = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+        } else if (strcmp(key, "release_hidden") == 0) {
+            config->release_hidden = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
         } else if (strcmp(key, "read_only") == 0) {
             config->read_only = (strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
         } else if (strcmp(key, "no_credit") == 0) {
@@ -358,6 +587,15 @@ bool config_load_from_file(Config* config, const char* explicit_path)
         } else if (strcmp(key, "osk_height") == 0) {
             config->osk_bar_height = atoi(value);
             if (config->osk_bar_height < 8) config->osk_bar_height = 8;
+        } else if (strcmp(key, "session") == 0) {
+            free(config->session_path);
+            config->session_path = strdup(value);
+        } else if (strcmp(key, "record") == 0) {
+            free(config->record_path);
+            config->record_path = strdup(value);
+        } else if (strcmp(key, "trace") == 0) {
+            free(config->trace_path);
+            config->trace_path = strdup(value);
         } else if (strcmp(key, "key_set") == 0) {
             bool load = true;
             const char* path = value;
@@ -384,3 +622,32 @@ bool config_load_from_file(Config* config, const char* explicit_path)
     INFO_LOG("Loaded config from: %s", path);
     return true;
 }
+
+/**
+ * @brief Builds the path of a file next to vaixterm.conf.
+ */
+bool config_dir_path(const char* name, char* out, size_t out_size)
+{
+    char dir[4096];
+    const char* xdg_config = getenv("XDG_CONFIG_HOME");
+    if (xdg_config && xdg_config[0]) {
+        snprintf(dir, sizeof(dir), "%s", xdg_config);
+    } else {
+        const char* home = getenv("HOME");
+        if (!home || !home[0]) {
+            return false;
+        }
+        snprintf(dir, sizeof(dir), "%s/.config", home);
+    }
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        return false;
+    }
+    size_t len = strlen(dir);
+    snprintf(dir + len, sizeof(dir) - len, "/vaixterm");
+    if (mkdir(dir, 0700) != 0 && errno != EEXIST) {
+        DEBUG_LOG("Cannot create config directory %s: %s", dir, strerror(errno));
+        return false;
+    }
+    int n = snprintf(out, out_size, "%s/%s", dir, name);
+    return n > 0 && (size_t)n < out_size;
+}
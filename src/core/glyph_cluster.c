@@ -0,0 +1,114 @@
+/**
+ * @file glyph_cluster.c
+ * @brief Grapheme cluster interning.
+ *
+ * Clusters are appended to a flat array and found again through an open
+ * addressing index, so interning a cluster that is already known (the
+ * common case when a row is refreshed) is one hash and one compare.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyph_cluster.h"
+#include "error_codes.h"
+
+#define CLUSTER_INDEX_SIZE (GLYPH_CLUSTER_MAX * 2) // Power of two, at most half full
+
+typedef struct {
+    uint32_t chars[GLYPH_CLUSTER_MAX_CHARS];
+    int count;
+} GlyphClusterEntry;
+
+static struct {
+    GlyphClusterEntry* entries;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t* index;    // Entry number + 1, 0 = empty
+    bool full_logged;
+} s_clusters;
+
+static uint32_t cluster_hash(const uint32_t* chars, int count)
+{
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < count; i++) {
+        h = (h ^ chars[i]) * 16777619u;
+    }
+    return h;
+}
+
+uint32_t glyph_cluster_intern(const uint32_t* chars, int count)
+{
+    if (count <= 1) {
+        return count == 1 ? chars[0] : ' ';
+    }
+    if (count > GLYPH_CLUSTER_MAX_CHARS) {
+        count = GLYPH_CLUSTER_MAX_CHARS;
+    }
+
+    if (!s_clusters.index) {
+        s_clusters.index = calloc(CLUSTER_INDEX_SIZE, sizeof(uint32_t));
+        if (!s_clusters.index) {
+            return chars[0];
+        }
+    }
+
+    uint32_t slot = cluster_hash(chars, count) & (CLUSTER_INDEX_SIZE - 1);
+    while (s_clusters.index[slot]) {
+        const GlyphClusterEntry* e = &s_clusters.entries[s_clusters.index[slot] - 1];
+        if (e->count == count && memcmp(e->chars, chars, sizeof(uint32_t) * (size_t)count) == 0) {
+            return GLYPH_CLUSTER_FLAG | (s_clusters.index[slot] - 1);
+        }
+        slot = (slot + 1) & (CLUSTER_INDEX_SIZE - 1);
+    }
+
+    if (s_clusters.count >= GLYPH_CLUSTER_MAX) {
+        if (!s_clusters.full_logged) {
+            WARN_LOG("More than %d distinct grapheme clusters, drawing new ones as their base character",
+                     GLYPH_CLUSTER_MAX);
+            s_clusters.full_logged = true;
+        }
+        return chars[0];
+    }
+    if (s_clusters.count == s_clusters.capacity) {
+        uint32_t new_capacity = s_clusters.capacity ? s_clusters.capacity * 2 : 256;
+        GlyphClusterEntry* entries = realloc(s_clusters.entries, new_capacity * sizeof(GlyphClusterEntry));
+        if (!entries) {
+            return chars[0];
+        }
+        s_clusters.entries = entries;
+        s_clusters.capacity = new_capacity;
+    }
+
+    GlyphClusterEntry* e = &s_clusters.entries[s_clusters.count];
+    memset(e, 0, sizeof(*e));
+    memcpy(e->chars, chars, sizeof(uint32_t) * (size_t)count);
+    e->count = count;
+    s_clusters.index[slot] = ++s_clusters.count;
+    return GLYPH_CLUSTER_FLAG | (s_clusters.count - 1);
+}
+
+const uint32_t* glyph_cluster_chars(uint32_t character, int* count)
+{
+    uint32_t id = character & ~GLYPH_CLUSTER_FLAG;
+    if (!glyph_is_cluster(character) || id >= s_clusters.count) {
+        *count = 0;
+        return NULL;
+    }
+    *count = s_clusters.entries[id].count;
+    return s_clusters.entries[id].chars;
+}
+
+uint32_t glyph_cluster_base(uint32_t character)
+{
+    int count;
+    const uint32_t* chars = glyph_cluster_chars(character, &count);
+    return chars ? chars[0] : (character & ~GLYPH_CLUSTER_FLAG);
+}
+
+void glyph_cluster_reset(void)
+{
+    free(s_clusters.entries);
+    free(s_clusters.index);
+    memset(&s_clusters, 0, sizeof(s_clusters));
+}
@@ -1,9 +1,19 @@
 #include "terminal_libvterm.h"
 #include "error_codes.h"
 #include "terminal.h"
+#include "dirty_region_tracker.h"
+#include "alt_screen_cache.h"
+#include "perf_stats.h"
+#include "trace.h"
+#include "glyph_cluster.h"
+#include <stdio.h>
 #include <string.h>
 #include <SDL.h>
 
+// The live grid is a flat array of packed cells; keep them at 16 bytes so a
+// row of 80 columns spans exactly 20 cache lines.
+_Static_assert(sizeof(Glyph) == 16, "Glyph must stay a packed 16-byte cell");
+
 typedef struct {
     VTermScreenCell** lines;
     int capacity;
@@ -12,6 +22,25 @@ typedef struct {
     int head;               // Circular buffer: oldest valid row index
 } ScrollbackBuffer;
 
+// Scanner states for DEC private modes handled ahead of libvterm: 2026,
+// which it does not know, and the alternate screen modes, whose switch
+// hides the primary screen from the screen API
+typedef enum {
+    MODE_SCAN_GROUND,
+    MODE_SCAN_ESC,
+    MODE_SCAN_CSI,
+    MODE_SCAN_PRIVATE,      // CSI ? and parameters
+    MODE_SCAN_DOLLAR        // CSI ? Ps $, a DECRQM request without its final byte
+} ModeScanState;
+
+typedef enum {
+    MODE_EVENT_NONE,
+    MODE_EVENT_SYNC_SET,
+    MODE_EVENT_SYNC_RESET,
+    MODE_EVENT_SYNC_QUERY,
+    MODE_EVENT_ALT_ENTER    // Alternate screen set, final byte not yet written
+} ModeEvent;
+
 typedef struct {
     VTerm* vt;
     VTermState* state;
@@ -19,19 +48,34 @@ typedef struct {
     ScrollbackBuffer sb;
     char output_buffer[4096];
     size_t output_len;
-    Glyph* line_buffer;
-    int line_buffer_cols;
-} LibVtermBackend;
+    ModeScanState scan_state;
+    int mode_param;
+    bool sync_has_2026;
+    bool alt_has_mode;      // 47, 1047 or 1049 among the parameters
+    bool alt_split_done;    // Sequence already stopped before its final byte
 
-static Glyph* ensure_line_buffer(LibVtermBackend* backend, int cols)
-{
-    if (backend->line_buffer && backend->line_buffer_cols >= cols)
-        return backend->line_buffer;
-    free(backend->line_buffer);
-    backend->line_buffer = calloc((size_t)cols, sizeof(Glyph));
-    backend->line_buffer_cols = cols;
-    return backend->line_buffer;
-}
+    // Primary screen as it was when the alternate screen came up; libvterm
+    // only exposes the active buffer, and a snapshot must not save the
+    // alternate one.
+    VTermScreenCell* primary_cells;
+    int primary_rows;
+    int primary_cols;
+    int32_t primary_modes[5];   // Cursor row/col, visible, style, blinking
+    bool primary_valid;
+
+    // Mirror of the live screen, rows * cols packed cells. Updated only from
+    // damage/moverect callbacks, read by pointer via get_view_line.
+    Glyph* grid;
+    // Backing rows for scrolled-back views (one row per visible line, so
+    // every returned pointer stays valid until the next view change).
+    Glyph* view_rows;
+    int grid_rows;
+    int grid_cols;
+    bool grid_stale;        // Palette/colour change: rebuild all on next read
+    // Cells with ATTR_BLINK per grid row, kept up to date with the grid so
+    // a blink phase change repaints those cells only.
+    uint16_t* blink_cells;
+} LibVtermBackend;
 
 static void sb_init(ScrollbackBuffer* sb, int capacity, int cols)
 {
@@ -88,6 +132,12 @@ static void sb_clear(ScrollbackBuffer* sb)
     sb->head = 0;
 }
 
+/** Returns scrollback row @p i counted from the oldest line. */
+static const VTermScreenCell* sb_line_at(const ScrollbackBuffer* sb, int i)
+{
+    return sb->lines[(sb->head + i) % sb->capacity];
+}
+
 static void sb_resize(ScrollbackBuffer* sb, int new_cols, int new_rows_for_capacity)
 {
     int old_cols = sb->cols;
@@ -130,14 +180,143 @@ static void sb_resize(ScrollbackBuffer* sb, int new_cols, int new_rows_for_capac
     }
 }
 
+static void convert_cell_to_glyph(VTermScreen* screen, const VTermScreenCell* cell, Glyph* g);
+
+static bool grid_alloc(LibVtermBackend* backend, int rows, int cols)
+{
+    size_t n = (size_t)rows * (size_t)cols;
+    Glyph* grid = calloc(n, sizeof(Glyph));
+    Glyph* view_rows = calloc(n, sizeof(Glyph));
+    uint16_t* blink_cells = calloc((size_t)rows, sizeof(uint16_t));
+    if (!grid || !view_rows || !blink_cells) {
+        ERROR_LOG("Failed to allocate %dx%d cell grid", cols, rows);
+        free(grid);
+        free(view_rows);
+        free(blink_cells);
+        return false;
+    }
+    free(backend->grid);
+    free(backend->view_rows);
+    free(backend->blink_cells);
+    backend->grid = grid;
+    backend->view_rows = view_rows;
+    backend->blink_cells = blink_cells;
+    backend->grid_rows = rows;
+    backend->grid_cols = cols;
+    backend->grid_stale = true;
+    return true;
+}
+
+static void grid_count_blink(LibVtermBackend* backend, int row)
+{
+    const Glyph* g = backend->grid + (size_t)row * (size_t)backend->grid_cols;
+    uint16_t n = 0;
+    for (int x = 0; x < backend->grid_cols; x++)
+        n += (g[x].attributes & ATTR_BLINK) != 0;
+    backend->blink_cells[row] = n;
+}
+
+/**
+ * Re-reads the cells of a screen rect (end exclusive) into the grid.
+ */
+static void grid_refresh_rect(LibVtermBackend* backend, int start_row, int end_row,
+                              int start_col, int end_col)
+{
+    if (!backend->grid) return;
+    if (start_row < 0) start_row = 0;
+    if (start_col < 0) start_col = 0;
+    if (end_row > backend->grid_rows) end_row = backend->grid_rows;
+    if (end_col > backend->grid_cols) end_col = backend->grid_cols;
+
+    VTermScreenCell cell;
+    for (int y = start_row; y < end_row; y++) {
+        Glyph* row = backend->grid + (size_t)y * (size_t)backend->grid_cols;
+        for (int x = start_col; x < end_col; x++) {
+            vterm_screen_get_cell(backend->screen, (VTermPos){ .row = y, .col = x }, &cell);
+            convert_cell_to_glyph(backend->screen, &cell, &row[x]);
+        }
+        grid_count_blink(backend, y);
+    }
+}
+
+static void grid_sync(LibVtermBackend* backend)
+{
+    if (backend->grid_stale) {
+        grid_refresh_rect(backend, 0, backend->grid_rows, 0, backend->grid_cols);
+        backend->grid_stale = false;
+    }
+}
+
+/** Forces a rebuild of every cell, e.g. after a palette change. */
+static void grid_invalidate(Terminal* term, LibVtermBackend* backend)
+{
+    backend->grid_stale = true;
+    term->full_redraw_needed = true;
+}
+
 static int screen_damage(VTermRect rect, void* user)
 {
     Terminal* term = (Terminal*)user;
-    term->has_dirty_regions = true;
-    if (term->dirty_min_y == -1 || rect.start_row < term->dirty_min_y)
-        term->dirty_min_y = rect.start_row;
-    if (term->dirty_max_y == -1 || rect.end_row > term->dirty_max_y)
-        term->dirty_max_y = rect.end_row;
+    LibVtermBackend* backend = (LibVtermBackend*)term->backend;
+    if (!backend) return 1;
+
+    uint64_t t0 = perf_now();
+    uint64_t trace_t0 = trace_begin();
+    if (!backend->grid_stale)
+        grid_refresh_rect(backend, rect.start_row, rect.end_row, rect.start_col, rect.end_col);
+    if (!backend->grid_stale && backend->grid && alt_screen_cache_restoring(term->alt_cache)) {
+        // Back from the alternate screen: rows matching the saved frame need
+        // no drawing. The grid is read, so clamp to it as grid_refresh_rect does.
+        int start_row = SDL_max(rect.start_row, 0);
+        int end_row = SDL_min(rect.end_row, backend->grid_rows);
+        for (int y = start_row; y < end_row; y++) {
+            if (alt_screen_cache_row_changed(term->alt_cache, y,
+                                             backend->grid + (size_t)y * (size_t)backend->grid_cols,
+                                             backend->grid_cols))
+                terminal_mark_lines_dirty(term, y, y);
+        }
+    } else {
+        terminal_mark_lines_dirty(term, rect.start_row, rect.end_row - 1);
+    }
+    trace_end("damage", trace_t0, rect.end_row - rect.start_row);
+    perf_stage_add(PERF_STAGE_CONVERT, perf_now() - t0);
+    return 1;
+}
+
+static int screen_moverect(VTermRect dest, VTermRect src, void* user)
+{
+    Terminal* term = (Terminal*)user;
+    LibVtermBackend* backend = (LibVtermBackend*)term->backend;
+    if (!backend) return 0;
+
+    int rows = dest.end_row - dest.start_row;
+    int cols = dest.end_col - dest.start_col;
+    if (rows <= 0 || cols <= 0) return 1;
+
+    uint64_t t0 = perf_now();
+    uint64_t trace_t0 = trace_begin();
+    // A stale grid is rebuilt wholesale on the next read; no point moving it.
+    if (backend->grid && !backend->grid_stale) {
+        size_t stride = (size_t)backend->grid_cols;
+        size_t bytes = sizeof(Glyph) * (size_t)cols;
+        bool top_down = dest.start_row <= src.start_row;
+        for (int i = 0; i < rows; i++) {
+            int r = top_down ? i : rows - 1 - i;
+            memmove(backend->grid + (size_t)(dest.start_row + r) * stride + dest.start_col,
+                    backend->grid + (size_t)(src.start_row + r) * stride + src.start_col,
+                    bytes);
+        }
+        if (cols == backend->grid_cols) {
+            memmove(backend->blink_cells + dest.start_row, backend->blink_cells + src.start_row,
+                    sizeof(uint16_t) * (size_t)rows);
+        } else {
+            for (int r = dest.start_row; r < dest.end_row; r++)
+                grid_count_blink(backend, r);
+        }
+    }
+    terminal_mark_lines_dirty(term, dest.start_row, dest.end_row - 1);
+    trace_end("moverect", trace_t0, rows);
+    perf_stage_add(PERF_STAGE_CONVERT, perf_now() - t0);
     return 1;
 }
 
@@ -154,6 +333,8 @@ static int screen_movecursor(VTermPos pos, VTermPos oldpos, int visible, void* u
 static int screen_settermprop(VTermProp prop, VTermValue* val, void* user)
 {
     Terminal* term = (Terminal*)user;
+    LibVtermBackend* backend = (LibVtermBackend*)term->backend;
+    if (!backend) return 1;
     switch (prop) {
         case VTERM_PROP_CURSORVISIBLE:
             term->cursor_visible = val->boolean;
@@ -168,11 +349,24 @@ static int screen_settermprop(VTermProp prop, VTermValue* val, void* user)
         case VTERM_PROP_ALTSCREEN:
             if (term->alt_screen_active != val->boolean) {
                 term->alt_screen_active = val->boolean;
-                term->full_redraw_needed = true;
+                if (!val->boolean)
+                    backend->primary_valid = false;
+                // libvterm has switched buffers already, but the grid keeps
+                // the primary screen until the switch's damage is flushed.
+                bool cached = false;
+                if (!backend->grid_stale && val->boolean) {
+                    if (!term->alt_cache)
+                        term->alt_cache = alt_screen_cache_create();
+                    cached = term->alt_cache && alt_screen_cache_enter(term->alt_cache, term, backend->grid);
+                } else if (!backend->grid_stale) {
+                    cached = alt_screen_cache_leave(term->alt_cache, term);
+                }
+                if (!cached)
+                    term->full_redraw_needed = true;
             }
             break;
         case VTERM_PROP_REVERSE:
-            term->full_redraw_needed = true;
+            grid_invalidate(term, backend);
             break;
         default:
             break;
@@ -201,12 +395,14 @@ static int screen_resize(int rows, int cols, void* user)
         bool* new_dirty = realloc(term->dirty_lines, sizeof(bool) * (size_t)rows);
         if (new_dirty) {
             term->dirty_lines = new_dirty;
-            for (int y = old_rows; y < rows; y++)
+            for (int y = 0; y < rows; y++)
                 term->dirty_lines[y] = true;
         }
 
         term->cols = cols;
         term->rows = rows;
+        if (grid_alloc(backend, rows, cols))
+            grid_sync(backend);
         term->full_redraw_needed = true;
         term->has_dirty_regions = true;
         term->dirty_min_y = 0;
@@ -241,11 +437,16 @@ static int screen_sb_clear_func(void* user)
     return 1;
 }
 
+// libvterm's answer to a DECRQM request for a mode it does not know
+static const char k_sync_unrecognized[] = "\x1b[?2026;0$y";
+
 static void output_callback(const char* s, size_t len, void* user)
 {
     Terminal* term = (Terminal*)user;
     LibVtermBackend* backend = (LibVtermBackend*)term->backend;
     if (!backend) return;
+    // The feed scanner answers for mode 2026 itself
+    if (len == sizeof(k_sync_unrecognized) - 1 && memcmp(s, k_sync_unrecognized, len) == 0) return;
 
     size_t space = sizeof(backend->output_buffer) - backend->output_len;
     if (space == 0) return;
@@ -256,6 +457,7 @@ static void output_callback(const char* s, size_t len, void* user)
 
 static const VTermScreenCallbacks screen_callbacks = {
     .damage = screen_damage,
+    .moverect = screen_moverect,
     .movecursor = screen_movecursor,
     .settermprop = screen_settermprop,
     .bell = screen_bell,
@@ -283,14 +485,21 @@ bool terminal_libvterm_init(Terminal* term, int cols, int rows)
     backend->screen = vterm_obtain_screen(backend->vt);
 
     vterm_screen_set_callbacks(backend->screen, &screen_callbacks, term);
+    // Coalesce damage until flush and report scrolls as moverect, so the
+    // grid sees one rect per burst instead of one callback per cell.
+    vterm_screen_set_damage_merge(backend->screen, VTERM_DAMAGE_SCROLL);
     vterm_screen_enable_altscreen(backend->screen, 1);
     vterm_output_set_callback(backend->vt, output_callback, term);
 
     int scrollback_cap = term->scrollback > 0 ? term->scrollback : 5000;
     sb_init(&backend->sb, scrollback_cap + rows, cols);
 
-    backend->line_buffer = NULL;
-    backend->line_buffer_cols = 0;
+    if (!grid_alloc(backend, rows, cols)) {
+        sb_free(&backend->sb);
+        vterm_free(backend->vt);
+        free(backend);
+        return false;
+    }
 
     term->backend = backend;
 
@@ -302,7 +511,10 @@ void terminal_libvterm_free(Terminal* term)
     if (!term || !term->backend) return;
     LibVtermBackend* backend = (LibVtermBackend*)term->backend;
     sb_free(&backend->sb);
-    free(backend->line_buffer);
+    free(backend->grid);
+    free(backend->view_rows);
+    free(backend->blink_cells);
+    free(backend->primary_cells);
     if (backend->vt) vterm_free(backend->vt);
     free(backend);
     term->backend = NULL;
@@ -313,6 +525,9 @@ void terminal_libvterm_reset(Terminal* term, bool hard)
     if (!term || !term->backend) return;
     LibVtermBackend* backend = (LibVtermBackend*)term->backend;
     sb_clear(&backend->sb);
+    backend->scan_state = MODE_SCAN_GROUND;
+    backend->primary_valid = false;
+    term->sync_output_active = false;
     vterm_screen_reset(backend->screen, hard);
     vterm_state_reset(backend->state, hard);
     vterm_set_utf8(backend->vt, 1);
@@ -327,11 +542,171 @@ void terminal_libvterm_reset(Terminal* term, bool hard)
     term->cursor_y = 0;
 }
 
+static bool is_alt_screen_mode(int mode)
+{
+    return mode == 47 || mode == 1047 || mode == 1049;
+}
+
+/**
+ * Scans for CSI ? ... 2026 ... h/l and the DECRQM request CSI ? 2026 $ p.
+ * A sequence setting an alternate screen mode is returned without its final
+ * byte first, so the primary screen can be captured before the switch.
+ * The state carries over between feeds, so sequences may be split.
+ * Returns the length up to and including the first such sequence, or
+ * @p len, with the event that sequence raised in @p event.
+ */
+static size_t mode_scan(LibVtermBackend* backend, const char* data, size_t len, ModeEvent* event)
+{
+    *event = MODE_EVENT_NONE;
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)data[i];
+        if (c == 0x1b) {
+            backend->scan_state = MODE_SCAN_ESC;
+            continue;
+        }
+        if (c == 0x18 || c == 0x1a) {
+            // CAN and SUB abort a sequence
+            backend->scan_state = MODE_SCAN_GROUND;
+            continue;
+        }
+        switch (backend->scan_state) {
+        case MODE_SCAN_GROUND:
+            break;
+        case MODE_SCAN_ESC:
+            backend->scan_state = c == '[' ? MODE_SCAN_CSI : MODE_SCAN_GROUND;
+            break;
+        case MODE_SCAN_CSI:
+            if (c == '?') {
+                backend->scan_state = MODE_SCAN_PRIVATE;
+                backend->mode_param = 0;
+                backend->sync_has_2026 = false;
+                backend->alt_has_mode = false;
+                backend->alt_split_done = false;
+            } else if (c >= 0x20) {
+                // C0 controls run inside a sequence without ending it
+                backend->scan_state = MODE_SCAN_GROUND;
+            }
+            break;
+        case MODE_SCAN_PRIVATE:
+            if (c >= '0' && c <= '9') {
+                if (backend->mode_param < 100000)
+                    backend->mode_param = backend->mode_param * 10 + (c - '0');
+            } else if (c == ';') {
+                backend->sync_has_2026 |= backend->mode_param == 2026;
+                backend->alt_has_mode |= is_alt_screen_mode(backend->mode_param);
+                backend->mode_param = 0;
+            } else if (c >= 0x20) {
+                backend->sync_has_2026 |= backend->mode_param == 2026;
+                backend->alt_has_mode |= is_alt_screen_mode(backend->mode_param);
+                if (c == 'h' && backend->alt_has_mode && !backend->alt_split_done) {
+                    // Stop short of the final byte; the next call scans it again
+                    backend->alt_split_done = true;
+                    *event = MODE_EVENT_ALT_ENTER;
+                    return i;
+                }
+                backend->scan_state = c == '$' ? MODE_SCAN_DOLLAR : MODE_SCAN_GROUND;
+                if (backend->sync_has_2026 && (c == 'h' || c == 'l')) {
+                    *event = c == 'h' ? MODE_EVENT_SYNC_SET : MODE_EVENT_SYNC_RESET;
+                    return i + 1;
+                }
+            }
+            break;
+        case MODE_SCAN_DOLLAR:
+            if (c >= 0x20) {
+                backend->scan_state = MODE_SCAN_GROUND;
+                // DECRQM takes a single mode
+                if (c == 'p' && backend->mode_param == 2026) {
+                    *event = MODE_EVENT_SYNC_QUERY;
+                    return i + 1;
+                }
+            }
+            break;
+        }
+    }
+    return len;
+}
+
+static void capture_primary(Terminal* term, LibVtermBackend* backend)
+{
+    int rows = term->rows, cols = term->cols;
+    if (backend->primary_rows != rows || backend->primary_cols != cols) {
+        VTermScreenCell* cells = realloc(backend->primary_cells,
+                                         sizeof(VTermScreenCell) * (size_t)rows * (size_t)cols);
+        if (!cells) {
+            WARN_LOG("Failed to keep the primary screen for session snapshots");
+            backend->primary_valid = false;
+            return;
+        }
+        backend->primary_cells = cells;
+        backend->primary_rows = rows;
+        backend->primary_cols = cols;
+    }
+    for (int y = 0; y < rows; y++)
+        for (int x = 0; x < cols; x++)
+            vterm_screen_get_cell(backend->screen, (VTermPos){ .row = y, .col = x },
+                                  &backend->primary_cells[(size_t)y * (size_t)cols + (size_t)x]);
+    VTermPos cursor;
+    vterm_state_get_cursorpos(backend->state, &cursor);
+    backend->primary_modes[0] = cursor.row;
+    backend->primary_modes[1] = cursor.col;
+    backend->primary_modes[2] = term->cursor_visible;
+    backend->primary_modes[3] = term->cursor_style;
+    backend->primary_modes[4] = term->cursor_style_blinking;
+    backend->primary_valid = true;
+}
+
+static void mode_handle(Terminal* term, ModeEvent event)
+{
+    switch (event) {
+    case MODE_EVENT_ALT_ENTER:
+        if (!term->alt_screen_active)
+            capture_primary(term, (LibVtermBackend*)term->backend);
+        break;
+    case MODE_EVENT_SYNC_SET:
+        // A repeated set keeps the timeout of the update in progress
+        if (!term->sync_output_active) {
+            term->sync_output_active = true;
+            term->sync_output_since = SDL_GetTicks();
+        }
+        break;
+    case MODE_EVENT_SYNC_RESET:
+        term->sync_output_active = false;
+        break;
+    case MODE_EVENT_SYNC_QUERY: {
+        // 1 = set, 2 = reset
+        char reply[32];
+        int n = snprintf(reply, sizeof(reply), "\x1b[?2026;%d$y", term->sync_output_active ? 1 : 2);
+        output_callback(reply, (size_t)n, term);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 void terminal_libvterm_feed(Terminal* term, const char* data, size_t len)
 {
     if (!term || !term->backend || !data) return;
     LibVtermBackend* backend = (LibVtermBackend*)term->backend;
-    vterm_input_write(backend->vt, data, len);
+
+    // Damage callbacks fire inside the write; book them as conversion
+    uint64_t convert_before = g_perf.stage_ticks[PERF_STAGE_CONVERT];
+    uint64_t t0 = perf_now();
+    uint64_t trace_t0 = trace_begin();
+    // Split at each mode 2026 sequence, so the mode changes where it is in the
+    // stream, and ahead of each alternate screen switch
+    size_t off = 0;
+    while (off < len) {
+        ModeEvent event;
+        size_t n = mode_scan(backend, data + off, len - off, &event);
+        vterm_input_write(backend->vt, data + off, n);
+        off += n;
+        mode_handle(term, event);
+    }
+    trace_end("vterm_input_write", trace_t0, (int64_t)len);
+    uint64_t elapsed = perf_now() - t0;
+    uint64_t convert = g_perf.stage_ticks[PERF_STAGE_CONVERT] - convert_before;
+    perf_stage_add(PERF_STAGE_PARSE, elapsed > convert ? elapsed - convert : 0);
 }
 
 void terminal_libvterm_key(Terminal* term, VTermKey key, VTermModifier mod)
@@ -373,6 +748,7 @@ void terminal_libvterm_set_default_colors(Terminal* term, SDL_Color fg, SDL_Colo
     vterm_screen_set_default_colors(backend->screen, &vfg, &vbg);
     term->default_fg = fg;
     term->default_bg = bg;
+    grid_invalidate(term, backend);
 }
 
 void terminal_libvterm_set_palette_color(Terminal* term, int index, SDL_Color color)
@@ -383,6 +759,7 @@ void terminal_libvterm_set_palette_color(Terminal* term, int index, SDL_Color co
     vterm_color_rgb(&vcol, color.r, color.g, color.b);
     vterm_state_set_palette_color(backend->state, index, &vcol);
     term->palette[index] = color;
+    grid_invalidate(term, backend);
 }
 
 void terminal_libvterm_flush_damage(Terminal* term)
@@ -411,8 +788,19 @@ size_t terminal_libvterm_flush_output(Terminal* term, char* dst, size_t dst_len)
 
 static void convert_cell_to_glyph(VTermScreen* screen, const VTermScreenCell* cell, Glyph* g)
 {
-    g->character = cell->chars[0] ? cell->chars[0] : ' ';
-    g->width = (cell->width == 2) ? 2 : 1;
+    if (cell->chars[0] == (uint32_t)-1) {
+        // Right half of a wide character: nothing to draw but the background
+        g->character = 0;
+        g->width = 0;
+    } else {
+        // Combining marks and ZWJ sequences make the cell a cluster
+        int n = 0;
+        while (n < VTERM_MAX_CHARS_PER_CELL && cell->chars[n]) {
+            n++;
+        }
+        g->character = glyph_cluster_intern(cell->chars, n);
+        g->width = (cell->width == 2) ? 2 : 1;
+    }
 
     VTermColor fg = cell->fg;
     vterm_screen_convert_color_to_rgb(screen, &fg);
@@ -443,42 +831,363 @@ Glyph* terminal_libvterm_get_view_line(Terminal* term, int y)
     LibVtermBackend* backend = (LibVtermBackend*)term->backend;
     ScrollbackBuffer* sb = &backend->sb;
 
-    Glyph* buf = ensure_line_buffer(backend, term->cols);
-    if (!buf) return NULL;
+    if (!backend->grid || y >= backend->grid_rows) return NULL;
+    grid_sync(backend);
 
-    if (term->view_offset == 0) {
-        VTermScreenCell cell;
-        for (int x = 0; x < term->cols; x++) {
-            vterm_screen_get_cell(backend->screen, (VTermPos){ .row = y, .col = x }, &cell);
-            convert_cell_to_glyph(backend->screen, &cell, &buf[x]);
+    size_t stride = (size_t)backend->grid_cols;
+    if (term->view_offset == 0)
+        return backend->grid + (size_t)y * stride;
+
+    int sb_line = sb->count - term->view_offset + y;
+    if (sb_line >= sb->count)
+        return backend->grid + (size_t)(sb_line - sb->count) * stride;
+
+    Glyph* buf = backend->view_rows + (size_t)y * stride;
+    if (sb_line >= 0) {
+        const VTermScreenCell* sc = sb_line_at(sb, sb_line);
+        int n = sb->cols < backend->grid_cols ? sb->cols : backend->grid_cols;
+        for (int x = 0; x < n; x++) {
+            convert_cell_to_glyph(backend->screen, &sc[x], &buf[x]);
+        }
+        for (int x = n; x < backend->grid_cols; x++) {
+            buf[x] = (Glyph){.character=' ', .width=1, .fg=term->default_fg, .bg=term->default_bg};
         }
     } else {
-        int sb_line = sb->count - term->view_offset + y;
-        if (sb_line >= 0 && sb_line < sb->count) {
-            const VTermScreenCell* sc = sb->lines[sb_line];
-            for (int x = 0; x < term->cols; x++) {
-                convert_cell_to_glyph(backend->screen, &sc[x], &buf[x]);
-            }
-        } else if (sb_line >= sb->count) {
-            VTermScreenCell cell;
-            int screen_row = sb_line - sb->count;
-            for (int x = 0; x < term->cols; x++) {
-                vterm_screen_get_cell(backend->screen, (VTermPos){ .row = screen_row, .col = x }, &cell);
-                convert_cell_to_glyph(backend->screen, &cell, &buf[x]);
-            }
-        } else {
-            for (int x = 0; x < term->cols; x++) {
-                buf[x] = (Glyph){.character=' ', .width=1, .fg=term->default_bg, .bg=term->default_bg};
-            }
+        for (int x = 0; x < backend->grid_cols; x++) {
+            buf[x] = (Glyph){.character=' ', .width=1, .fg=term->default_bg, .bg=term->default_bg};
         }
     }
-
     return buf;
 }
 
+int terminal_libvterm_get_blink_cells(Terminal* term, int y)
+{
+    if (!term || !term->backend) return 0;
+    LibVtermBackend* backend = (LibVtermBackend*)term->backend;
+    if (!backend->blink_cells || y < 0 || y >= backend->grid_rows) return 0;
+    grid_sync(backend);
+    return backend->blink_cells[y];
+}
+
 int terminal_libvterm_get_scrollback_count(Terminal* term)
 {
     if (!term || !term->backend) return 0;
     LibVtermBackend* backend = (LibVtermBackend*)term->backend;
     return backend->sb.count;
 }
+
+size_t terminal_libvterm_get_scrollback_bytes(Terminal* term)
+{
+    if (!term || !term->backend) return 0;
+    LibVtermBackend* backend = (LibVtermBackend*)term->backend;
+    // Rows are preallocated, so this is the full capacity, not just used rows
+    return (size_t)backend->sb.capacity *
+           (sizeof(VTermScreenCell*) + sizeof(VTermScreenCell) * (size_t)backend->sb.cols);
+}
+
+// --- Session state serialization ---
+//
+// Lines are stored trimmed of trailing blank cells. Each cell is a fixed
+// 12-byte record followed by its codepoints, which keeps a typical
+// scrollback line well under its in-memory VTermScreenCell size.
+
+typedef struct {
+    uint8_t nchars;
+    uint8_t width;
+    uint16_t attrs;
+    VTermColor fg;
+    VTermColor bg;
+} StateCell;
+
+_Static_assert(sizeof(StateCell) == 12, "StateCell is a packed on-disk record");
+
+static uint16_t pack_cell_attrs(const VTermScreenCellAttrs* a)
+{
+    return (uint16_t)(a->bold | (a->underline << 1) | (a->italic << 3) | (a->blink << 4) |
+                      (a->reverse << 5) | (a->conceal << 6) | (a->strike << 7) |
+                      (a->font << 8) | (a->dwl << 12) | (a->dhl << 13));
+}
+
+static void unpack_cell_attrs(uint16_t v, VTermScreenCellAttrs* a)
+{
+    memset(a, 0, sizeof(*a));
+    a->bold = v & 1;
+    a->underline = (v >> 1) & 3;
+    a->italic = (v >> 3) & 1;
+    a->blink = (v >> 4) & 1;
+    a->reverse = (v >> 5) & 1;
+    a->conceal = (v >> 6) & 1;
+    a->strike = (v >> 7) & 1;
+    a->font = (v >> 8) & 15;
+    a->dwl = (v >> 12) & 1;
+    a->dhl = (v >> 13) & 3;
+}
+
+static void blank_cell(const Terminal* term, VTermScreenCell* cell)
+{
+    memset(cell, 0, sizeof(*cell));
+    cell->width = 1;
+    vterm_color_rgb(&cell->fg, term->default_fg.r, term->default_fg.g, term->default_fg.b);
+    cell->fg.type |= VTERM_COLOR_DEFAULT_FG;
+    vterm_color_rgb(&cell->bg, term->default_bg.r, term->default_bg.g, term->default_bg.b);
+    cell->bg.type |= VTERM_COLOR_DEFAULT_BG;
+}
+
+static bool cell_is_blank(const VTermScreenCell* cell)
+{
+    return (cell->chars[0] == 0 || (cell->chars[0] == ' ' && cell->chars[1] == 0)) &&
+           pack_cell_attrs(&cell->attrs) == 0 && VTERM_COLOR_IS_DEFAULT_BG(&cell->bg);
+}
+
+static bool write_state_line(FILE* file, const VTermScreenCell* cells, int cols)
+{
+    uint16_t n = (uint16_t)cols;
+    while (n > 0 && cell_is_blank(&cells[n - 1]))
+        n--;
+    if (fwrite(&n, sizeof(n), 1, file) != 1) return false;
+
+    for (int x = 0; x < n; x++) {
+        const VTermScreenCell* c = &cells[x];
+        StateCell rec = { .width = (uint8_t)c->width, .attrs = pack_cell_attrs(&c->attrs),
+                          .fg = c->fg, .bg = c->bg };
+        while (rec.nchars < VTERM_MAX_CHARS_PER_CELL && c->chars[rec.nchars])
+            rec.nchars++;
+        if (fwrite(&rec, sizeof(rec), 1, file) != 1) return false;
+        if (rec.nchars && fwrite(c->chars, sizeof(uint32_t), rec.nchars, file) != rec.nchars)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Reads one stored line into @p cells, padding up to @p cols with blanks.
+ * Cells beyond @p cols are consumed and dropped.
+ */
+static bool read_state_line(FILE* file, const Terminal* term, VTermScreenCell* cells, int cols)
+{
+    uint16_t n;
+    if (fread(&n, sizeof(n), 1, file) != 1) return false;
+
+    for (int x = 0; x < n; x++) {
+        StateCell rec;
+        uint32_t chars[VTERM_MAX_CHARS_PER_CELL] = {0};
+        if (fread(&rec, sizeof(rec), 1, file) != 1) return false;
+        if (rec.nchars > VTERM_MAX_CHARS_PER_CELL) return false;
+        if (rec.nchars && fread(chars, sizeof(uint32_t), rec.nchars, file) != rec.nchars)
+            return false;
+        if (x >= cols) continue;
+
+        VTermScreenCell* c = &cells[x];
+        memset(c, 0, sizeof(*c));
+        memcpy(c->chars, chars, sizeof(uint32_t) * rec.nchars);
+        c->width = (char)rec.width;
+        unpack_cell_attrs(rec.attrs, &c->attrs);
+        c->fg = rec.fg;
+        c->bg = rec.bg;
+    }
+    for (int x = n; x < cols; x++)
+        blank_cell(term, &cells[x]);
+    return true;
+}
+
+static size_t append_utf8(char* out, uint32_t c)
+{
+    if (c < 0x80) {
+        out[0] = (char)c;
+        return 1;
+    } else if (c < 0x800) {
+        out[0] = (char)(0xC0 | (c >> 6));
+        out[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
+    } else if (c < 0x10000) {
+        out[0] = (char)(0xE0 | (c >> 12));
+        out[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (c >> 18));
+    out[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
+
+static int format_sgr_color(char* out, size_t len, const VTermColor* col, bool is_fg)
+{
+    if (is_fg ? VTERM_COLOR_IS_DEFAULT_FG(col) : VTERM_COLOR_IS_DEFAULT_BG(col))
+        return 0;
+    if (VTERM_COLOR_IS_INDEXED(col))
+        return snprintf(out, len, ";%d;5;%d", is_fg ? 38 : 48, col->indexed.idx);
+    return snprintf(out, len, ";%d;2;%d;%d;%d", is_fg ? 38 : 48,
+                    col->rgb.red, col->rgb.green, col->rgb.blue);
+}
+
+/** Writes an SGR sequence that fully sets the pen to the cell's attributes. */
+static size_t format_sgr(char* out, const VTermScreenCell* c)
+{
+    static const char* const underline_sgr[] = { "", ";4", ";21", ";4:3" };
+    char* p = out;
+    p += sprintf(p, "\x1b[0");
+    if (c->attrs.bold) p += sprintf(p, ";1");
+    if (c->attrs.italic) p += sprintf(p, ";3");
+    p += sprintf(p, "%s", underline_sgr[c->attrs.underline & 3]);
+    if (c->attrs.blink) p += sprintf(p, ";5");
+    if (c->attrs.reverse) p += sprintf(p, ";7");
+    if (c->attrs.conceal) p += sprintf(p, ";8");
+    if (c->attrs.strike) p += sprintf(p, ";9");
+    if (c->attrs.font) p += sprintf(p, ";%d", 10 + c->attrs.font);
+    p += format_sgr_color(p, 24, &c->fg, true);
+    p += format_sgr_color(p, 24, &c->bg, false);
+    *p++ = 'm';
+    return (size_t)(p - out);
+}
+
+/**
+ * Replays one row of cells into libvterm as escape sequences. libvterm has
+ * no API for writing cells directly, so this is the only way to put
+ * content back on its screen.
+ */
+static void feed_state_row(LibVtermBackend* backend, const VTermScreenCell* cells,
+                           int cols, int row, char* buf)
+{
+    char* p = buf;
+    p += sprintf(p, "\x1b[%d;1H", row + 1);
+
+    const VTermScreenCell* pen = NULL;
+    int n = cols;
+    while (n > 0 && cell_is_blank(&cells[n - 1]))
+        n--;
+    for (int x = 0; x < n; x++) {
+        const VTermScreenCell* c = &cells[x];
+        if (c->chars[0] == (uint32_t)-1)
+            continue;
+        if (!pen || memcmp(&pen->attrs, &c->attrs, sizeof(c->attrs)) != 0 ||
+            memcmp(&pen->fg, &c->fg, sizeof(c->fg)) != 0 ||
+            memcmp(&pen->bg, &c->bg, sizeof(c->bg)) != 0) {
+            p += format_sgr(p, c);
+            pen = c;
+        }
+        if (c->chars[0] == 0) {
+            *p++ = ' ';
+            continue;
+        }
+        for (int i = 0; i < VTERM_MAX_CHARS_PER_CELL && c->chars[i]; i++)
+            p += append_utf8(p, c->chars[i]);
+    }
+    p += sprintf(p, "\x1b[0m");
+    vterm_input_write(backend->vt, buf, (size_t)(p - buf));
+}
+
+bool terminal_libvterm_save_state(Terminal* term, FILE* file)
+{
+    if (!term || !term->backend || !file) return false;
+    LibVtermBackend* backend = (LibVtermBackend*)term->backend;
+    ScrollbackBuffer* sb = &backend->sb;
+
+    // A resumed session starts a new shell on the primary screen; save that
+    // screen, not the alternate one of a program that will not come back.
+    bool primary = term->alt_screen_active;
+    if (primary && !backend->primary_valid) {
+        WARN_LOG("Primary screen unavailable, terminal state not saved");
+        return false;
+    }
+    int rows = primary ? backend->primary_rows : term->rows;
+    int cols = primary ? backend->primary_cols : term->cols;
+
+    int32_t header[4] = { sb->count, sb->cols, rows, cols };
+    if (fwrite(header, sizeof(header), 1, file) != 1) return false;
+
+    for (int i = 0; i < sb->count; i++) {
+        if (!write_state_line(file, sb_line_at(sb, i), sb->cols)) return false;
+    }
+
+    if (primary) {
+        for (int y = 0; y < rows; y++) {
+            if (!write_state_line(file, backend->primary_cells + (size_t)y * (size_t)cols, cols))
+                return false;
+        }
+        return fwrite(backend->primary_modes, sizeof(backend->primary_modes), 1, file) == 1;
+    }
+
+    VTermScreenCell* row = malloc(sizeof(VTermScreenCell) * (size_t)cols);
+    if (!row) return false;
+    bool ok = true;
+    for (int y = 0; y < rows && ok; y++) {
+        for (int x = 0; x < cols; x++)
+            vterm_screen_get_cell(backend->screen, (VTermPos){ .row = y, .col = x }, &row[x]);
+        ok = write_state_line(file, row, cols);
+    }
+    free(row);
+    if (!ok) return false;
+
+    VTermPos cursor;
+    vterm_state_get_cursorpos(backend->state, &cursor);
+    int32_t modes[5] = { cursor.row, cursor.col, term->cursor_visible,
+                         term->cursor_style, term->cursor_style_blinking };
+    return fwrite(modes, sizeof(modes), 1, file) == 1;
+}
+
+bool terminal_libvterm_load_state(Terminal* term, FILE* file)
+{
+    if (!term || !term->backend || !file) return false;
+    LibVtermBackend* backend = (LibVtermBackend*)term->backend;
+    ScrollbackBuffer* sb = &backend->sb;
+
+    int32_t header[4];
+    if (fread(header, sizeof(header), 1, file) != 1) return false;
+    int sb_count = header[0], sb_cols = header[1], rows = header[2], cols = header[3];
+    if (sb_count < 0 || sb_cols <= 0 || rows <= 0 || cols <= 0 ||
+        sb_cols > 4096 || rows > 4096 || cols > 4096) {
+        ERROR_LOG("Corrupt terminal state header (%d lines, %dx%d)", sb_count, cols, rows);
+        return false;
+    }
+
+    int max_cols = SDL_max(cols, SDL_max(term->cols, sb->cols));
+    VTermScreenCell* cells = malloc(sizeof(VTermScreenCell) * (size_t)max_cols);
+    char* feed_buf = malloc((size_t)term->cols * 96 + 64);
+    if (!cells || !feed_buf) {
+        free(cells);
+        free(feed_buf);
+        return false;
+    }
+
+    bool ok = true;
+    sb_clear(sb);
+    for (int i = 0; i < sb_count && ok; i++) {
+        ok = read_state_line(file, term, cells, sb->cols);
+        if (ok) sb_push(sb, cells, sb->cols);
+    }
+
+    // Rows that no longer fit the (smaller) screen become scrollback.
+    int excess = rows > term->rows ? rows - term->rows : 0;
+    vterm_input_write(backend->vt, "\x1b[H\x1b[2J", 7);
+    for (int y = 0; y < rows && ok; y++) {
+        ok = read_state_line(file, term, cells, max_cols);
+        if (!ok) break;
+        if (y < excess)
+            sb_push(sb, cells, sb->cols);
+        else
+            feed_state_row(backend, cells, term->cols, y - excess, feed_buf);
+    }
+
+    int32_t modes[5];
+    if (ok && fread(modes, sizeof(modes), 1, file) != 1) ok = false;
+    if (ok) {
+        int cursor_row = SDL_max(0, SDL_min(term->rows - 1, modes[0] - excess));
+        int cursor_col = SDL_max(0, SDL_min(term->cols - 1, modes[1]));
+        // DECSCUSR: 1/2 block, 3/4 underline, 5/6 bar; odd values blink
+        int shape = modes[3] == CURSOR_STYLE_BAR ? 5 : modes[3] == CURSOR_STYLE_UNDERLINE ? 3 : 1;
+        int len = snprintf(feed_buf, 64, "\x1b[%d;%dH\x1b[?25%c\x1b[%d q",
+                           cursor_row + 1, cursor_col + 1, modes[2] ? 'h' : 'l',
+                           shape + (modes[4] ? 0 : 1));
+        vterm_input_write(backend->vt, feed_buf, (size_t)len);
+    }
+    vterm_screen_flush_damage(backend->screen);
+
+    free(cells);
+    free(feed_buf);
+    if (!ok) {
+        ERROR_LOG("Truncated terminal state, history partially restored");
+    }
+    return ok;
+}
@@ -13,6 +13,9 @@
 #include "osk_parser.h"
 #include "input_mapper.h"
 #include "keyboard_handler.h"
+#include "session_record.h"
+#include "perf_stats.h"
+#include "input_latency.h"
 #include "config.h"
 #include "font_manager.h"
 #include "error_codes.h"
@@ -122,10 +125,15 @@ static void execute_internal_command(InternalCommand cmd, Terminal* term, bool*
     case CMD_RELOAD_THEME:
         if (config->colorscheme_path) {
             terminal_load_colorscheme(term, config->colorscheme_path);
+            term->full_redraw_needed = true;
             *needs_render = true;
             INFO_LOG("Theme reloaded: %s", config->colorscheme_path);
         }
         break;
+    case CMD_PERF_HUD_TOGGLE:
+        perf_hud_toggle();
+        *needs_render = true;
+        break;
     case CMD_NONE:
         break;
     }
@@ -135,6 +143,7 @@ void event_handle_terminal_action(TerminalAction action, Terminal* term, OnScree
                                  bool* needs_render, int master_fd, TTF_Font** font, 
                                  Config* config, int* char_w, int* char_h)
 {
+    input_latency_event();
     switch (action) {
     case ACTION_SCROLL_UP:
         terminal_scroll_view(term, SDL_max(1, term->rows / 2), needs_render);
@@ -252,6 +261,11 @@ void event_handle(SDL_Event* event, bool* running, bool* needs_render, Terminal*
         return;
     }
 
+    if (event->type == SDL_KEYDOWN || event->type == SDL_TEXTINPUT ||
+        event->type == SDL_CONTROLLERBUTTONDOWN || event->type == SDL_JOYBUTTONDOWN) {
+        input_latency_event();
+    }
+
     if (event->type == SDL_QUIT) {
         *running = false;
         return;
@@ -271,7 +285,7 @@ void event_handle(SDL_Event* event, bool* running, bool* needs_render, Terminal*
         switch (event->type) {
         case SDL_TEXTINPUT: {
             const char* text = event->text.text;
-            (void)write(master_fd, text, strlen(text));
+            (void)session_record_write(master_fd, text, strlen(text));
             break;
         }
         case SDL_KEYDOWN: {
@@ -304,18 +318,18 @@ void event_handle(SDL_Event* event, bool* running, bool* needs_render, Terminal*
                 default: break;
             }
             if (seq) {
-                (void)write(master_fd, seq, strlen(seq));
+                (void)session_record_write(master_fd, seq, strlen(seq));
             } else {
                 if (sym == SDLK_RETURN || sym == SDLK_KP_ENTER) {
-                    char c = '\r'; (void)write(master_fd, &c, 1);
+                    char c = '\r'; (void)session_record_write(master_fd, &c, 1);
                 } else if (sym == SDLK_BACKSPACE) {
-                    char c = '\x7f'; (void)write(master_fd, &c, 1);
+                    char c = '\x7f'; (void)session_record_write(master_fd, &c, 1);
                 } else if (sym == SDLK_TAB) {
-                    char c = '\t'; (void)write(master_fd, &c, 1);
+                    char c = '\t'; (void)session_record_write(master_fd, &c, 1);
                 } else if (sym == SDLK_ESCAPE) {
-                    char c = '\x1b'; (void)write(master_fd, &c, 1);
+                    char c = '\x1b'; (void)session_record_write(master_fd, &c, 1);
                 } else if (sym == SDLK_SPACE) {
-                    char c = ' '; (void)write(master_fd, &c, 1);
+                    char c = ' '; (void)session_record_write(master_fd, &c, 1);
                 }
             }
             break;
@@ -328,15 +342,15 @@ void event_handle(SDL_Event* event, bool* running, bool* needs_render, Terminal*
                 case ACTION_DOWN:      seq = "\x1b[B"; break;
                 case ACTION_RIGHT:     seq = "\x1b[C"; break;
                 case ACTION_LEFT:      seq = "\x1b[D"; break;
-                case ACTION_ENTER:     { char c = '\r'; (void)write(master_fd, &c, 1); break; }
-                case ACTION_BACKSPACE: { char c = '\x7f'; (void)write(master_fd, &c, 1); break; }
-                case ACTION_TAB:       { char c = '\t'; (void)write(master_fd, &c, 1); break; }
-                case ACTION_ESCAPE:    { char c = '\x1b'; (void)write(master_fd, &c, 1); break; }
-                case ACTION_SPACE:     { char c = ' '; (void)write(master_fd, &c, 1); break; }
+                case ACTION_ENTER:     { char c = '\r'; (void)session_record_write(master_fd, &c, 1); break; }
+                case ACTION_BACKSPACE: { char c = '\x7f'; (void)session_record_write(master_fd, &c, 1); break; }
+                case ACTION_TAB:       { char c = '\t'; (void)session_record_write(master_fd, &c, 1); break; }
+                case ACTION_ESCAPE:    { char c = '\x1b'; (void)session_record_write(master_fd, &c, 1); break; }
+                case ACTION_SPACE:     { char c = ' '; (void)session_record_write(master_fd, &c, 1); break; }
                 case ACTION_TOGGLE_OSK: break;
                 default: break;
             }
-            if (seq) (void)write(master_fd, seq, strlen(seq));
+            if (seq) (void)session_record_write(master_fd, seq, strlen(seq));
             break;
         }
         default:
@@ -1,9 +1,16 @@
 /**
  * @file font_manager.c
  * @brief Font management and dynamic font size changing.
+ *
+ * The font file is read into memory once and every size is opened from
+ * that buffer. Sizes zoomed away from keep their font handle and glyph
+ * cache in a small LRU, so zooming back is a pointer swap, and the next
+ * size in the zoom direction is prepared while the terminal is idle.
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <SDL_ttf.h>
 
@@ -13,6 +20,183 @@
 #include "osk_core.h"
 #include "osk_renderer.h"
 #include "glyph_cache.h"
+#include "quality_governor.h"
+
+#define FONT_ZOOM_RETAINED 2 // Sizes kept besides the current one; each holds a glyph atlas
+
+// Grid font when a bitmap font is configured; the TTF font still draws the OSK and HUD
+static BitmapFont* s_bitmap_font = NULL;
+
+// Font file contents, shared by every open size
+static void* s_font_data = NULL;
+static size_t s_font_data_len = 0;
+static char* s_font_data_path = NULL;
+
+typedef struct {
+    int size;               // 0 = empty
+    TTF_Font* font;
+    GlyphCache* glyph_cache;
+    uint32_t last_used;
+} FontZoomSlot;
+
+static FontZoomSlot s_zoom[FONT_ZOOM_RETAINED];
+static uint32_t s_zoom_clock = 0;
+static int s_prewarm_size = 0;  // Size to prepare when idle, 0 = none
+
+TTF_Font* font_open(const char* path, int size)
+{
+    if (!path) {
+        return NULL;
+    }
+    if (!s_font_data || !s_font_data_path || strcmp(s_font_data_path, path) != 0) {
+        size_t len = 0;
+        void* data = SDL_LoadFile(path, &len);
+        if (!data) {
+            ERROR_LOG("Failed to read font %s: %s", path, SDL_GetError());
+            return NULL;
+        }
+        // Handles opened from the previous buffer are gone by now: the path
+        // only changes before the first font is opened
+        SDL_free(s_font_data);
+        free(s_font_data_path);
+        s_font_data = data;
+        s_font_data_len = len;
+        s_font_data_path = strdup(path);
+    }
+    SDL_RWops* rw = SDL_RWFromConstMem(s_font_data, (int)s_font_data_len);
+    return rw ? TTF_OpenFontRW(rw, 1, size) : NULL;
+}
+
+static void zoom_slot_release(FontZoomSlot* slot)
+{
+    if (slot->glyph_cache) {
+        glyph_cache_cleanup(slot->glyph_cache);
+        free(slot->glyph_cache);
+    }
+    if (slot->font) {
+        TTF_CloseFont(slot->font);
+    }
+    memset(slot, 0, sizeof(*slot));
+}
+
+static FontZoomSlot* zoom_find(int size)
+{
+    for (int i = 0; i < FONT_ZOOM_RETAINED; i++) {
+        if (s_zoom[i].size == size) {
+            return &s_zoom[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Retains a size, evicting the least recently used one.
+ */
+static void zoom_retain(int size, TTF_Font* font, GlyphCache* glyph_cache)
+{
+    FontZoomSlot* slot = &s_zoom[0];
+    for (int i = 0; i < FONT_ZOOM_RETAINED; i++) {
+        if (s_zoom[i].size == 0) {
+            slot = &s_zoom[i];
+            break;
+        }
+        if (s_zoom[i].last_used < slot->last_used) {
+            slot = &s_zoom[i];
+        }
+    }
+    zoom_slot_release(slot);
+    *slot = (FontZoomSlot){ size, font, glyph_cache, ++s_zoom_clock };
+}
+
+static GlyphCache* zoom_create_glyph_cache(const Config* config, int size)
+{
+    GlyphCache* cache = malloc(sizeof(GlyphCache));
+    if (!cache || !glyph_cache_init(cache, GLYPH_CACHE_SIZE)) {
+        ERROR_LOG("Failed to allocate glyph cache for size %d", size);
+        free(cache);
+        return NULL;
+    }
+    glyph_cache_set_font(cache, config->font_path, size);
+    glyph_cache_set_color_depth(cache, config->color_depth);
+    // Rasterize at the tier the governor holds, not at full quality
+    glyph_cache_set_raster_mode(cache, quality_governor_raster_mode());
+    return cache;
+}
+
+void font_manager_prewarm(SDL_Renderer* renderer, const Config* config)
+{
+    int size = s_prewarm_size;
+    if (size == 0) {
+        return;
+    }
+    s_prewarm_size = 0;
+    if (size < 6 || size > 72 || size == config->font_size || zoom_find(size)) {
+        return;
+    }
+
+    Uint32 start = SDL_GetTicks();
+    TTF_Font* font = font_open(config->font_path, size);
+    GlyphCache* cache = font ? zoom_create_glyph_cache(config, size) : NULL;
+    if (!cache || !glyph_cache_prepare(cache, renderer, font)) {
+        if (cache) {
+            glyph_cache_cleanup(cache);
+            free(cache);
+        }
+        if (font) {
+            TTF_CloseFont(font);
+        }
+        return;
+    }
+    zoom_retain(size, font, cache);
+    DEBUG_LOG("Prewarmed font size %d in %u ms", size, SDL_GetTicks() - start);
+}
+
+bool font_manager_open_bitmap(const char* path)
+{
+    BitmapFont* font = bitmap_font_open(path);
+    if (!font) {
+        return false;
+    }
+    bitmap_font_close(s_bitmap_font);
+    s_bitmap_font = font;
+    return true;
+}
+
+const BitmapFont* font_manager_bitmap(void)
+{
+    return s_bitmap_font;
+}
+
+void font_manager_cleanup(void)
+{
+    for (int i = 0; i < FONT_ZOOM_RETAINED; i++) {
+        zoom_slot_release(&s_zoom[i]);
+    }
+    s_prewarm_size = 0;
+    bitmap_font_close(s_bitmap_font);
+    s_bitmap_font = NULL;
+    SDL_free(s_font_data);
+    s_font_data = NULL;
+    s_font_data_len = 0;
+    free(s_font_data_path);
+    s_font_data_path = NULL;
+}
+
+bool font_cell_size(TTF_Font* font, int* char_w, int* char_h)
+{
+    if (s_bitmap_font) {
+        *char_w = s_bitmap_font->width;
+        *char_h = s_bitmap_font->height;
+        return true;
+    }
+    int w, h;
+    if (!font || TTF_SizeUTF8(font, "W", &w, &h) != 0 || w <= 0 || h <= 0) {
+        return false;
+    }
+    *char_w = w;
+    *char_h = h;
+    return true;
+}
 
 /**
  * @brief Changes the font size and updates all related components.
@@ -20,26 +204,54 @@
 bool font_change_size(TTF_Font** font, Config* config, Terminal* term, OnScreenKeyboard* osk,
                      int* char_w, int* char_h, int master_fd, int delta)
 {
+    if (s_bitmap_font) {
+        INFO_LOG("Bitmap fonts have a fixed size");
+        return false;
+    }
+
     int new_font_size = config->font_size + delta;
     if (new_font_size < 6 || new_font_size > 72) {
         return false;
     }
 
-    TTF_Font* new_font = TTF_OpenFont(config->font_path, new_font_size);
-    if (!new_font) {
-        ERROR_LOG("Failed to change font size to %d: %s", new_font_size, TTF_GetError());
-        return false;
+    // A retained size comes back with its glyphs
+    TTF_Font* new_font = NULL;
+    GlyphCache* new_cache = NULL;
+    FontZoomSlot* slot = zoom_find(new_font_size);
+    if (slot) {
+        new_font = slot->font;
+        new_cache = slot->glyph_cache;
+        memset(slot, 0, sizeof(*slot));
+        // The tier may have changed while this size was retained
+        glyph_cache_set_raster_mode(new_cache, quality_governor_raster_mode());
+    } else {
+        new_font = font_open(config->font_path, new_font_size);
+        if (!new_font) {
+            ERROR_LOG("Failed to change font size to %d: %s", new_font_size, TTF_GetError());
+            return false;
+        }
     }
 
     int new_char_w, new_char_h;
     if (TTF_SizeUTF8(new_font, "W", &new_char_w, &new_char_h) != 0 || new_char_w <= 0 || new_char_h <= 0) {
         ERROR_LOG("New font size %d has invalid character dimensions", new_font_size);
-        TTF_CloseFont(new_font);
+        FontZoomSlot rejected = { new_font_size, new_font, new_cache, 0 };
+        zoom_slot_release(&rejected);
         return false;
     }
+    if (!new_cache && term->glyph_cache) {
+        new_cache = zoom_create_glyph_cache(config, new_font_size);
+        if (!new_cache) {
+            TTF_CloseFont(new_font);
+            return false;
+        }
+    }
 
-    TTF_CloseFont(*font);
+    // Keep the outgoing size for zooming back
+    zoom_retain(config->font_size, *font, term->glyph_cache);
     *font = new_font;
+    term->glyph_cache = new_cache;
+    s_prewarm_size = new_font_size + delta;
     config->font_size = new_font_size;
     *char_w = new_char_w;
     *char_h = new_char_h;
@@ -47,11 +259,9 @@ bool font_change_size(TTF_Font** font, Config* config, Terminal* term, OnScreenK
     int new_cols = config->win_w / *char_w;
     int new_rows = config->win_h / *char_h;
     terminal_resize(term, new_cols, new_rows);
+    // Same grid size still means every cell moved to a new pixel size
+    term->full_redraw_needed = true;
 
-    if (term->glyph_cache) {
-        glyph_cache_cleanup(term->glyph_cache);
-        glyph_cache_init(term->glyph_cache, GLYPH_CACHE_SIZE);
-    }
     osk_key_cache_destroy(osk->key_cache);
     osk->key_cache = osk_key_cache_create();
     osk_invalidate_render_cache(osk);
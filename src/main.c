@@ -23,10 +23,18 @@
 
 #include "terminal_state.h"
 #include "app_lifecycle.h"
+#include "font_manager.h"
 #include "config_manager.h"
+#include "terminal.h"
+#include "session_snapshot.h"
+#include "session_record.h"
+#include "trace.h"
+#include "input_latency.h"
+#include "resource_bundle.h"
 #include "error_codes.h"
 
 #include <errno.h>
+#include <sys/wait.h>
 
 /**
  * @brief Sets up the PTY and returns the master file descriptor and child PID.
@@ -88,52 +96,85 @@ int main(int argc, char* argv[])
     if (!config_validate(&config)) {
         ERROR_LOG("Configuration validation failed, using corrected values");
     }
+
+    if (config.trace_path) {
+        trace_start(config.trace_path);
+    }
     
-    // Initialize SDL and create window/renderer
     SDL_Window* win = NULL;
     SDL_Renderer* renderer = NULL;
     TTF_Font* font = NULL;
     int char_w, char_h;
-    
-    if (!app_init_sdl(&win, &renderer, &font, &config, &char_w, &char_h)) {
-        ERROR_LOG("Failed to initialize SDL");
-        config_cleanup(&config);
-        return 1;
-    }
-    
-    // Set up PTY
+
+    // Set up PTY first, unless a recording stands in for the shell. The
+    // shell starts while SDL and the font load; the cell size is not known
+    // yet, so the size is estimated and corrected once the terminal exists.
     int master_fd = -1;
     pid_t pid = -1;
-    
-    if (!setup_pty(&config, char_w, char_h, &master_fd, &pid)) {
-        ERROR_LOG("Failed to set up PTY");
-        app_cleanup_resources(&config, NULL, NULL, renderer, win, font, pid, master_fd);
+    int replay_cols = 0, replay_rows = 0;
+
+    if (config.replay_path) {
+        if (!session_replay_open(config.replay_path, &replay_cols, &replay_rows)) {
+            config_cleanup(&config);
+            return 1;
+        }
+        // Nothing to type into, and the live session must not be touched
+        config.read_only = true;
+        config.no_credit = true;
+        free(config.session_path);
+        config.session_path = NULL;
+    } else {
+        int est_w = config.font_size * 3 / 5;
+        int est_h = config.font_size * 5 / 4;
+        if (!setup_pty(&config, est_w > 0 ? est_w : 1, est_h > 0 ? est_h : 1, &master_fd, &pid)) {
+            ERROR_LOG("Failed to set up PTY");
+            app_cleanup_resources(&config, NULL, NULL, NULL, NULL, NULL, pid, master_fd);
+            return 1;
+        }
+    }
+
+    // Buffer the shell's early output and parse OSK files in the background
+    OnScreenKeyboard osk;
+    AppStartup* startup = app_startup_begin(master_fd, &osk, &config);
+
+    // Initialize SDL and create window/renderer
+    if (!app_init_sdl(&win, &renderer, &font, &config, &char_w, &char_h)) {
+        ERROR_LOG("Failed to initialize SDL");
+        app_startup_finish(startup, NULL);
+        app_cleanup_resources(&config, NULL, NULL, NULL, NULL, NULL, pid, master_fd);
         return 1;
     }
-    
+
     // Initialize OSK
-    OnScreenKeyboard osk;
-    if (!app_init_osk(&osk, &config)) {
+    if (!app_startup_finish_osk(startup, &osk, &config)) {
         ERROR_LOG("Failed to initialize OSK");
+        app_startup_finish(startup, NULL);
         app_cleanup_resources(&config, NULL, &osk, renderer, win, font, pid, master_fd);
         return 1;
     }
     
+    // A pending snapshot means we are resuming: go straight to the terminal
+    if (config.session_path && access(config.session_path, R_OK) == 0) {
+        config.no_credit = true;
+    }
+
     // Run credit screen if enabled
     if (!app_run_credit_screen(win, renderer, font, &config, pid, NULL, &osk, master_fd)) {
         // User quit during credit screen
+        app_startup_finish(startup, NULL);
         app_cleanup_resources(&config, NULL, &osk, renderer, win, font, pid, master_fd);
         return 0;
     }
     
     // Recheck window size in case user resized during credit screen
     SDL_GetWindowSize(win, &config.win_w, &config.win_h);
-    TTF_SizeText(font, "W", &char_w, &char_h);
+    font_cell_size(font, &char_w, &char_h);
     
     // Initialize terminal
     Terminal* term = app_init_terminal(&config, renderer, char_w, char_h);
     if (!term) {
         ERROR_LOG("Failed to initialize terminal");
+        app_startup_finish(startup, NULL);
         app_cleanup_resources(&config, term, &osk, renderer, win, font, pid, master_fd);
         return 1;
     }
@@ -146,16 +187,48 @@ int main(int argc, char* argv[])
         .ws_xpixel = (unsigned short)config.win_w,
         .ws_ypixel = (unsigned short)config.win_h
     };
-    if (ioctl(master_fd, TIOCSWINSZ, &ws) == -1) {
+    if (master_fd >= 0 && ioctl(master_fd, TIOCSWINSZ, &ws) == -1) {
         WARN_LOG("Failed to update PTY window size: %s", strerror(errno));
     }
+
+    if (session_replay_active() && replay_cols > 0 && replay_rows > 0) {
+        terminal_resize(term, replay_cols, replay_rows);
+    }
+    if (config.record_path) {
+        session_record_start(config.record_path, term->cols, term->rows);
+    }
+
+    if (config.session_path) {
+        session_snapshot_restore(config.session_path, term, &osk);
+    }
+
+    // Replay what the shell printed while we were starting up
+    app_startup_finish(startup, term);
+
+    // Persist anything parsed from text this run so the next start maps it
+    resource_bundle_commit();
     
     // Start text input
     SDL_StartTextInput();
     
     // Run main application loop
     app_main_loop(renderer, term, &font, &config, &char_w, &char_h, master_fd, &osk, pid);
+
+    // Keep the session only if we are being closed under a live shell;
+    // an exited shell means the user ended the session.
+    if (config.session_path) {
+        if (pid > 0 && waitpid(pid, NULL, WNOHANG) == 0) {
+            session_snapshot_save(config.session_path, term, &osk);
+        } else {
+            session_snapshot_discard(config.session_path);
+        }
+    }
     
+    session_record_stop();
+    session_replay_close();
+    trace_stop();
+    input_latency_dump();
+
     // Cleanup and exit
     app_cleanup_resources(&config, term, &osk, renderer, win, font, pid, master_fd);
     return 0;
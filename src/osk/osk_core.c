@@ -11,6 +11,7 @@
 
 #include "osk_core.h"
 #include "osk_parser.h"
+#include "resource_bundle.h"
 #include "error_codes.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -145,6 +146,29 @@ const SpecialKeySet* get_active_special_set(const OnScreenKeyboard* osk)
     return active_set;
 }
 
+/**
+ * Moves parsed rows into the OSK and frees the per-modifier arrays.
+ */
+static void osk_install_parsed_layout(OnScreenKeyboard* osk, SpecialKeySet** sets_by_modifier, int* num_rows)
+{
+    // Flatten layouts into OSK structure
+    osk_flatten_layouts(osk, sets_by_modifier, num_rows);
+
+    // Rows of the unshifted and shifted buckets now belong to the OSK; the
+    // other buckets are not displayed
+    for (int m = 0; m < OSK_NUM_MODIFIERS; m++) {
+        if (m != 0 && m != OSK_MOD_SHIFT && sets_by_modifier[m]) {
+            for (int r = 0; r < num_rows[m]; r++) {
+                free_special_key_set_contents(&sets_by_modifier[m][r]);
+            }
+        }
+        free(sets_by_modifier[m]);
+    }
+
+    // Validate current row index
+    osk_validate_row_index(osk);
+}
+
 void osk_load_layout(OnScreenKeyboard* osk, const char* path)
 {
     if (!osk || !path) {
@@ -166,6 +190,16 @@ void osk_load_layout(OnScreenKeyboard* osk, const char* path)
         osk->num_shifted_rows = 0;
     }
 
+    SpecialKeySet* temp_key_sets_by_modifier[OSK_NUM_MODIFIERS] = {NULL};
+    int temp_num_rows[OSK_NUM_MODIFIERS] = {0};
+    int temp_capacity[OSK_NUM_MODIFIERS] = {0};
+
+    if (resource_bundle_load_layout(path, temp_key_sets_by_modifier, temp_num_rows)) {
+        osk_install_parsed_layout(osk, temp_key_sets_by_modifier, temp_num_rows);
+        INFO_LOG("Loaded layout from resource bundle: %s", path);
+        return;
+    }
+
     // Load new layout
     FILE* file = fopen(path, "r");
     if (!file) {
@@ -190,10 +224,6 @@ void osk_load_layout(OnScreenKeyboard* osk, const char* path)
     fclose(file);
 
     // Parse layout
-    SpecialKeySet* temp_key_sets_by_modifier[OSK_NUM_MODIFIERS] = {NULL};
-    int temp_num_rows[OSK_NUM_MODIFIERS] = {0};
-    int temp_capacity[OSK_NUM_MODIFIERS] = {0};
-
     if (!parse_layout_content(content, temp_key_sets_by_modifier, temp_num_rows, temp_capacity)) {
         ERROR_LOG("Failed to parse layout content");
         free(content);
@@ -202,11 +232,8 @@ void osk_load_layout(OnScreenKeyboard* osk, const char* path)
 
     free(content);
 
-    // Flatten layouts into OSK structure
-    osk_flatten_layouts(osk, temp_key_sets_by_modifier, temp_num_rows);
-
-    // Validate current row index
-    osk_validate_row_index(osk);
+    resource_bundle_store_layout(path, temp_key_sets_by_modifier, temp_num_rows);
+    osk_install_parsed_layout(osk, temp_key_sets_by_modifier, temp_num_rows);
 
     INFO_LOG("Successfully loaded layout: %s", path);
 }
@@ -11,6 +11,7 @@
 
 #include "osk_parser.h"
 #include "keyboard_handler.h"
+#include "resource_bundle.h"
 #include "error_codes.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -214,7 +215,7 @@ void free_special_key_set_contents(SpecialKeySet* set)
     }
 
     if (set->keys) {
-        for (int i = 0; i < set->num_keys; i++) {
+        for (int i = 0; i < set->num_keys && !set->borrowed_strings; i++) {
             if (set->keys[i].display_name) {
                 free(set->keys[i].display_name);
             }
@@ -234,6 +235,7 @@ void free_special_key_set_contents(SpecialKeySet* set)
         set->file_path = NULL;
     }
     set->num_keys = 0;
+    set->borrowed_strings = false;
 }
 
 void free_char_layout_rows(SpecialKeySet* rows, int num_rows)
@@ -477,6 +479,7 @@ static const CommandNameEntry s_commands[] = {
     {"CMD_TERMINAL_CLEAR", CMD_TERMINAL_CLEAR},
     {"CMD_OSK_TOGGLE_POSITION", CMD_OSK_TOGGLE_POSITION},
     {"CMD_RELOAD_THEME", CMD_RELOAD_THEME},
+    {"CMD_PERF_HUD_TOGGLE", CMD_PERF_HUD_TOGGLE},
 };
 
 static char* find_unescaped_colon(char* str)
@@ -766,6 +769,14 @@ SpecialKeySet osk_parse_key_set_file(const OnScreenKeyboard* osk, const char* pa
         set.name = name;
     }
 
+    if (resource_bundle_load_key_set(path, &set)) {
+        set.is_dynamic = true;
+        set.file_path = strdup(path);
+        set.active_mod_mask = OSK_MOD_NONE;
+        DEBUG_LOG("Loaded key set '%s' with %d keys from resource bundle", set.name, set.num_keys);
+        return set;
+    }
+
     FILE* file = fopen(path, "r");
     if (!file) {
         ERROR_LOG("Failed to open key set file: %s", path);
@@ -809,6 +820,8 @@ SpecialKeySet osk_parse_key_set_file(const OnScreenKeyboard* osk, const char* pa
         return set;
     }
 
+    resource_bundle_store_key_set(path, &set);
+
     set.is_dynamic = true;
     set.file_path = strdup(path);
     set.active_mod_mask = OSK_MOD_NONE;
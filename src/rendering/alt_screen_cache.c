@@ -0,0 +1,265 @@
+/**
+ * @file alt_screen_cache.c
+ * @brief Saved primary screen frame for alternate screen round trips.
+ *
+ * The cells of the primary screen are copied when the alternate screen
+ * comes up, together with the rows that were still waiting to be drawn.
+ * The frame is copied at the next render, before any alternate screen row
+ * reaches the screen texture: into a target texture on the GPU path, or
+ * out of the frame buffer on the software path. When the primary screen
+ * returns, damaged rows are compared against the saved cells, so only rows
+ * that really changed are drawn after the frame is copied back.
+ *
+ * @author VaixTerm Team
+ * @date 2024
+ */
+
+#include "alt_screen_cache.h"
+#include "dirty_region_tracker.h"
+#include "soft_render.h"
+#include "error_codes.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    ALT_CACHE_IDLE,
+    ALT_CACHE_ENTERED,      // Cells kept, frame not copied yet
+    ALT_CACHE_SAVED,        // Frame copied, alternate screen being drawn
+    ALT_CACHE_RESTORING     // Primary screen is back, frame goes back at the next render
+} AltCacheState;
+
+struct AltScreenCache {
+    AltCacheState state;
+    bool saved;             // The alternate screen was drawn, so the frame must be copied back
+    Glyph* cells;
+    bool* stale;            // Rows the saved frame shows older than cells
+    int rows, cols;
+    SDL_Texture* texture;   // GPU path
+    int w, h;
+    uint32_t* pixels;       // Software path
+    size_t pixel_count;
+};
+
+AltScreenCache* alt_screen_cache_create(void)
+{
+    AltScreenCache* cache = calloc(1, sizeof(AltScreenCache));
+    if (!cache) {
+        ERROR_LOG("Failed to allocate alternate screen cache");
+    }
+    return cache;
+}
+
+static void release_frame(AltScreenCache* cache)
+{
+    if (cache->texture) {
+        SDL_DestroyTexture(cache->texture);
+        cache->texture = NULL;
+    }
+    free(cache->pixels);
+    cache->pixels = NULL;
+    cache->pixel_count = 0;
+}
+
+void alt_screen_cache_destroy(AltScreenCache* cache)
+{
+    if (!cache) {
+        return;
+    }
+    release_frame(cache);
+    free(cache->cells);
+    free(cache->stale);
+    free(cache);
+}
+
+void alt_screen_cache_drop(AltScreenCache* cache)
+{
+    if (!cache) {
+        return;
+    }
+    // Lost textures cannot be drawn from or copied into again
+    release_frame(cache);
+    cache->state = ALT_CACHE_IDLE;
+}
+
+bool alt_screen_cache_enter(AltScreenCache* cache, Terminal* term, const Glyph* grid)
+{
+    cache->state = ALT_CACHE_IDLE;
+    // The screen texture must show the live primary screen, all but the dirty rows
+    if (!grid || !term->screen_texture || term->full_redraw_needed || term->view_offset != 0) {
+        return false;
+    }
+    if (cache->rows != term->rows || cache->cols != term->cols) {
+        size_t count = (size_t)term->rows * (size_t)term->cols;
+        Glyph* cells = realloc(cache->cells, sizeof(Glyph) * count);
+        if (!cells) {
+            return false;
+        }
+        cache->cells = cells;
+        bool* stale = realloc(cache->stale, sizeof(bool) * (size_t)term->rows);
+        if (!stale) {
+            return false;
+        }
+        cache->stale = stale;
+        cache->rows = term->rows;
+        cache->cols = term->cols;
+    }
+    memcpy(cache->cells, grid, sizeof(Glyph) * (size_t)cache->rows * (size_t)cache->cols);
+    for (int y = 0; y < cache->rows; y++) {
+        cache->stale[y] = term->has_dirty_regions && term->dirty_lines[y];
+    }
+    cache->saved = false;
+    cache->state = ALT_CACHE_ENTERED;
+    return true;
+}
+
+bool alt_screen_cache_leave(AltScreenCache* cache, Terminal* term)
+{
+    if (!cache || (cache->state != ALT_CACHE_ENTERED && cache->state != ALT_CACHE_SAVED) ||
+        cache->rows != term->rows || cache->cols != term->cols || term->view_offset != 0) {
+        if (cache) {
+            cache->state = ALT_CACHE_IDLE;
+        }
+        return false;
+    }
+    // Without a render in between the screen texture still shows the primary screen
+    cache->saved = cache->state == ALT_CACHE_SAVED;
+    cache->state = ALT_CACHE_RESTORING;
+
+    // Rows damaged on the alternate screen are not drawn; the frame replaces them
+    terminal_clear_dirty_lines(term);
+    for (int y = 0; y < cache->rows; y++) {
+        if (cache->stale[y]) {
+            terminal_mark_lines_dirty(term, y, y);
+        }
+    }
+    return true;
+}
+
+bool alt_screen_cache_restoring(const AltScreenCache* cache)
+{
+    return cache && cache->state == ALT_CACHE_RESTORING;
+}
+
+bool alt_screen_cache_row_changed(const AltScreenCache* cache, int y, const Glyph* line, int cols)
+{
+    if (y < 0 || y >= cache->rows || cols != cache->cols) {
+        return true;
+    }
+    if (cache->stale[y]) {
+        return true;
+    }
+    // Field by field: the padding of Glyph is not guaranteed to match
+    const Glyph* saved = cache->cells + (size_t)y * (size_t)cache->cols;
+    for (int x = 0; x < cache->cols; x++) {
+        const Glyph* a = &saved[x];
+        const Glyph* b = &line[x];
+        if (a->character != b->character || a->attributes != b->attributes || a->width != b->width ||
+            a->fg.r != b->fg.r || a->fg.g != b->fg.g || a->fg.b != b->fg.b || a->fg.a != b->fg.a ||
+            a->bg.r != b->bg.r || a->bg.g != b->bg.g || a->bg.b != b->bg.b || a->bg.a != b->bg.a) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool save_frame(AltScreenCache* cache, SDL_Renderer* renderer, SDL_Texture* screen)
+{
+    if (soft_render_active(screen)) {
+        size_t count = soft_render_frame_pixels();
+        if (count == 0) {
+            return false;
+        }
+        if (count != cache->pixel_count) {
+            uint32_t* pixels = realloc(cache->pixels, sizeof(uint32_t) * count);
+            if (!pixels) {
+                return false;
+            }
+            cache->pixels = pixels;
+            cache->pixel_count = count;
+        }
+        soft_render_save(cache->pixels);
+        return true;
+    }
+
+    Uint32 format = SDL_PIXELFORMAT_RGBA8888;
+    int w = 0, h = 0;
+    if (SDL_QueryTexture(screen, &format, NULL, &w, &h) != 0) {
+        return false;
+    }
+    if (cache->texture && (cache->w != w || cache->h != h)) {
+        SDL_DestroyTexture(cache->texture);
+        cache->texture = NULL;
+    }
+    if (!cache->texture) {
+        cache->texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!cache->texture) {
+            WARN_LOG("Failed to create %dx%d alternate screen texture: %s", w, h, SDL_GetError());
+            return false;
+        }
+        SDL_SetTextureBlendMode(cache->texture, SDL_BLENDMODE_NONE);
+        cache->w = w;
+        cache->h = h;
+    }
+
+    SDL_BlendMode mode;
+    SDL_GetTextureBlendMode(screen, &mode);
+    SDL_SetTextureBlendMode(screen, SDL_BLENDMODE_NONE);
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, cache->texture);
+    SDL_RenderCopy(renderer, screen, NULL, NULL);
+    SDL_SetRenderTarget(renderer, target);
+    SDL_SetTextureBlendMode(screen, mode);
+    return true;
+}
+
+static bool restore_frame(AltScreenCache* cache, SDL_Renderer* renderer, SDL_Texture* screen)
+{
+    if (soft_render_active(screen)) {
+        if (!cache->pixels || cache->pixel_count != soft_render_frame_pixels()) {
+            return false;
+        }
+        soft_render_restore(cache->pixels);
+        return true;
+    }
+    int w = 0, h = 0;
+    if (!cache->texture || SDL_QueryTexture(screen, NULL, NULL, &w, &h) != 0 ||
+        w != cache->w || h != cache->h) {
+        return false;
+    }
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, screen);
+    SDL_RenderCopy(renderer, cache->texture, NULL, NULL);
+    SDL_SetRenderTarget(renderer, target);
+    return true;
+}
+
+bool alt_screen_cache_render(AltScreenCache* cache, SDL_Renderer* renderer, Terminal* term,
+                             bool full_repaint)
+{
+    if (!cache || cache->state == ALT_CACHE_IDLE) {
+        return false;
+    }
+    if (full_repaint) {
+        cache->state = ALT_CACHE_IDLE;
+        return false;
+    }
+    switch (cache->state) {
+    case ALT_CACHE_ENTERED:
+        // Leaving will repaint in full instead
+        cache->state = save_frame(cache, renderer, term->screen_texture) ? ALT_CACHE_SAVED : ALT_CACHE_IDLE;
+        return false;
+    case ALT_CACHE_RESTORING:
+        cache->state = ALT_CACHE_IDLE;
+        if (!cache->saved) {
+            return false;
+        }
+        if (!restore_frame(cache, renderer, term->screen_texture)) {
+            term->full_redraw_needed = true;
+            return false;
+        }
+        DEBUG_LOG("Primary screen restored from the alternate screen cache");
+        return true;
+    default:
+        return false;
+    }
+}
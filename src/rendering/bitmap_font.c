@@ -0,0 +1,369 @@
+/**
+ * @file bitmap_font.c
+ * @brief PSF1, PSF2 and BDF font loading.
+ *
+ * All three formats are normalized to cell-sized 1bpp bitmaps plus a
+ * sorted codepoint to glyph table.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitmap_font.h"
+#include "error_codes.h"
+
+#define BITMAP_FONT_MAX_FILE (16u * 1024u * 1024u)
+#define BITMAP_FONT_MAX_CELL 64
+#define BITMAP_FONT_MAX_GLYPHS 65536
+
+#define PSF1_MAGIC0 0x36
+#define PSF1_MAGIC1 0x04
+#define PSF1_MODE512 0x01
+#define PSF1_MODEHASTAB 0x06
+#define PSF1_SEPARATOR 0xFFFF
+#define PSF1_STARTSEQ 0xFFFE
+
+#define PSF2_MAGIC 0x864ab572u
+#define PSF2_HAS_UNICODE_TABLE 0x01
+#define PSF2_SEPARATOR 0xFF
+#define PSF2_STARTSEQ 0xFE
+
+static uint8_t* read_file(const char* path, size_t* len)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    uint8_t* data = NULL;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long size = ftell(f);
+        if (size > 0 && (unsigned long)size <= BITMAP_FONT_MAX_FILE && fseek(f, 0, SEEK_SET) == 0) {
+            data = malloc((size_t)size + 1);
+            if (data && fread(data, 1, (size_t)size, f) == (size_t)size) {
+                data[size] = '\0';
+                *len = (size_t)size;
+            } else {
+                free(data);
+                data = NULL;
+            }
+        }
+    }
+    fclose(f);
+    return data;
+}
+
+static uint32_t rd32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool font_alloc(BitmapFont* font, int width, int height, uint32_t num_glyphs)
+{
+    if (width <= 0 || height <= 0 || width > BITMAP_FONT_MAX_CELL || height > BITMAP_FONT_MAX_CELL ||
+        num_glyphs == 0 || num_glyphs > BITMAP_FONT_MAX_GLYPHS) {
+        return false;
+    }
+    font->width = width;
+    font->height = height;
+    font->stride = (size_t)(width + 7) / 8;
+    font->num_glyphs = num_glyphs;
+    font->bitmaps = calloc(num_glyphs, (size_t)height * font->stride);
+    return font->bitmaps != NULL;
+}
+
+static bool map_add(BitmapFont* font, uint32_t* capacity, uint32_t codepoint, uint32_t glyph)
+{
+    if (font->map_len == *capacity) {
+        uint32_t new_capacity = *capacity ? *capacity * 2 : 256;
+        BitmapFontMapping* map = realloc(font->map, new_capacity * sizeof(*map));
+        if (!map) {
+            return false;
+        }
+        font->map = map;
+        *capacity = new_capacity;
+    }
+    font->map[font->map_len++] = (BitmapFontMapping){ codepoint, glyph };
+    return true;
+}
+
+// Without a unicode table glyph N is codepoint N
+static bool map_identity(BitmapFont* font, uint32_t* capacity)
+{
+    for (uint32_t g = 0; g < font->num_glyphs; g++) {
+        if (!map_add(font, capacity, g, g)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t utf8_decode(const uint8_t* p, size_t avail, uint32_t* out)
+{
+    uint8_t b = p[0];
+    size_t n = b < 0x80 ? 1 : (b & 0xE0) == 0xC0 ? 2 : (b & 0xF0) == 0xE0 ? 3 : (b & 0xF8) == 0xF0 ? 4 : 0;
+    if (n == 0 || n > avail) {
+        return 0;
+    }
+    uint32_t c = n == 1 ? b : (uint32_t)(b & (0x7F >> n));
+    for (size_t i = 1; i < n; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        c = (c << 6) | (p[i] & 0x3F);
+    }
+    *out = c;
+    return n;
+}
+
+static bool load_psf1(BitmapFont* font, const uint8_t* data, size_t len)
+{
+    if (len < 4) {
+        return false;
+    }
+    uint8_t mode = data[2];
+    int height = data[3];
+    uint32_t count = (mode & PSF1_MODE512) ? 512 : 256;
+    size_t glyph_bytes = (size_t)count * height;
+    if (4 + glyph_bytes > len || !font_alloc(font, 8, height, count)) {
+        return false;
+    }
+    memcpy(font->bitmaps, data + 4, glyph_bytes);
+
+    uint32_t capacity = 0;
+    if (!(mode & PSF1_MODEHASTAB)) {
+        return map_identity(font, &capacity);
+    }
+    size_t p = 4 + glyph_bytes;
+    for (uint32_t g = 0; g < count && p + 2 <= len; g++) {
+        bool in_sequence = false;
+        while (p + 2 <= len) {
+            uint32_t u = (uint32_t)data[p] | ((uint32_t)data[p + 1] << 8);
+            p += 2;
+            if (u == PSF1_SEPARATOR) break;
+            if (u == PSF1_STARTSEQ) in_sequence = true;
+            if (!in_sequence && !map_add(font, &capacity, u, g)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool load_psf2(BitmapFont* font, const uint8_t* data, size_t len)
+{
+    if (len < 32) {
+        return false;
+    }
+    uint32_t header_size = rd32(data + 8);
+    uint32_t flags = rd32(data + 12);
+    uint32_t count = rd32(data + 16);
+    uint32_t char_size = rd32(data + 20);
+    uint32_t height = rd32(data + 24);
+    uint32_t width = rd32(data + 28);
+    if (header_size < 32 || width > BITMAP_FONT_MAX_CELL || height > BITMAP_FONT_MAX_CELL ||
+        char_size != height * ((width + 7) / 8) || count > BITMAP_FONT_MAX_GLYPHS ||
+        header_size + (uint64_t)count * char_size > len ||
+        !font_alloc(font, (int)width, (int)height, count)) {
+        return false;
+    }
+    memcpy(font->bitmaps, data + header_size, (size_t)count * char_size);
+
+    uint32_t capacity = 0;
+    if (!(flags & PSF2_HAS_UNICODE_TABLE)) {
+        return map_identity(font, &capacity);
+    }
+    // Each glyph lists its codepoints in UTF-8, then optional combining
+    // sequences after 0xFE, terminated by 0xFF. Sequences are skipped.
+    size_t p = header_size + (size_t)count * char_size;
+    for (uint32_t g = 0; g < count && p < len; g++) {
+        bool in_sequence = false;
+        while (p < len) {
+            if (data[p] == PSF2_SEPARATOR) {
+                p++;
+                break;
+            }
+            if (data[p] == PSF2_STARTSEQ) {
+                in_sequence = true;
+                p++;
+                continue;
+            }
+            uint32_t c;
+            size_t n = utf8_decode(data + p, len - p, &c);
+            if (n == 0) {
+                p++;
+                continue;
+            }
+            p += n;
+            if (!in_sequence && !map_add(font, &capacity, c, g)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Copies the next line into @p line and advances @p p past it
+static bool next_line(const char** p, char* line, size_t size)
+{
+    if (!**p) {
+        return false;
+    }
+    const char* end = strchr(*p, '\n');
+    size_t n = end ? (size_t)(end - *p) : strlen(*p);
+    size_t copy = n < size - 1 ? n : size - 1;
+    memcpy(line, *p, copy);
+    line[copy] = '\0';
+    if (copy > 0 && line[copy - 1] == '\r') {
+        line[copy - 1] = '\0';
+    }
+    *p += n + (end ? 1 : 0);
+    return true;
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * Glyphs are placed in the cell from their BBX relative to the font
+ * bounding box and baseline, clipping anything outside the cell.
+ */
+static bool load_bdf(BitmapFont* font, const char* text)
+{
+    char line[512];
+    const char* p = text;
+    int fbb_w = 0, fbb_h = 0, fbb_x = 0, fbb_y = 0;
+    int ascent = -1, descent = -1;
+    uint32_t declared = 0;
+
+    while (next_line(&p, line, sizeof(line))) {
+        if (sscanf(line, "FONTBOUNDINGBOX %d %d %d %d", &fbb_w, &fbb_h, &fbb_x, &fbb_y) == 4) continue;
+        if (sscanf(line, "FONT_ASCENT %d", &ascent) == 1) continue;
+        if (sscanf(line, "FONT_DESCENT %d", &descent) == 1) continue;
+        if (sscanf(line, "CHARS %u", &declared) == 1) break;
+    }
+    int height = (ascent >= 0 && descent >= 0) ? ascent + descent : fbb_h;
+    int baseline = ascent >= 0 ? ascent : fbb_h + fbb_y;
+    if (!font_alloc(font, fbb_w, height, declared)) {
+        return false;
+    }
+
+    uint32_t capacity = 0;
+    uint32_t g = 0;
+    long encoding = -1;
+    int bbx_w = 0, bbx_h = 0, bbx_x = 0, bbx_y = 0;
+    while (g < font->num_glyphs && next_line(&p, line, sizeof(line))) {
+        if (strncmp(line, "STARTCHAR", 9) == 0) {
+            encoding = -1;
+            bbx_w = bbx_h = bbx_x = bbx_y = 0;
+        } else if (sscanf(line, "ENCODING %ld", &encoding) == 1) {
+            continue;
+        } else if (sscanf(line, "BBX %d %d %d %d", &bbx_w, &bbx_h, &bbx_x, &bbx_y) == 4) {
+            continue;
+        } else if (strcmp(line, "BITMAP") == 0) {
+            uint8_t* cell = font->bitmaps + (size_t)g * font->height * font->stride;
+            int col0 = bbx_x - fbb_x;
+            int row0 = baseline - (bbx_y + bbx_h);
+            for (int r = 0; r < bbx_h && next_line(&p, line, sizeof(line)); r++) {
+                int y = row0 + r;
+                if (y < 0 || y >= font->height) continue;
+                for (int px = 0; px < bbx_w; px++) {
+                    int digit = hex_digit(line[px / 4]);
+                    if (digit < 0) break;
+                    int x = col0 + px;
+                    if (x >= 0 && x < font->width && (digit & (8 >> (px % 4)))) {
+                        cell[(size_t)y * font->stride + (size_t)x / 8] |= (uint8_t)(0x80 >> (x % 8));
+                    }
+                }
+            }
+        } else if (strcmp(line, "ENDCHAR") == 0) {
+            if (encoding >= 0) {
+                if (!map_add(font, &capacity, (uint32_t)encoding, g)) {
+                    return false;
+                }
+                g++;
+            } else {
+                // Unencoded glyph: reuse its cell
+                memset(font->bitmaps + (size_t)g * font->height * font->stride, 0,
+                       (size_t)font->height * font->stride);
+            }
+        }
+    }
+    font->num_glyphs = g;
+    return g > 0;
+}
+
+static int compare_mapping(const void* a, const void* b)
+{
+    uint32_t ca = ((const BitmapFontMapping*)a)->codepoint;
+    uint32_t cb = ((const BitmapFontMapping*)b)->codepoint;
+    return (ca > cb) - (ca < cb);
+}
+
+BitmapFont* bitmap_font_open(const char* path)
+{
+    if (!path) {
+        return NULL;
+    }
+    size_t len = 0;
+    uint8_t* data = read_file(path, &len);
+    if (!data) {
+        ERROR_LOG("Failed to read bitmap font %s", path);
+        return NULL;
+    }
+
+    BitmapFont* font = calloc(1, sizeof(BitmapFont));
+    bool ok = false;
+    const char* format = "unknown";
+    if (font) {
+        if (len >= 4 && rd32(data) == PSF2_MAGIC) {
+            format = "PSF2";
+            ok = load_psf2(font, data, len);
+        } else if (len >= 2 && data[0] == PSF1_MAGIC0 && data[1] == PSF1_MAGIC1) {
+            format = "PSF1";
+            ok = load_psf1(font, data, len);
+        } else if (strncmp((const char*)data, "STARTFONT", 9) == 0) {
+            format = "BDF";
+            ok = load_bdf(font, (const char*)data);
+        }
+    }
+    free(data);
+
+    if (!ok || !font || font->map_len == 0) {
+        ERROR_LOG("Failed to load bitmap font %s (format: %s)", path, format);
+        bitmap_font_close(font);
+        return NULL;
+    }
+    qsort(font->map, font->map_len, sizeof(*font->map), compare_mapping);
+    INFO_LOG("Loaded %s bitmap font %s: %dx%d, %u glyphs, %u codepoints",
+             format, path, font->width, font->height, font->num_glyphs, font->map_len);
+    return font;
+}
+
+void bitmap_font_close(BitmapFont* font)
+{
+    if (!font) {
+        return;
+    }
+    free(font->bitmaps);
+    free(font->map);
+    free(font);
+}
+
+const uint8_t* bitmap_font_glyph(const BitmapFont* font, uint32_t c)
+{
+    if (!font) {
+        return NULL;
+    }
+    BitmapFontMapping key = { c, 0 };
+    const BitmapFontMapping* m = bsearch(&key, font->map, font->map_len, sizeof(*font->map), compare_mapping);
+    if (!m || m->glyph >= font->num_glyphs) {
+        return NULL;
+    }
+    return font->bitmaps + (size_t)m->glyph * font->height * font->stride;
+}
@@ -180,6 +180,19 @@ SDL_Color rgb_to_color(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
     return color;
 }
 
+// Rounds to the nearest color RGB565 holds exactly, so a 16-bit target
+// stores theme colors unchanged instead of truncating them.
+SDL_Color color_quantize_565(SDL_Color color)
+{
+    int r5 = (color.r * 31 + 127) / 255;
+    int g6 = (color.g * 63 + 127) / 255;
+    int b5 = (color.b * 31 + 127) / 255;
+    color.r = (uint8_t)((r5 << 3) | (r5 >> 2));
+    color.g = (uint8_t)((g6 << 2) | (g6 >> 4));
+    color.b = (uint8_t)((b5 << 3) | (b5 >> 2));
+    return color;
+}
+
 bool hex_to_rgb(const char* hex_str, uint8_t* r, uint8_t* g, uint8_t* b, uint8_t* a)
 {
     if (!hex_str || !r || !g || !b || !a) {
@@ -0,0 +1,235 @@
+/**
+ * @file font_fallback.c
+ * @brief Font fallback chain and per-codepoint coverage bitmaps.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <SDL.h>
+
+#include "font_fallback.h"
+#include "cache_file.h"
+#include "error_codes.h"
+
+#define COVERAGE_MAGIC "VXCV"
+#define COVERAGE_VERSION 1
+#define COVERAGE_BYTES (FONT_COVERAGE_LIMIT / 8)
+#define COVERAGE_PROBE_SIZE 12  // Point size fonts are opened at to read their cmap
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t id;
+    uint32_t bytes;
+    uint32_t reserved;
+} CoverageHeader;
+
+typedef enum {
+    COVERAGE_PENDING,   // Not built yet; only seen inside font_fallback_init
+    COVERAGE_READY,
+    COVERAGE_FAILED     // Font could not be opened; never resolves
+} CoverageState;
+
+typedef struct {
+    char* path;
+    uint8_t* bits;      // COVERAGE_BYTES, bit set = codepoint provided
+    CoverageState state;
+} FontCoverage;
+
+static struct {
+    FontCoverage fonts[FONT_FALLBACK_MAX + 1];   // [0] is the primary font
+    int count;                                   // Including the primary
+    uint64_t id;
+} s_chain;
+
+static uint64_t fnv1a(uint64_t h, const void* data, size_t len)
+{
+    const uint8_t* p = data;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static uint64_t coverage_id(const char* path, TTF_Font* font)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    int64_t file_size = st.st_size, file_mtime = st.st_mtime;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    h = fnv1a(h, path, strlen(path));
+    h = fnv1a(h, &file_size, sizeof(file_size));
+    h = fnv1a(h, &file_mtime, sizeof(file_mtime));
+    const char* family = TTF_FontFaceFamilyName(font);
+    if (family) h = fnv1a(h, family, strlen(family));
+    return h ? h : 1;
+}
+
+static bool coverage_load(uint64_t id, uint8_t* bits)
+{
+    char name[64], path[4096];
+    snprintf(name, sizeof(name), "coverage-%016llx.vxc", (unsigned long long)id);
+    if (!cache_file_path(name, path, sizeof(path))) {
+        return false;
+    }
+    size_t len = 0;
+    const uint8_t* map = cache_file_map(path, &len);
+    if (!map) {
+        return false;
+    }
+    const CoverageHeader* header = (const CoverageHeader*)map;
+    bool ok = len == sizeof(*header) + COVERAGE_BYTES &&
+              memcmp(header->magic, COVERAGE_MAGIC, 4) == 0 &&
+              header->version == COVERAGE_VERSION &&
+              header->id == id && header->bytes == COVERAGE_BYTES;
+    if (ok) {
+        memcpy(bits, map + sizeof(*header), COVERAGE_BYTES);
+    }
+    cache_file_unmap(map, len);
+    return ok;
+}
+
+static void coverage_save(uint64_t id, const uint8_t* bits)
+{
+    char name[64], path[4096];
+    snprintf(name, sizeof(name), "coverage-%016llx.vxc", (unsigned long long)id);
+    if (!cache_file_path(name, path, sizeof(path))) {
+        return;
+    }
+    uint8_t* data = malloc(sizeof(CoverageHeader) + COVERAGE_BYTES);
+    if (!data) {
+        return;
+    }
+    CoverageHeader* header = (CoverageHeader*)data;
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, COVERAGE_MAGIC, 4);
+    header->version = COVERAGE_VERSION;
+    header->id = id;
+    header->bytes = COVERAGE_BYTES;
+    memcpy(data + sizeof(*header), bits, COVERAGE_BYTES);
+    cache_file_write_atomic(path, data, sizeof(*header) + COVERAGE_BYTES);
+    free(data);
+}
+
+/**
+ * Fills the coverage of @p entry from the cache directory, or by asking
+ * the font about every codepoint below FONT_COVERAGE_LIMIT.
+ */
+static void coverage_build(FontCoverage* entry, TTF_Font* font)
+{
+    bool owned = false;
+    if (!font) {
+        font = TTF_OpenFont(entry->path, COVERAGE_PROBE_SIZE);
+        owned = true;
+    }
+    entry->bits = font ? calloc(1, COVERAGE_BYTES) : NULL;
+    if (!entry->bits) {
+        WARN_LOG("Fallback font %s unavailable: %s", entry->path, TTF_GetError());
+        entry->state = COVERAGE_FAILED;
+        if (owned && font) TTF_CloseFont(font);
+        return;
+    }
+
+    uint64_t id = coverage_id(entry->path, font);
+    if (!id || !coverage_load(id, entry->bits)) {
+        Uint32 start = SDL_GetTicks();
+        for (uint32_t c = 0x20; c < FONT_COVERAGE_LIMIT; c++) {
+            if (c >= 0xD800 && c <= 0xDFFF) {
+                continue;
+            }
+            if (TTF_GlyphIsProvided32(font, c)) {
+                entry->bits[c >> 3] |= (uint8_t)(1u << (c & 7));
+            }
+        }
+        DEBUG_LOG("Computed coverage of %s in %u ms", entry->path, SDL_GetTicks() - start);
+        if (id) {
+            coverage_save(id, entry->bits);
+        }
+    }
+    entry->state = COVERAGE_READY;
+    if (owned) {
+        TTF_CloseFont(font);
+    }
+}
+
+bool font_fallback_init(const char* primary_path, TTF_Font* primary, char* const* paths, int count)
+{
+    font_fallback_cleanup();
+    if (!primary_path || !primary || count <= 0) {
+        return false;
+    }
+    if (count > FONT_FALLBACK_MAX) {
+        WARN_LOG("Only the first %d fallback fonts are used", FONT_FALLBACK_MAX);
+        count = FONT_FALLBACK_MAX;
+    }
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+    s_chain.fonts[0].path = strdup(primary_path);
+    for (int i = 0; i < count; i++) {
+        s_chain.fonts[i + 1].path = strdup(paths[i]);
+        if (paths[i]) h = fnv1a(h, paths[i], strlen(paths[i]) + 1);
+    }
+    s_chain.count = count + 1;
+    s_chain.id = h;
+
+    // Built here, at font load, so resolving on the render path only reads
+    // bitmaps; a missing cache file costs a full cmap probe per font
+    coverage_build(&s_chain.fonts[0], primary);
+    if (s_chain.fonts[0].state != COVERAGE_READY) {
+        font_fallback_cleanup();
+        return false;
+    }
+    for (int i = 1; i < s_chain.count; i++) {
+        coverage_build(&s_chain.fonts[i], NULL);
+    }
+    INFO_LOG("Font fallback chain: %d fonts after %s", count, primary_path);
+    return true;
+}
+
+void font_fallback_add_primary(uint32_t c)
+{
+    FontCoverage* primary = &s_chain.fonts[0];
+    if (primary->state == COVERAGE_READY && c < FONT_COVERAGE_LIMIT) {
+        primary->bits[c >> 3] |= (uint8_t)(1u << (c & 7));
+    }
+}
+
+unsigned font_fallback_resolve(uint32_t c)
+{
+    if (s_chain.count <= 1 || c >= FONT_COVERAGE_LIMIT) {
+        return 0;
+    }
+    for (int i = 0; i < s_chain.count; i++) {
+        const FontCoverage* entry = &s_chain.fonts[i];
+        if (entry->state == COVERAGE_READY && (entry->bits[c >> 3] & (1u << (c & 7)))) {
+            return (unsigned)i;
+        }
+    }
+    return 0;
+}
+
+const char* font_fallback_path(unsigned index)
+{
+    if (index == 0 || (int)index >= s_chain.count || s_chain.fonts[index].state == COVERAGE_FAILED) {
+        return NULL;
+    }
+    return s_chain.fonts[index].path;
+}
+
+uint64_t font_fallback_id(void)
+{
+    return s_chain.count > 1 ? s_chain.id : 0;
+}
+
+void font_fallback_cleanup(void)
+{
+    for (int i = 0; i < FONT_FALLBACK_MAX + 1; i++) {
+        free(s_chain.fonts[i].path);
+        free(s_chain.fonts[i].bits);
+    }
+    memset(&s_chain, 0, sizeof(s_chain));
+}
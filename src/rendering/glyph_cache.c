@@ -3,27 +3,67 @@
  * @brief Glyph caching functionality implementation.
  *
  * This module implements glyph caching for performance optimization using
- * a hash table with quadratic probing and LRU eviction.
+ * a hash table with quadratic probing and LRU eviction. Glyph coverage is
+ * packed into one alpha-mask atlas texture that is tinted per draw, so a
+ * glyph is rasterized once regardless of its color. The atlas is saved to
+ * the cache directory per font file, size and hinting and loaded with one
+ * mapping and one texture upload on the next start. With a bitmap font
+ * the cell bitmaps are expanded into the atlas directly and nothing is
+ * persisted.
  *
  * @author VaixTerm Team
  * @date 2024
  */
 
 #include "glyph_cache.h"
+#include "rendering_core.h"
+#include "bitmap_font.h"
+#include "font_fallback.h"
+#include "glyph_cluster.h"
+#include "cache_file.h"
 #include "error_codes.h"
+#include "trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <SDL.h>
 #include <SDL_ttf.h>
 
-static int last_font_style = -1;
+#define GLYPH_ATLAS_MAGIC "VXGA"
+#define GLYPH_ATLAS_VERSION 2
+#define GLYPH_ATLAS_PAD 1 // Empty texels between glyphs
 
-uint64_t make_glyph_key(uint32_t c, unsigned char attributes, SDL_Color fg)
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t font_id;
+    uint32_t atlas_size;
+    uint32_t used_h;        // Rows of coverage stored after the entries
+    uint32_t num_entries;
+    int32_t pen_x, pen_y, shelf_h;
+} GlyphAtlasHeader;
+
+typedef struct {
+    uint64_t key;
+    uint16_t x, y, w, h;
+} GlyphAtlasEntry;
+
+// Glyphs rasterized up front when no atlas exists for the font yet
+static const struct { uint32_t first, last; } s_hot_ranges[] = {
+    {0x0020, 0x007E},   // ASCII
+    {0x00A0, 0x00FF},   // Latin-1 symbols and letters
+    {0x2010, 0x2027},   // Dashes, quotes, bullets, ellipsis
+    {0x2190, 0x2193},   // Arrows
+    {0x2500, 0x257F},   // Box drawing
+    {0x2580, 0x259F},   // Block elements
+    {0x25A0, 0x25CF},   // Geometric shapes
+};
+
+uint64_t make_glyph_key(uint32_t c, unsigned char attributes, unsigned font_index)
 {
     unsigned char render_attrs = attributes & (ATTR_BOLD | ATTR_ITALIC | ATTR_UNDERLINE);
-    uint32_t color_val = (fg.r << 16) | (fg.g << 8) | fg.b;
-    uint64_t key = ((uint64_t)color_val << 40) | ((uint64_t)render_attrs << 32) | c;
+    uint64_t key = ((uint64_t)font_index << 40) | ((uint64_t)render_attrs << 32) | c;
     return key;
 }
 
@@ -44,74 +84,70 @@ GlyphCacheEntry* glyph_cache_get(GlyphCache* cache, uint64_t key)
     for (int i = 0; i < GLYPH_CACHE_SIZE; ++i) {
         uint32_t probe_index = (index + (uint32_t)((i * i + i) / 2)) & (GLYPH_CACHE_SIZE - 1);
         if (cache->entries[probe_index].key == 0) {
-            return NULL;
+            break;
         }
         if (cache->entries[probe_index].key == key) {
             // Update LRU tracking
             cache->last_access[probe_index] = ++cache->access_counter;
+            cache->hits++;
             return &cache->entries[probe_index];
         }
     }
+    cache->misses++;
     return NULL;
 }
 
-bool glyph_cache_put(GlyphCache* cache, uint64_t key, SDL_Texture* texture, int w, int h)
+GlyphCacheEntry* glyph_cache_put(GlyphCache* cache, uint64_t key, const SDL_Rect* src)
 {
-    if (!cache || !texture || w <= 0 || h <= 0) return false;
+    if (!cache || !src || src->w <= 0 || src->h <= 0) return NULL;
 
     uint32_t index = hash_key(key);
     // Quadratic probing with LRU eviction
     uint32_t oldest_index = 0;
     uint32_t oldest_access = UINT32_MAX;
-    
+    GlyphCacheEntry* slot = NULL;
+
     for (int i = 0; i < GLYPH_CACHE_SIZE; ++i) {
         uint32_t probe_index = (index + (uint32_t)((i * i + i) / 2)) & (GLYPH_CACHE_SIZE - 1);
-        
+
         if (cache->entries[probe_index].key == 0) {
             // Empty slot found
-            cache->entries[probe_index].key = key;
-            cache->entries[probe_index].texture = texture;
-            cache->entries[probe_index].w = w;
-            cache->entries[probe_index].h = h;
+            slot = &cache->entries[probe_index];
             cache->last_access[probe_index] = ++cache->access_counter;
-            cache->hits++;
-            return true;
+            cache->count++;
+            break;
         }
-        
+
         if (cache->entries[probe_index].key == key) {
-            // Key already exists, update texture
-            if (cache->entries[probe_index].texture) {
-                SDL_DestroyTexture(cache->entries[probe_index].texture);
-            }
-            cache->entries[probe_index].texture = texture;
-            cache->entries[probe_index].w = w;
-            cache->entries[probe_index].h = h;
+            // Key already exists, point it at the new coverage
+            slot = &cache->entries[probe_index];
             cache->last_access[probe_index] = ++cache->access_counter;
-            cache->hits++;
-            return true;
+            break;
         }
-        
+
         // Track oldest entry for eviction
         if (cache->last_access[probe_index] < oldest_access) {
             oldest_access = cache->last_access[probe_index];
             oldest_index = probe_index;
         }
     }
-    
-    // Cache is full, evict oldest entry
-    if (cache->entries[oldest_index].texture) {
-        SDL_DestroyTexture(cache->entries[oldest_index].texture);
-    }
-    
-    cache->entries[oldest_index].key = key;
-    cache->entries[oldest_index].texture = texture;
-    cache->entries[oldest_index].w = w;
-    cache->entries[oldest_index].h = h;
-    cache->last_access[oldest_index] = ++cache->access_counter;
-    cache->misses++;
-    
-    DEBUG_LOG("Cache full, evicted oldest entry for key 0x%llx", (unsigned long long)key);
-    return true;
+
+    if (!slot) {
+        // Table is full, evict oldest entry. Its atlas space is reclaimed
+        // when the atlas fills up and is reset.
+        slot = &cache->entries[oldest_index];
+        cache->last_access[oldest_index] = ++cache->access_counter;
+        DEBUG_LOG("Cache full, evicted oldest entry for key 0x%llx", (unsigned long long)key);
+    }
+
+    slot->key = key;
+    slot->texture = cache->atlas;
+    slot->src = *src;
+    slot->w = src->w;
+    slot->h = src->h;
+    slot->color = false;
+    slot->coarse = false;
+    return slot;
 }
 
 bool glyph_cache_init(GlyphCache* cache, int capacity)
@@ -129,8 +165,27 @@ bool glyph_cache_init(GlyphCache* cache, int capacity)
     cache->access_counter = 0;
     cache->hits = 0;
     cache->misses = 0;
+    cache->count = 0;
 
-    last_font_style = -1;
+    cache->renderer = NULL;
+    cache->atlas = NULL;
+    cache->atlas_alpha = NULL;
+    cache->atlas_size = 0;
+    cache->pen_x = cache->pen_y = cache->shelf_h = 0;
+    cache->tint = (SDL_Color){255, 255, 255, 255};
+    cache->premultiplied = false;
+    cache->font_file = NULL;
+    cache->font_size = 0;
+    cache->font_id = 0;
+    cache->dirty = false;
+    cache->bitmap_font = NULL;
+    cache->color_depth = 32;
+    cache->raster_mode = GLYPH_RASTER_BLENDED;
+    memset(cache->fallback_faces, 0, sizeof(cache->fallback_faces));
+    memset(cache->fallback_tried, 0, sizeof(cache->fallback_tried));
+    cache->color_page = NULL;
+    cache->color_pixels = NULL;
+    cache->color_pen_x = cache->color_pen_y = cache->color_shelf_h = 0;
 
     DEBUG_LOG("Glyph cache initialized with capacity %d", GLYPH_CACHE_SIZE);
     return true;
@@ -142,14 +197,38 @@ void glyph_cache_cleanup(GlyphCache* cache)
         ERROR_LOG("Invalid parameter: cache=%p", (void*)cache);
         return;
     }
-    
+
+    glyph_cache_save(cache);
     glyph_cache_clear(cache);
-    
+
+    if (cache->atlas) {
+        SDL_DestroyTexture(cache->atlas);
+        cache->atlas = NULL;
+    }
+    if (cache->color_page) {
+        SDL_DestroyTexture(cache->color_page);
+        cache->color_page = NULL;
+    }
+    for (int i = 0; i < FONT_FALLBACK_MAX; i++) {
+        if (cache->fallback_faces[i]) {
+            TTF_CloseFont(cache->fallback_faces[i]);
+        }
+        cache->fallback_faces[i] = NULL;
+        cache->fallback_tried[i] = false;
+    }
+    free(cache->atlas_alpha);
+    cache->atlas_alpha = NULL;
+    free(cache->color_pixels);
+    cache->color_pixels = NULL;
+    free(cache->font_file);
+    cache->font_file = NULL;
+    cache->font_id = 0;
+
     // Reset counters
     cache->access_counter = 0;
     cache->hits = 0;
     cache->misses = 0;
-    
+
     DEBUG_LOG("Glyph cache cleaned up");
 }
 
@@ -160,24 +239,39 @@ void glyph_cache_clear(GlyphCache* cache)
         return;
     }
 
-    int cleared_count = 0;
-    for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
-        if (cache->entries[i].texture) {
-            SDL_DestroyTexture(cache->entries[i].texture);
-            cache->entries[i].texture = NULL;
-            cleared_count++;
-        }
-        cache->entries[i].key = 0;
-        cache->entries[i].w = 0;
-        cache->entries[i].h = 0;
-    }
-    
+    int cleared_count = cache->count;
+    // Entries share the atlas texture; only the packing is reset
+    memset(cache->entries, 0, GLYPH_CACHE_SIZE * sizeof(GlyphCacheEntry));
     memset(cache->last_access, 0, GLYPH_CACHE_SIZE * sizeof(uint32_t));
     cache->access_counter = 0;
     cache->hits = 0;
     cache->misses = 0;
-    
-    DEBUG_LOG("Cleared glyph cache, freed %d textures", cleared_count);
+    cache->count = 0;
+    cache->pen_x = cache->pen_y = cache->shelf_h = 0;
+    cache->color_pen_x = cache->color_pen_y = cache->color_shelf_h = 0;
+
+    DEBUG_LOG("Cleared glyph cache, dropped %d glyphs", cleared_count);
+}
+
+void glyph_cache_release(GlyphCache* cache)
+{
+    if (!cache || !cache->atlas) {
+        return;
+    }
+    size_t bytes = render_texture_bytes(cache->atlas) + (size_t)cache->atlas_size * cache->atlas_size;
+    glyph_cache_save(cache);
+    glyph_cache_clear(cache);
+    SDL_DestroyTexture(cache->atlas);
+    cache->atlas = NULL;
+    if (cache->color_page) {
+        SDL_DestroyTexture(cache->color_page);
+        cache->color_page = NULL;
+    }
+    free(cache->atlas_alpha);
+    cache->atlas_alpha = NULL;
+    free(cache->color_pixels);
+    cache->color_pixels = NULL;
+    DEBUG_LOG("Released glyph atlas, %zu KiB", bytes / 1024);
 }
 
 void glyph_cache_stats(GlyphCache* cache, int* hits, int* misses, int* size)
@@ -189,80 +283,740 @@ void glyph_cache_stats(GlyphCache* cache, int* hits, int* misses, int* size)
 
     if (hits) *hits = cache->hits;
     if (misses) *misses = cache->misses;
-    if (size) *size = GLYPH_CACHE_SIZE;
+    if (size) *size = cache->count;
+}
+
+// --- Atlas ---
+
+/**
+ * Uploads rows [y, y + h) of the CPU coverage as white texels, with
+ * 4-bit coverage in 16-bit mode. Premultiplied texels carry the coverage
+ * in every channel.
+ */
+static void atlas_upload(GlyphCache* cache, const SDL_Rect* rect)
+{
+    if (!cache->atlas || rect->w <= 0 || rect->h <= 0) {
+        return;
+    }
+    Uint32* pixels = malloc((size_t)rect->w * rect->h * sizeof(Uint32));
+    if (!pixels) {
+        return;
+    }
+    if (cache->color_depth == 16) {
+        Uint16* texels = (Uint16*)pixels;
+        for (int y = 0; y < rect->h; y++) {
+            const uint8_t* src = cache->atlas_alpha + (size_t)(rect->y + y) * cache->atlas_size + rect->x;
+            Uint16* dst = texels + (size_t)y * rect->w;
+            for (int x = 0; x < rect->w; x++) {
+                Uint16 a = (Uint16)((src[x] * 15 + 127) / 255);
+                dst[x] = cache->premultiplied ? (Uint16)(a * 0x1111u) : (Uint16)((a << 12) | 0x0FFF);
+            }
+        }
+        SDL_UpdateTexture(cache->atlas, rect, texels, rect->w * (int)sizeof(Uint16));
+        free(pixels);
+        return;
+    }
+    for (int y = 0; y < rect->h; y++) {
+        const uint8_t* src = cache->atlas_alpha + (size_t)(rect->y + y) * cache->atlas_size + rect->x;
+        Uint32* dst = pixels + (size_t)y * rect->w;
+        if (cache->premultiplied) {
+            for (int x = 0; x < rect->w; x++) {
+                dst[x] = (Uint32)src[x] * 0x01010101u;
+            }
+        } else {
+            for (int x = 0; x < rect->w; x++) {
+                dst[x] = ((Uint32)src[x] << 24) | 0x00FFFFFFu;
+            }
+        }
+    }
+    SDL_UpdateTexture(cache->atlas, rect, pixels, rect->w * (int)sizeof(Uint32));
+    free(pixels);
 }
 
-bool render_and_cache_glyph(SDL_Renderer* renderer, TTF_Font* font, GlyphCache* cache,
-                             uint32_t c, SDL_Color fg, SDL_Color bg, unsigned char attributes,
-                             SDL_Texture** texture, int* w, int* h)
+/**
+ * Shelf packer shared by the atlas and the color page.
+ * @return false if the page has no room left for w x h.
+ */
+static bool shelf_alloc(int size, int* pen_x, int* pen_y, int* shelf_h, int w, int h, SDL_Rect* out)
 {
-    (void)bg;
-    if (!renderer || !font || !cache || !texture || !w || !h) {
+    if (*pen_x + w + GLYPH_ATLAS_PAD > size) {
+        *pen_y += *shelf_h;
+        *pen_x = 0;
+        *shelf_h = 0;
+    }
+    if (*pen_y + h + GLYPH_ATLAS_PAD > size) {
         return false;
     }
+    *out = (SDL_Rect){ *pen_x, *pen_y, w, h };
+    *pen_x += w + GLYPH_ATLAS_PAD;
+    if (h + GLYPH_ATLAS_PAD > *shelf_h) {
+        *shelf_h = h + GLYPH_ATLAS_PAD;
+    }
+    return true;
+}
 
-    // Convert UTF-32 character to UTF-8 string for rendering
-    char utf8_str[5];
-    int utf8_len = 0;
-    
+/**
+ * Reserves a w x h rectangle; resets the atlas when it is full.
+ */
+static bool atlas_alloc(GlyphCache* cache, int w, int h, SDL_Rect* out)
+{
+    int size = cache->atlas_size;
+    if (w + GLYPH_ATLAS_PAD > size || h + GLYPH_ATLAS_PAD > size) {
+        return false;
+    }
+    if (!shelf_alloc(size, &cache->pen_x, &cache->pen_y, &cache->shelf_h, w, h, out)) {
+        DEBUG_LOG("Glyph atlas full, starting over");
+        glyph_cache_clear(cache);
+        shelf_alloc(size, &cache->pen_x, &cache->pen_y, &cache->shelf_h, w, h, out);
+    }
+    return true;
+}
+
+/**
+ * Copies a color glyph into the RGBA page, scaled down to @p max_h rows.
+ * The page is created on first use; when it is full the cache starts over.
+ */
+static GlyphCacheEntry* color_page_store(GlyphCache* cache, SDL_Surface* surface, uint64_t key, int max_h)
+{
+    if (!cache->color_page) {
+        cache->color_page = SDL_CreateTexture(cache->renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                              GLYPH_COLOR_PAGE_SIZE, GLYPH_COLOR_PAGE_SIZE);
+        if (!cache->color_page) {
+            WARN_LOG("Failed to create color glyph page: %s", SDL_GetError());
+            return NULL;
+        }
+        SDL_SetTextureBlendMode(cache->color_page, SDL_BLENDMODE_BLEND);
+        cache->color_pixels = calloc((size_t)GLYPH_COLOR_PAGE_SIZE * GLYPH_COLOR_PAGE_SIZE, sizeof(uint32_t));
+    }
+
+    int w = surface->w, h = surface->h;
+    if (max_h > 0 && h > max_h) {
+        w = w * max_h / h;
+        h = max_h;
+    }
+    if (w <= 0 || h <= 0 || w + GLYPH_ATLAS_PAD > GLYPH_COLOR_PAGE_SIZE || h + GLYPH_ATLAS_PAD > GLYPH_COLOR_PAGE_SIZE) {
+        return NULL;
+    }
+
+    SDL_Surface* scaled = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!scaled) {
+        return NULL;
+    }
+    // Copy color and alpha as is instead of blending onto transparent black
+    SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+    SDL_BlitScaled(surface, NULL, scaled, NULL);
+
+    SDL_Rect rect;
+    if (!shelf_alloc(GLYPH_COLOR_PAGE_SIZE, &cache->color_pen_x, &cache->color_pen_y, &cache->color_shelf_h,
+                     w, h, &rect)) {
+        DEBUG_LOG("Color glyph page full, starting over");
+        glyph_cache_clear(cache);
+        shelf_alloc(GLYPH_COLOR_PAGE_SIZE, &cache->color_pen_x, &cache->color_pen_y, &cache->color_shelf_h,
+                    w, h, &rect);
+    }
+    SDL_UpdateTexture(cache->color_page, &rect, scaled->pixels, scaled->pitch);
+    for (int y = 0; cache->color_pixels && y < h; y++) {
+        memcpy(cache->color_pixels + (size_t)(rect.y + y) * GLYPH_COLOR_PAGE_SIZE + rect.x,
+               (const uint8_t*)scaled->pixels + (size_t)y * scaled->pitch, (size_t)w * sizeof(uint32_t));
+    }
+    SDL_FreeSurface(scaled);
+
+    GlyphCacheEntry* entry = glyph_cache_put(cache, key, &rect);
+    if (entry) {
+        entry->texture = cache->color_page;
+        entry->color = true;
+    }
+    return entry;
+}
+
+/**
+ * Returns true if a glyph rendered in white came out with other colors.
+ */
+static bool surface_has_color(SDL_Surface* surface)
+{
+    const SDL_PixelFormat* fmt = surface->format;
+    Uint32 rgb_mask = fmt->Rmask | fmt->Gmask | fmt->Bmask;
+    bool color = false;
+    SDL_LockSurface(surface);
+    for (int y = 0; y < surface->h && !color; y++) {
+        const Uint32* row = (const Uint32*)((const Uint8*)surface->pixels + (size_t)y * surface->pitch);
+        for (int x = 0; x < surface->w; x++) {
+            if ((row[x] & fmt->Amask) && (row[x] & rgb_mask) != rgb_mask) {
+                color = true;
+                break;
+            }
+        }
+    }
+    SDL_UnlockSurface(surface);
+    return color;
+}
+
+/**
+ * Returns the face for @p font_index at the cache's size, opening it on
+ * first use. Falls back to the primary font if it cannot be opened.
+ */
+static TTF_Font* fallback_face(GlyphCache* cache, TTF_Font* primary, unsigned font_index)
+{
+    if (font_index == 0 || font_index > FONT_FALLBACK_MAX) {
+        return primary;
+    }
+    unsigned i = font_index - 1;
+    if (!cache->fallback_tried[i]) {
+        cache->fallback_tried[i] = true;
+        const char* path = font_fallback_path(font_index);
+        cache->fallback_faces[i] = path ? TTF_OpenFont(path, cache->font_size) : NULL;
+        if (path && !cache->fallback_faces[i]) {
+            WARN_LOG("Failed to open fallback font %s: %s", path, TTF_GetError());
+        }
+    }
+    return cache->fallback_faces[i] ? cache->fallback_faces[i] : primary;
+}
+
+/**
+ * Expands a 1bpp cell bitmap into the CPU coverage. Bold is synthesized by
+ * smearing one pixel right, italic by shearing the rows above the bottom.
+ */
+static GlyphCacheEntry* atlas_expand_bitmap(GlyphCache* cache, const uint8_t* bits, uint32_t c,
+                                            unsigned char attributes)
+{
+    const BitmapFont* bf = cache->bitmap_font;
+    int slant = (attributes & ATTR_ITALIC) ? (bf->height - 1) / 4 : 0;
+    SDL_Rect rect;
+    if (!atlas_alloc(cache, bf->width + slant, bf->height, &rect)) {
+        return NULL;
+    }
+
+    for (int y = 0; y < bf->height; y++) {
+        const uint8_t* row = bits + (size_t)y * bf->stride;
+        uint8_t* dst = cache->atlas_alpha + (size_t)(rect.y + y) * cache->atlas_size + rect.x;
+        int shift = slant ? slant * (bf->height - 1 - y) / (bf->height - 1) : 0;
+        memset(dst, 0, (size_t)rect.w);
+        for (int x = 0; x < bf->width; x++) {
+            bool on = row[x / 8] & (0x80 >> (x % 8));
+            if (!on && (attributes & ATTR_BOLD) && x > 0) {
+                on = row[(x - 1) / 8] & (0x80 >> ((x - 1) % 8));
+            }
+            if (on || ((attributes & ATTR_UNDERLINE) && y == bf->height - 1)) {
+                dst[x + shift] = 255;
+            }
+        }
+    }
+
+    return glyph_cache_put(cache, make_glyph_key(c, attributes, 0), &rect);
+}
+
+static int utf8_encode(uint32_t c, char* out)
+{
     if (c < 0x80) {
-        utf8_str[0] = (char)c;
-        utf8_len = 1;
+        out[0] = (char)c;
+        return 1;
     } else if (c < 0x800) {
-        utf8_str[0] = 0xC0 | (c >> 6);
-        utf8_str[1] = 0x80 | (c & 0x3F);
-        utf8_len = 2;
+        out[0] = (char)(0xC0 | (c >> 6));
+        out[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
     } else if (c < 0x10000) {
-        utf8_str[0] = 0xE0 | (c >> 12);
-        utf8_str[1] = 0x80 | ((c >> 6) & 0x3F);
-        utf8_str[2] = 0x80 | (c & 0x3F);
-        utf8_len = 3;
+        out[0] = (char)(0xE0 | (c >> 12));
+        out[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (c >> 18));
+    out[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
+
+/**
+ * Rasterizes @p c into the CPU coverage. The caller uploads it.
+ */
+static GlyphCacheEntry* atlas_rasterize(GlyphCache* cache, TTF_Font* font, uint32_t c, unsigned char attributes,
+                                        unsigned font_index)
+{
+    // Codepoints the bitmap font lacks still go through FreeType
+    const uint8_t* bits = font_index == 0 ? bitmap_font_glyph(cache->bitmap_font, c) : NULL;
+    if (bits) {
+        return atlas_expand_bitmap(cache, bits, c, attributes);
+    }
+    TTF_Font* primary = font;
+    font = fallback_face(cache, primary, font_index);
+
+    // Convert the UTF-32 character, or every codepoint of a cluster, to a
+    // UTF-8 string so the cluster is shaped in one go
+    char utf8_str[GLYPH_CLUSTER_MAX_CHARS * 4 + 1];
+    int utf8_len = 0;
+    int cluster_len = 0;
+    const uint32_t* cluster = glyph_cluster_chars(c, &cluster_len);
+    if (cluster) {
+        for (int i = 0; i < cluster_len; i++) {
+            utf8_len += utf8_encode(cluster[i], utf8_str + utf8_len);
+        }
     } else {
-        utf8_str[0] = 0xF0 | (c >> 18);
-        utf8_str[1] = 0x80 | ((c >> 12) & 0x3F);
-        utf8_str[2] = 0x80 | ((c >> 6) & 0x3F);
-        utf8_str[3] = 0x80 | (c & 0x3F);
-        utf8_len = 4;
+        utf8_len = utf8_encode(c, utf8_str);
     }
     utf8_str[utf8_len] = '\0';
 
-    // Apply text styling based on attributes (only set if different from current)
+    // Apply text styling based on attributes. The font is shared with the
+    // OSK and HUD, so it is always handed back in the normal style.
     int font_style = TTF_STYLE_NORMAL;
     if (attributes & ATTR_BOLD) font_style |= TTF_STYLE_BOLD;
     if (attributes & ATTR_ITALIC) font_style |= TTF_STYLE_ITALIC;
     if (attributes & ATTR_UNDERLINE) font_style |= TTF_STYLE_UNDERLINE;
 
-    if (font_style != last_font_style) {
+    if (font_style != TTF_STYLE_NORMAL) {
         TTF_SetFontStyle(font, font_style);
-        last_font_style = font_style;
     }
-
-    // Render the glyph
-    SDL_Surface* surface = TTF_RenderUTF8_Blended(font, utf8_str, fg);
-    if (!surface) {
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Color black = {0, 0, 0, 255};
+    SDL_Surface* surface;
+    switch (cache->raster_mode) {
+    case GLYPH_RASTER_SHADED:
+        surface = TTF_RenderUTF8_Shaded(font, utf8_str, white, black);
+        break;
+    case GLYPH_RASTER_SOLID:
+        surface = TTF_RenderUTF8_Solid(font, utf8_str, white);
+        break;
+    default:
+        surface = TTF_RenderUTF8_Blended(font, utf8_str, white);
+        break;
+    }
+    if (font_style != TTF_STYLE_NORMAL) {
         TTF_SetFontStyle(font, TTF_STYLE_NORMAL);
+    }
+    if (!surface) {
+        return NULL;
+    }
+
+    uint64_t key = make_glyph_key(c, attributes, font_index);
+    SDL_Rect rect;
+    GlyphCacheEntry* entry = NULL;
+    if (surface->format->BytesPerPixel == 4 && surface_has_color(surface)) {
+        entry = color_page_store(cache, surface, key, TTF_FontHeight(primary));
+    } else if (surface->format->BytesPerPixel == 4 && atlas_alloc(cache, surface->w, surface->h, &rect)) {
+        const SDL_PixelFormat* fmt = surface->format;
+        SDL_LockSurface(surface);
+        for (int y = 0; y < surface->h; y++) {
+            const Uint32* src = (const Uint32*)((const Uint8*)surface->pixels + (size_t)y * surface->pitch);
+            uint8_t* dst = cache->atlas_alpha + (size_t)(rect.y + y) * cache->atlas_size + rect.x;
+            for (int x = 0; x < surface->w; x++) {
+                dst[x] = (uint8_t)((src[x] & fmt->Amask) >> fmt->Ashift);
+            }
+        }
+        SDL_UnlockSurface(surface);
+        entry = glyph_cache_put(cache, key, &rect);
+        cache->dirty = true;
+    } else if (surface->format->BytesPerPixel == 1 && surface->format->palette &&
+               atlas_alloc(cache, surface->w, surface->h, &rect)) {
+        // Shaded and Solid come out palettized, white over black: the red
+        // channel of a pixel's palette entry is its coverage
+        const SDL_Palette* palette = surface->format->palette;
+        SDL_LockSurface(surface);
+        for (int y = 0; y < surface->h; y++) {
+            const Uint8* src = (const Uint8*)surface->pixels + (size_t)y * surface->pitch;
+            uint8_t* dst = cache->atlas_alpha + (size_t)(rect.y + y) * cache->atlas_size + rect.x;
+            for (int x = 0; x < surface->w; x++) {
+                dst[x] = src[x] < palette->ncolors ? palette->colors[src[x]].r : 0;
+            }
+        }
+        SDL_UnlockSurface(surface);
+        entry = glyph_cache_put(cache, key, &rect);
+        if (entry) {
+            entry->coarse = true;
+        }
+    }
+    SDL_FreeSurface(surface);
+    return entry;
+}
+
+static uint64_t fnv1a(uint64_t h, const void* data, size_t len)
+{
+    const uint8_t* p = data;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+/**
+ * Identifies everything that changes the rasterized output.
+ */
+static uint64_t atlas_font_id(const GlyphCache* cache, TTF_Font* font)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    struct stat st;
+    if (!cache->font_file || stat(cache->font_file, &st) != 0) {
+        return 0;
+    }
+    int64_t file_size = st.st_size, file_mtime = st.st_mtime;
+    int params[] = {
+        cache->font_size, TTF_GetFontHinting(font), TTF_FontHeight(font),
+        TTF_FontAscent(font), cache->atlas_size, GLYPH_ATLAS_VERSION
+    };
+    // Font indices in the keys refer to the fallback chain
+    uint64_t chain = font_fallback_id();
+    h = fnv1a(h, cache->font_file, strlen(cache->font_file));
+    h = fnv1a(h, &file_size, sizeof(file_size));
+    h = fnv1a(h, &file_mtime, sizeof(file_mtime));
+    h = fnv1a(h, params, sizeof(params));
+    h = fnv1a(h, &chain, sizeof(chain));
+    // Guards against a fallback font opened in place of font_file
+    const char* family = TTF_FontFaceFamilyName(font);
+    const char* style = TTF_FontFaceStyleName(font);
+    if (family) h = fnv1a(h, family, strlen(family));
+    if (style) h = fnv1a(h, style, strlen(style));
+    return h ? h : 1;
+}
+
+static void atlas_file_path(const GlyphCache* cache, char* out, size_t out_size)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "glyphs-%016llx.vxa", (unsigned long long)cache->font_id);
+    if (!cache_file_path(name, out, out_size)) {
+        out[0] = '\0';
+    }
+}
+
+/**
+ * Restores entries and coverage from disk, then uploads them in one update.
+ */
+static bool atlas_load(GlyphCache* cache)
+{
+    char path[4096];
+    atlas_file_path(cache, path, sizeof(path));
+    if (!path[0]) {
         return false;
     }
 
-    // Create texture
-    SDL_Texture* glyph_texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!glyph_texture) {
-        SDL_FreeSurface(surface);
-        TTF_SetFontStyle(font, TTF_STYLE_NORMAL);
+    size_t len = 0;
+    const uint8_t* map = cache_file_map(path, &len);
+    if (!map) {
+        return false;
+    }
+
+    const GlyphAtlasHeader* header = (const GlyphAtlasHeader*)map;
+    size_t size = (size_t)cache->atlas_size;
+    bool ok = len >= sizeof(*header) &&
+              memcmp(header->magic, GLYPH_ATLAS_MAGIC, 4) == 0 &&
+              header->version == GLYPH_ATLAS_VERSION &&
+              header->font_id == cache->font_id &&
+              header->atlas_size == size &&
+              header->used_h <= size &&
+              // The pen resumes packing here: it must lie within the rows loaded
+              header->pen_x >= 0 && (size_t)header->pen_x <= size &&
+              header->pen_y >= 0 && header->shelf_h >= 0 &&
+              (int64_t)header->pen_y + header->shelf_h <= (int64_t)header->used_h &&
+              header->num_entries <= GLYPH_CACHE_SIZE &&
+              len == sizeof(*header) + header->num_entries * sizeof(GlyphAtlasEntry) + header->used_h * size;
+    if (!ok) {
+        cache_file_unmap(map, len);
         return false;
     }
 
-    // Get texture dimensions
-    *w = surface->w;
-    *h = surface->h;
-    *texture = glyph_texture;
+    const GlyphAtlasEntry* entries = (const GlyphAtlasEntry*)(map + sizeof(*header));
+    const uint8_t* coverage = (const uint8_t*)(entries + header->num_entries);
+    memcpy(cache->atlas_alpha, coverage, header->used_h * size);
+    for (uint32_t i = 0; i < header->num_entries; i++) {
+        const GlyphAtlasEntry* e = &entries[i];
+        if (e->key == 0 || e->x + e->w > size || e->y + e->h > header->used_h) {
+            continue;
+        }
+        SDL_Rect rect = { e->x, e->y, e->w, e->h };
+        glyph_cache_put(cache, e->key, &rect);
+    }
+    cache->pen_x = header->pen_x;
+    cache->pen_y = header->pen_y;
+    cache->shelf_h = header->shelf_h;
 
-    SDL_FreeSurface(surface);
-    TTF_SetFontStyle(font, TTF_STYLE_NORMAL);
+    SDL_Rect used = { 0, 0, (int)size, (int)header->used_h };
+    atlas_upload(cache, &used);
+    INFO_LOG("Loaded %u glyphs from %s", header->num_entries, path);
+    cache_file_unmap(map, len);
+    return true;
+}
+
+static void atlas_prebake(GlyphCache* cache, TTF_Font* font)
+{
+    Uint32 start = SDL_GetTicks();
+    for (size_t r = 0; r < sizeof(s_hot_ranges) / sizeof(s_hot_ranges[0]); r++) {
+        for (uint32_t c = s_hot_ranges[r].first; c <= s_hot_ranges[r].last; c++) {
+            if (cache->bitmap_font ? !bitmap_font_glyph(cache->bitmap_font, c)
+                                   : (c >= 0x80 && !TTF_GlyphIsProvided(font, (Uint16)c))) {
+                continue;
+            }
+            atlas_rasterize(cache, font, c, 0, 0);
+            if (c < 0x80) {
+                atlas_rasterize(cache, font, c, ATTR_BOLD, 0);
+            }
+        }
+    }
+    SDL_Rect used = { 0, 0, cache->atlas_size, cache->pen_y + cache->shelf_h };
+    atlas_upload(cache, &used);
+    DEBUG_LOG("Prebaked %d glyphs in %u ms", cache->count, SDL_GetTicks() - start);
+}
+
+void glyph_cache_set_font(GlyphCache* cache, const char* font_path, int font_size)
+{
+    if (!cache) {
+        return;
+    }
+    free(cache->font_file);
+    cache->font_file = font_path ? strdup(font_path) : NULL;
+    cache->font_size = font_size;
+    cache->font_id = 0;
+}
+
+void glyph_cache_set_color_depth(GlyphCache* cache, int depth)
+{
+    if (!cache) {
+        return;
+    }
+    cache->color_depth = depth;
+}
+
+/**
+ * Forgets glyphs rasterized below blended quality, so they are rasterized
+ * again on next use. Their coverage stays in the atlas until it is reset,
+ * as with evicted entries. The table is rebuilt, since emptying slots in
+ * place would cut the probe chains of the entries behind them.
+ */
+static int drop_coarse_entries(GlyphCache* cache)
+{
+    GlyphCacheEntry* kept = malloc(sizeof(GlyphCacheEntry) * (size_t)cache->count);
+    uint32_t* kept_access = malloc(sizeof(uint32_t) * (size_t)cache->count);
+    if (!kept || !kept_access) {
+        free(kept);
+        free(kept_access);
+        // Without room to rebuild, start over; the atlas is prebaked lazily
+        int dropped = cache->count;
+        glyph_cache_clear(cache);
+        return dropped;
+    }
+
+    int count = 0, dropped = 0;
+    for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+        if (cache->entries[i].key == 0) {
+            continue;
+        }
+        if (cache->entries[i].coarse) {
+            dropped++;
+            continue;
+        }
+        kept[count] = cache->entries[i];
+        kept_access[count] = cache->last_access[i];
+        count++;
+    }
+
+    if (dropped > 0) {
+        memset(cache->entries, 0, GLYPH_CACHE_SIZE * sizeof(GlyphCacheEntry));
+        memset(cache->last_access, 0, GLYPH_CACHE_SIZE * sizeof(uint32_t));
+        for (int k = 0; k < count; k++) {
+            uint32_t index = hash_key(kept[k].key);
+            for (int i = 0; i < GLYPH_CACHE_SIZE; ++i) {
+                uint32_t probe_index = (index + (uint32_t)((i * i + i) / 2)) & (GLYPH_CACHE_SIZE - 1);
+                if (cache->entries[probe_index].key == 0) {
+                    cache->entries[probe_index] = kept[k];
+                    cache->last_access[probe_index] = kept_access[k];
+                    break;
+                }
+            }
+        }
+        cache->count = count;
+    }
+    free(kept);
+    free(kept_access);
+    return dropped;
+}
+
+bool glyph_cache_set_raster_mode(GlyphCache* cache, GlyphRasterMode mode)
+{
+    if (!cache || cache->raster_mode == mode) {
+        return false;
+    }
+    bool recovered = mode == GLYPH_RASTER_BLENDED;
+    cache->raster_mode = mode;
+    if (!recovered || cache->count == 0) {
+        return false;
+    }
+    int dropped = drop_coarse_entries(cache);
+    if (dropped > 0) {
+        DEBUG_LOG("Dropped %d glyphs rasterized at reduced quality", dropped);
+    }
+    return dropped > 0;
+}
+
+void glyph_cache_set_bitmap_font(GlyphCache* cache, const BitmapFont* font)
+{
+    if (!cache) {
+        return;
+    }
+    cache->bitmap_font = font;
+    cache->font_id = 0;
+}
 
-    // Cache the glyph
-    uint64_t cache_key = make_glyph_key(c, attributes, fg);
-    glyph_cache_put(cache, cache_key, glyph_texture, *w, *h);
+bool glyph_cache_prepare(GlyphCache* cache, SDL_Renderer* renderer, TTF_Font* font)
+{
+    if (!cache || !renderer || !font) {
+        return false;
+    }
+    if (cache->atlas && cache->renderer == renderer) {
+        return true;
+    }
 
+    if (cache->atlas) {
+        SDL_DestroyTexture(cache->atlas);
+        cache->atlas = NULL;
+    }
+    if (cache->color_page) {
+        SDL_DestroyTexture(cache->color_page);
+        cache->color_page = NULL;
+    }
+    free(cache->color_pixels);
+    cache->color_pixels = NULL;
+    glyph_cache_clear(cache);
+
+    SDL_RendererInfo info;
+    int size = GLYPH_ATLAS_MAX_SIZE;
+    if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0) {
+        if (info.max_texture_width < size) size = info.max_texture_width;
+        if (info.max_texture_height > 0 && info.max_texture_height < size) size = info.max_texture_height;
+    }
+
+    if (!cache->atlas_alpha || cache->atlas_size != size) {
+        free(cache->atlas_alpha);
+        cache->atlas_alpha = calloc((size_t)size * size, 1);
+        if (!cache->atlas_alpha) {
+            ERROR_LOG("Failed to allocate %dx%d glyph atlas", size, size);
+            return false;
+        }
+    }
+    cache->atlas_size = size;
+    Uint32 format = cache->color_depth == 16 ? SDL_PIXELFORMAT_ARGB4444 : SDL_PIXELFORMAT_ARGB8888;
+    cache->atlas = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC, size, size);
+    if (!cache->atlas) {
+        ERROR_LOG("Failed to create glyph atlas texture: %s", SDL_GetError());
+        return false;
+    }
+    // Premultiplied coverage composites correctly over translucent targets
+    // such as a background image; the software renderer lacks custom blends
+    SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+        SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+    cache->premultiplied = SDL_SetTextureBlendMode(cache->atlas, premultiplied) == 0;
+    if (!cache->premultiplied) {
+        SDL_SetTextureBlendMode(cache->atlas, SDL_BLENDMODE_BLEND);
+    }
+    INFO_LOG("Glyph atlas %dx%d %s: %zu KiB", size, size, SDL_GetPixelFormatName(format),
+             render_texture_bytes(cache->atlas) / 1024);
+    cache->renderer = renderer;
+    cache->tint = (SDL_Color){255, 255, 255, 255};
+
+    // Expanding a bitmap font is cheaper than loading a saved atlas
+    cache->font_id = cache->bitmap_font ? 0 : atlas_font_id(cache, font);
+    if (cache->font_id && atlas_load(cache)) {
+        cache->dirty = false;
+    } else {
+        atlas_prebake(cache, font);
+        cache->dirty = cache->font_id != 0;
+    }
     return true;
 }
+
+void glyph_cache_save(GlyphCache* cache)
+{
+    if (!cache || !cache->dirty || !cache->font_id || !cache->atlas_alpha || cache->count == 0) {
+        return;
+    }
+
+    char path[4096];
+    atlas_file_path(cache, path, sizeof(path));
+    if (!path[0]) {
+        return;
+    }
+
+    size_t size = (size_t)cache->atlas_size;
+    uint32_t used_h = (uint32_t)(cache->pen_y + cache->shelf_h);
+    if (used_h > size) used_h = (uint32_t)size;
+    size_t len = sizeof(GlyphAtlasHeader) + (size_t)cache->count * sizeof(GlyphAtlasEntry) + used_h * size;
+    uint8_t* data = malloc(len);
+    if (!data) {
+        return;
+    }
+
+    GlyphAtlasHeader* header = (GlyphAtlasHeader*)data;
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, GLYPH_ATLAS_MAGIC, 4);
+    header->version = GLYPH_ATLAS_VERSION;
+    header->font_id = cache->font_id;
+    header->atlas_size = (uint32_t)size;
+    header->used_h = used_h;
+    header->pen_x = cache->pen_x;
+    header->pen_y = cache->pen_y;
+    header->shelf_h = cache->shelf_h;
+
+    // Every glyph drawn this session is kept, so the next start has them
+    GlyphAtlasEntry* out = (GlyphAtlasEntry*)(data + sizeof(*header));
+    uint32_t n = 0;
+    for (int i = 0; i < GLYPH_CACHE_SIZE && n < (uint32_t)cache->count; i++) {
+        const GlyphCacheEntry* e = &cache->entries[i];
+        // Cluster ids are only meaningful in this session
+        // Coarse glyphs would outlive the load that made them
+        if (e->key == 0 || e->color || e->coarse || glyph_is_cluster((uint32_t)e->key)) continue;
+        out[n++] = (GlyphAtlasEntry){ e->key, (uint16_t)e->src.x, (uint16_t)e->src.y,
+                                      (uint16_t)e->src.w, (uint16_t)e->src.h };
+    }
+    header->num_entries = n;
+    memcpy(out + n, cache->atlas_alpha, used_h * size);
+    len = sizeof(*header) + n * sizeof(GlyphAtlasEntry) + used_h * size;
+
+    if (cache_file_write_atomic(path, data, len)) {
+        DEBUG_LOG("Saved %u glyphs to %s", n, path);
+        cache->dirty = false;
+    }
+    free(data);
+}
+
+GlyphCacheEntry* render_and_cache_glyph(TTF_Font* font, GlyphCache* cache, uint32_t c,
+                                        unsigned char attributes, unsigned font_index)
+{
+    if (!font || !cache || !cache->atlas) {
+        return NULL;
+    }
+
+    GlyphCacheEntry* entry = atlas_rasterize(cache, font, c, attributes, font_index);
+    if (entry && !entry->color) {
+        atlas_upload(cache, &entry->src);
+    }
+    return entry;
+}
+
+GlyphCacheEntry* glyph_cache_lookup(GlyphCache* cache, TTF_Font* font, uint32_t c, unsigned char attributes)
+{
+    unsigned font_index = font_fallback_resolve(glyph_cluster_base(c));
+    GlyphCacheEntry* entry = glyph_cache_get(cache, make_glyph_key(c, attributes, font_index));
+    if (!entry) {
+        // Cache miss — rasterize into the atlas
+        uint64_t miss_start = trace_begin();
+        entry = render_and_cache_glyph(font, cache, c, attributes, font_index);
+        trace_end("glyph_miss", miss_start, c);
+    }
+    return entry;
+}
+
+void glyph_cache_tint(GlyphCache* cache, SDL_Color fg)
+{
+    bool alpha_changed = fg.a != cache->tint.a;
+    if (fg.r != cache->tint.r || fg.g != cache->tint.g || fg.b != cache->tint.b ||
+        (cache->premultiplied && alpha_changed)) {
+        if (cache->premultiplied) {
+            // The color of a premultiplied texel is scaled by its alpha too
+            SDL_SetTextureColorMod(cache->atlas, (Uint8)(fg.r * fg.a / 255), (Uint8)(fg.g * fg.a / 255),
+                                   (Uint8)(fg.b * fg.a / 255));
+        } else {
+            SDL_SetTextureColorMod(cache->atlas, fg.r, fg.g, fg.b);
+        }
+    }
+    if (alpha_changed) {
+        SDL_SetTextureAlphaMod(cache->atlas, fg.a);
+    }
+    cache->tint = fg;
+}
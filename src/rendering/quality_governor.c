@@ -0,0 +1,165 @@
+/**
+ * @file quality_governor.c
+ * @brief Load-adaptive rendering quality tiers.
+ *
+ * Frame busy time is smoothed, so a single slow frame (a font change, a
+ * full repaint) does not cost quality. A tier only changes once its
+ * condition has held for governor_hold_ms; recovering takes twice as long
+ * so the tiers do not flap at the edge of the budget.
+ */
+
+#include <SDL.h>
+
+#include "quality_governor.h"
+#include "error_codes.h"
+
+#define GOVERNOR_SMOOTHING 0.25   // Weight of the newest frame
+
+static const char* const s_tier_names[QUALITY_TIER_COUNT] = {
+    "full", "shaded glyphs", "no background", "no blink", "low rate"
+};
+
+static struct {
+    bool enabled;
+    QualityTier tier;
+    int fps;              // Frame rate the budget is taken from
+    double budget_ms;
+    double high_ms;
+    double low_ms;
+    int high_pct;
+    int low_pct;
+    Uint32 hold_ms;
+    double load_ms;       // Smoothed busy time per frame
+    Uint32 over_since;    // 0 = load not above high_ms
+    Uint32 under_since;   // 0 = load not below low_ms
+    Uint32 last_frame;
+} s_gov;
+
+static void set_budget(int fps)
+{
+    s_gov.fps = fps > 0 ? fps : 30;
+    s_gov.budget_ms = 1000.0 / s_gov.fps;
+    s_gov.high_ms = s_gov.budget_ms * s_gov.high_pct / 100.0;
+    s_gov.low_ms = s_gov.budget_ms * s_gov.low_pct / 100.0;
+}
+
+void quality_governor_init(const Config* config)
+{
+    s_gov.tier = QUALITY_TIER_FULL;
+    s_gov.high_pct = config->governor_high_pct;
+    s_gov.low_pct = config->governor_low_pct;
+    set_budget(config->target_fps);
+    s_gov.hold_ms = (Uint32)config->governor_hold_ms;
+    s_gov.load_ms = 0.0;
+    s_gov.over_since = 0;
+    s_gov.under_since = 0;
+    s_gov.last_frame = 0;
+    // Unthrottled replays are benchmarks; their frame times say nothing about load
+    s_gov.enabled = config->governor_high_pct > 0 && !config->replay_fast;
+    if (s_gov.enabled) {
+        DEBUG_LOG("Quality governor: budget %.1f ms, lower above %.1f ms, recover below %.1f ms",
+                  s_gov.budget_ms, s_gov.high_ms, s_gov.low_ms);
+    }
+}
+
+void quality_governor_set_fps(int fps)
+{
+    if ((fps > 0 ? fps : 30) == s_gov.fps) {
+        return;
+    }
+    set_budget(fps);
+    // Load measured against the old budget does not count toward a step
+    s_gov.over_since = 0;
+    s_gov.under_since = 0;
+    if (s_gov.enabled) {
+        DEBUG_LOG("Quality governor: budget %.1f ms at %d fps", s_gov.budget_ms, s_gov.fps);
+    }
+}
+
+static bool set_tier(QualityTier tier)
+{
+    INFO_LOG("Quality tier %d (%s) -> %d (%s): frame %.1f ms of %.1f ms budget",
+             (int)s_gov.tier, s_tier_names[s_gov.tier], (int)tier, s_tier_names[tier],
+             s_gov.load_ms, s_gov.budget_ms);
+    s_gov.tier = tier;
+    // The next step waits for a full hold at the new tier
+    s_gov.over_since = 0;
+    s_gov.under_since = 0;
+    return true;
+}
+
+static bool evaluate(Uint32 now)
+{
+    // 0 marks "not started", so never record it as a start time
+    Uint32 stamp = now ? now : 1;
+
+    if (s_gov.load_ms > s_gov.high_ms) {
+        s_gov.under_since = 0;
+        if (!s_gov.over_since) {
+            s_gov.over_since = stamp;
+        } else if (now - s_gov.over_since >= s_gov.hold_ms && s_gov.tier + 1 < QUALITY_TIER_COUNT) {
+            return set_tier(s_gov.tier + 1);
+        }
+    } else if (s_gov.load_ms < s_gov.low_ms) {
+        s_gov.over_since = 0;
+        if (!s_gov.under_since) {
+            s_gov.under_since = stamp;
+        } else if (now - s_gov.under_since >= 2 * s_gov.hold_ms && s_gov.tier > QUALITY_TIER_FULL) {
+            return set_tier(s_gov.tier - 1);
+        }
+    } else {
+        s_gov.over_since = 0;
+        s_gov.under_since = 0;
+    }
+    return false;
+}
+
+bool quality_governor_frame(Uint32 now, double busy_ms)
+{
+    if (!s_gov.enabled) {
+        return false;
+    }
+    s_gov.load_ms += (busy_ms - s_gov.load_ms) * GOVERNOR_SMOOTHING;
+    s_gov.last_frame = now;
+    return evaluate(now);
+}
+
+bool quality_governor_idle(Uint32 now)
+{
+    if (!s_gov.enabled || s_gov.tier == QUALITY_TIER_FULL) {
+        return false;
+    }
+    // Nothing drawn for a whole hold: the load is gone
+    if (now - s_gov.last_frame >= s_gov.hold_ms) {
+        s_gov.load_ms = 0.0;
+    }
+    return evaluate(now);
+}
+
+QualityTier quality_governor_tier(void)
+{
+    return s_gov.tier;
+}
+
+GlyphRasterMode quality_governor_raster_mode(void)
+{
+    if (s_gov.tier >= QUALITY_TIER_LOW_RATE) {
+        return GLYPH_RASTER_SOLID;
+    }
+    return s_gov.tier >= QUALITY_TIER_SHADED_GLYPHS ? GLYPH_RASTER_SHADED : GLYPH_RASTER_BLENDED;
+}
+
+bool quality_governor_draw_background(void)
+{
+    return s_gov.tier < QUALITY_TIER_NO_BACKGROUND;
+}
+
+bool quality_governor_blink(void)
+{
+    return s_gov.tier < QUALITY_TIER_NO_BLINK;
+}
+
+Uint32 quality_governor_render_gap(Uint32 frame_ms)
+{
+    return s_gov.tier >= QUALITY_TIER_LOW_RATE ? 2 * frame_ms : 0;
+}
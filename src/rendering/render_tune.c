@@ -0,0 +1,346 @@
+/**
+ * @file render_tune.c
+ * @brief First-run choice of the fastest renderer configuration.
+ *
+ * The frame mix is an 80x30 grid of 8x16 cells: a clear, a background
+ * fill for every eighth cell, and one tinted glyph per cell from an atlas
+ * of the same format the glyph cache uses. The software driver is timed
+ * the way soft_render.c draws instead: blending coverage on the CPU and
+ * uploading the frame. A frame's time is its busy time, up to a one-pixel
+ * readback that waits for the GPU; waiting for vblank in present is not
+ * counted, so vsync only loses when it slows drawing down.
+ */
+
+#include "render_tune.h"
+#include "soft_render.h"
+#include "config_manager.h"
+#include "cache_file.h"
+#include "error_codes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TUNE_FILE "renderer.conf"
+#define TUNE_COLS 80
+#define TUNE_ROWS 30
+#define TUNE_CELL_W 8
+#define TUNE_CELL_H 16
+#define TUNE_ATLAS_SIZE 256
+#define TUNE_WARMUP_FRAMES 3
+#define TUNE_FRAMES 12
+#define TUNE_VSYNC_SLACK 1.10   // Vsync wins when within 10% of the fastest
+
+static uint64_t fnv1a(uint64_t h, const void* data, size_t len)
+{
+    const unsigned char* p = data;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * Identifies the device by platform, video driver, display mode and the
+ * render drivers available, so a tune is redone after any of them change.
+ */
+static uint64_t device_id(SDL_Window* win)
+{
+    uint64_t h = 14695981039346656037ULL;
+    const char* platform = SDL_GetPlatform();
+    const char* video = SDL_GetCurrentVideoDriver();
+    if (platform) h = fnv1a(h, platform, strlen(platform));
+    if (video) h = fnv1a(h, video, strlen(video));
+
+    SDL_DisplayMode mode;
+    int display = SDL_GetWindowDisplayIndex(win);
+    if (SDL_GetDesktopDisplayMode(display < 0 ? 0 : display, &mode) == 0) {
+        int fields[4] = {mode.w, mode.h, (int)mode.format, mode.refresh_rate};
+        h = fnv1a(h, fields, sizeof(fields));
+    }
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); i++) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) == 0 && info.name) {
+            h = fnv1a(h, info.name, strlen(info.name));
+        }
+    }
+    return h;
+}
+
+static bool tune_load(uint64_t device, int color_depth, RenderTuneResult* out)
+{
+    char path[4096];
+    if (!config_dir_path(TUNE_FILE, path, sizeof(path))) {
+        return false;
+    }
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    RenderTuneResult r = {0};
+    uint64_t saved_device = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char key[32], value[64];
+        if (line[0] == '#' || sscanf(line, " %31[^=]=%63s", key, value) != 2) {
+            continue;
+        }
+        if (strcmp(key, "device") == 0) {
+            saved_device = strtoull(value, NULL, 16);
+        } else if (strcmp(key, "driver") == 0) {
+            snprintf(r.driver, sizeof(r.driver), "%s", value);
+        } else if (strcmp(key, "vsync") == 0) {
+            r.vsync = atoi(value) != 0;
+        } else if (strcmp(key, "color_depth") == 0) {
+            r.color_depth = atoi(value);
+        } else if (strcmp(key, "frame_ms") == 0) {
+            r.frame_ms = atof(value);
+        }
+    }
+    fclose(file);
+
+    // A choice measured at the other depth says nothing about this one
+    if (saved_device != device || !r.driver[0] || r.color_depth != color_depth) {
+        return false;
+    }
+    *out = r;
+    return true;
+}
+
+static void tune_save(uint64_t device, const RenderTuneResult* r)
+{
+    char path[4096];
+    if (!config_dir_path(TUNE_FILE, path, sizeof(path))) {
+        return;
+    }
+    char buf[512];
+    int len = snprintf(buf, sizeof(buf),
+                       "# Fastest renderer measured on this device; run with --retune to measure again\n"
+                       "device=%016llx\ndriver=%s\nvsync=%d\ncolor_depth=%d\nframe_ms=%.3f\n",
+                       (unsigned long long)device, r->driver, r->vsync ? 1 : 0, r->color_depth, r->frame_ms);
+    if (len > 0 && (size_t)len < sizeof(buf) && !cache_file_write_atomic(path, buf, (size_t)len)) {
+        WARN_LOG("Could not save renderer choice to %s", path);
+    }
+}
+
+// --- Frame mix ---
+
+static uint8_t s_coverage[TUNE_ATLAS_SIZE * TUNE_ATLAS_SIZE];
+
+// Glyph-like coverage: mostly empty with solid strokes and soft edges
+static void fill_coverage(void)
+{
+    for (int y = 0; y < TUNE_ATLAS_SIZE; y++) {
+        for (int x = 0; x < TUNE_ATLAS_SIZE; x++) {
+            int cx = x % TUNE_CELL_W, cy = y % TUNE_CELL_H;
+            int stroke = (cx == 2 || cx == 5 || cy == 4 || cy == 11) && cy > 2 && cy < 14;
+            int edge = (cx == 1 || cx == 6) && cy > 3 && cy < 13;
+            s_coverage[y * TUNE_ATLAS_SIZE + x] = stroke ? 255 : edge ? 96 : 0;
+        }
+    }
+}
+
+static double seconds_now(void)
+{
+    return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+static const SDL_Color s_mix_colors[4] = {
+    {238, 238, 236, 255}, {138, 226, 52, 255}, {114, 159, 207, 255}, {239, 41, 41, 255},
+};
+
+static double time_gpu_mix(SDL_Renderer* renderer, int depth, int win_w, int win_h)
+{
+    Uint32 atlas_format = depth == 16 ? SDL_PIXELFORMAT_ARGB4444 : SDL_PIXELFORMAT_ARGB8888;
+    Uint32 target_format = depth == 16 ? SDL_PIXELFORMAT_RGB565 : SDL_PIXELFORMAT_RGBA8888;
+    SDL_Texture* atlas = SDL_CreateTexture(renderer, atlas_format, SDL_TEXTUREACCESS_STATIC, TUNE_ATLAS_SIZE, TUNE_ATLAS_SIZE);
+    SDL_Texture* target = SDL_CreateTexture(renderer, target_format, SDL_TEXTUREACCESS_TARGET, win_w, win_h);
+    Uint32* texels = malloc(sizeof(Uint32) * TUNE_ATLAS_SIZE * TUNE_ATLAS_SIZE);
+    double result = -1.0;
+    if (!atlas || !target || !texels) {
+        goto done;
+    }
+
+    for (int i = 0; i < TUNE_ATLAS_SIZE * TUNE_ATLAS_SIZE; i++) {
+        if (depth == 16) {
+            ((Uint16*)texels)[i] = (Uint16)(((s_coverage[i] >> 4) << 12) | 0x0FFF);
+        } else {
+            texels[i] = ((Uint32)s_coverage[i] << 24) | 0x00FFFFFFu;
+        }
+    }
+    SDL_UpdateTexture(atlas, NULL, texels, TUNE_ATLAS_SIZE * (depth == 16 ? 2 : 4));
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+
+    double busy = 0.0;
+    for (int frame = 0; frame < TUNE_WARMUP_FRAMES + TUNE_FRAMES; frame++) {
+        double start = seconds_now();
+        SDL_SetRenderTarget(renderer, target);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        for (int cell = 0; cell < TUNE_COLS * TUNE_ROWS; cell++) {
+            int x = (cell % TUNE_COLS) * TUNE_CELL_W, y = (cell / TUNE_COLS) * TUNE_CELL_H;
+            SDL_Rect dst = {x, y, TUNE_CELL_W, TUNE_CELL_H};
+            if ((cell + frame) % 8 == 0) {
+                SDL_SetRenderDrawColor(renderer, 52, 101, 164, 255);
+                SDL_RenderFillRect(renderer, &dst);
+            }
+            if (cell % 16 == 0) {
+                SDL_Color c = s_mix_colors[(cell / 16 + frame) % 4];
+                SDL_SetTextureColorMod(atlas, c.r, c.g, c.b);
+            }
+            int glyph = (cell * 7 + frame) % ((TUNE_ATLAS_SIZE / TUNE_CELL_W) * (TUNE_ATLAS_SIZE / TUNE_CELL_H));
+            SDL_Rect src = {(glyph % (TUNE_ATLAS_SIZE / TUNE_CELL_W)) * TUNE_CELL_W,
+                            (glyph / (TUNE_ATLAS_SIZE / TUNE_CELL_W)) * TUNE_CELL_H, TUNE_CELL_W, TUNE_CELL_H};
+            SDL_RenderCopy(renderer, atlas, &src, &dst);
+        }
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_RenderCopy(renderer, target, NULL, NULL);
+        Uint32 pixel;
+        SDL_Rect one = {0, 0, 1, 1};
+        SDL_RenderReadPixels(renderer, &one, SDL_PIXELFORMAT_ARGB8888, &pixel, sizeof(pixel));
+        if (frame >= TUNE_WARMUP_FRAMES) {
+            busy += seconds_now() - start;
+        }
+        SDL_RenderPresent(renderer);
+    }
+    result = busy * 1000.0 / TUNE_FRAMES;
+
+done:
+    free(texels);
+    if (target) SDL_DestroyTexture(target);
+    if (atlas) SDL_DestroyTexture(atlas);
+    return result;
+}
+
+static double time_soft_mix(SDL_Renderer* renderer, int depth, int win_w, int win_h)
+{
+    Uint32 format = depth == 16 ? SDL_PIXELFORMAT_RGB565 : SDL_PIXELFORMAT_ARGB8888;
+    SDL_Texture* texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, win_w, win_h);
+    uint32_t* frame_pixels = malloc(sizeof(uint32_t) * (size_t)win_w * win_h);
+    double result = -1.0;
+    if (!texture || !frame_pixels) {
+        goto done;
+    }
+
+    int cols = win_w / TUNE_CELL_W < TUNE_COLS ? win_w / TUNE_CELL_W : TUNE_COLS;
+    int rows = win_h / TUNE_CELL_H < TUNE_ROWS ? win_h / TUNE_CELL_H : TUNE_ROWS;
+    int pitch = win_w * (int)sizeof(uint32_t);
+    double busy = 0.0;
+    for (int frame = 0; frame < TUNE_WARMUP_FRAMES + TUNE_FRAMES; frame++) {
+        double start = seconds_now();
+        for (size_t i = 0; i < (size_t)win_w * win_h; i++) {
+            frame_pixels[i] = 0xFF000000u;
+        }
+        for (int cell = 0; cell < cols * rows; cell++) {
+            int x = (cell % cols) * TUNE_CELL_W, y = (cell / cols) * TUNE_CELL_H;
+            const uint8_t* mask = s_coverage + ((cell * 7 + frame) % (TUNE_ATLAS_SIZE / TUNE_CELL_W)) * TUNE_CELL_W;
+            SDL_Color c = s_mix_colors[(cell / 16 + frame) % 4];
+            for (int row = 0; row < TUNE_CELL_H; row++) {
+                soft_render_blend_span(frame_pixels + (size_t)(y + row) * win_w + x,
+                                       mask + (size_t)row * TUNE_ATLAS_SIZE, TUNE_CELL_W, c);
+            }
+        }
+        void* dst;
+        int dst_pitch;
+        if (depth == 32) {
+            SDL_UpdateTexture(texture, NULL, frame_pixels, pitch);
+        } else if (SDL_LockTexture(texture, NULL, &dst, &dst_pitch) == 0) {
+            SDL_ConvertPixels(win_w, win_h, SDL_PIXELFORMAT_ARGB8888, frame_pixels, pitch, format, dst, dst_pitch);
+            SDL_UnlockTexture(texture);
+        }
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+        if (frame >= TUNE_WARMUP_FRAMES) {
+            busy += seconds_now() - start;
+        }
+        SDL_RenderPresent(renderer);
+    }
+    result = busy * 1000.0 / TUNE_FRAMES;
+
+done:
+    free(frame_pixels);
+    if (texture) SDL_DestroyTexture(texture);
+    return result;
+}
+
+static Uint32 renderer_flags(const SDL_RendererInfo* info, bool vsync)
+{
+    Uint32 flags = (info->flags & SDL_RENDERER_SOFTWARE) ? SDL_RENDERER_SOFTWARE
+                                                         : SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE;
+    return vsync ? flags | SDL_RENDERER_PRESENTVSYNC : flags;
+}
+
+bool render_tune_select(SDL_Window* win, bool retune, int color_depth, RenderTuneResult* out)
+{
+    if (!win || !out) {
+        return false;
+    }
+    uint64_t device = device_id(win);
+    if (!retune && tune_load(device, color_depth, out)) {
+        DEBUG_LOG("Using tuned renderer %s, vsync %s, %d-bit", out->driver, out->vsync ? "on" : "off", out->color_depth);
+        return true;
+    }
+
+    INFO_LOG("Measuring renderer configurations for this device...");
+    fill_coverage();
+    int win_w, win_h;
+    SDL_GetWindowSize(win, &win_w, &win_h);
+
+    RenderTuneResult best = {0};
+    double best_score = 0.0;
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); i++) {
+        SDL_RendererInfo driver;
+        if (SDL_GetRenderDriverInfo(i, &driver) != 0 || !driver.name) {
+            continue;
+        }
+        bool software = (driver.flags & SDL_RENDERER_SOFTWARE) != 0;
+        for (int vsync = 0; vsync <= 1; vsync++) {
+            SDL_Renderer* renderer = SDL_CreateRenderer(win, i, renderer_flags(&driver, vsync));
+            if (!renderer) {
+                DEBUG_LOG("Renderer %s (vsync %d) unavailable: %s", driver.name, vsync, SDL_GetError());
+                continue;
+            }
+            SDL_RendererInfo info;
+            bool has_vsync = SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC);
+            if (vsync && !has_vsync) {
+                SDL_DestroyRenderer(renderer);
+                continue;
+            }
+            double ms = software ? time_soft_mix(renderer, color_depth, win_w, win_h)
+                                 : time_gpu_mix(renderer, color_depth, win_w, win_h);
+            SDL_DestroyRenderer(renderer);
+            if (ms < 0.0) {
+                continue;
+            }
+            INFO_LOG("  %-12s vsync %-3s %d-bit: %.3f ms/frame", driver.name, vsync ? "on" : "off", color_depth, ms);
+            double score = vsync ? ms / TUNE_VSYNC_SLACK : ms;
+            if (!best.driver[0] || score < best_score) {
+                snprintf(best.driver, sizeof(best.driver), "%s", driver.name);
+                best.vsync = vsync;
+                best.color_depth = color_depth;
+                best.frame_ms = ms;
+                best_score = score;
+            }
+        }
+    }
+
+    if (!best.driver[0]) {
+        WARN_LOG("No renderer could be measured; using the default order");
+        return false;
+    }
+    INFO_LOG("Fastest renderer: %s, vsync %s, %d-bit (%.3f ms/frame)",
+             best.driver, best.vsync ? "on" : "off", best.color_depth, best.frame_ms);
+    tune_save(device, &best);
+    *out = best;
+    return true;
+}
+
+SDL_Renderer* render_tune_create_renderer(SDL_Window* win, const RenderTuneResult* tune)
+{
+    for (int i = 0; i < SDL_GetNumRenderDrivers(); i++) {
+        SDL_RendererInfo driver;
+        if (SDL_GetRenderDriverInfo(i, &driver) == 0 && driver.name && strcmp(driver.name, tune->driver) == 0) {
+            return SDL_CreateRenderer(win, i, renderer_flags(&driver, tune->vsync));
+        }
+    }
+    return NULL;
+}
@@ -12,16 +12,131 @@
 #include "rendering_core.h"
 #include "terminal.h"
 #include "glyph_cache.h"
+#include "row_cache.h"
+#include "alt_screen_cache.h"
+#include "soft_render.h"
 #include "color_manager.h"
 #include "error_codes.h"
 #include "osk_renderer.h"
 #include "dirty_region_tracker.h"
+#include "perf_stats.h"
+#include "quality_governor.h"
+#include "trace.h"
+#include "input_latency.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <SDL.h>
 #include <SDL_ttf.h>
 
+// The background image, unless the quality governor dropped its blend
+static SDL_Texture* active_background(const Terminal* term)
+{
+    return quality_governor_draw_background() ? term->background_texture : NULL;
+}
+
+// The background image scaled to the window once, so damaged rows are
+// restored with a plain copy of the same rectangle instead of a scaled blend
+static SDL_Texture* scaled_background(SDL_Renderer* renderer, Terminal* term, int win_w, int win_h)
+{
+    int w = 0, h = 0;
+    if (term->background_scaled && SDL_QueryTexture(term->background_scaled, NULL, NULL, &w, &h) == 0 &&
+        w == win_w && h == win_h) {
+        return term->background_scaled;
+    }
+    if (term->background_scaled) {
+        SDL_DestroyTexture(term->background_scaled);
+        term->background_scaled = NULL;
+    }
+
+    Uint32 format = SDL_PIXELFORMAT_RGBA8888;
+    SDL_QueryTexture(term->screen_texture, &format, NULL, NULL, NULL);
+    SDL_Texture* scaled = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_TARGET, win_w, win_h);
+    if (!scaled) {
+        WARN_LOG("Failed to create %dx%d background texture: %s", win_w, win_h, SDL_GetError());
+        return NULL;
+    }
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, scaled);
+    SDL_SetRenderDrawColor(renderer, term->default_bg.r, term->default_bg.g, term->default_bg.b, 255);
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, term->background_texture, NULL, NULL);
+    SDL_SetRenderTarget(renderer, target);
+    SDL_SetTextureBlendMode(scaled, SDL_BLENDMODE_NONE);
+    term->background_scaled = scaled;
+    DEBUG_LOG("Background scaled to %dx%d", win_w, win_h);
+    return scaled;
+}
+
+// Draws one view row into the screen texture, from the row cache when the
+// same cells were drawn before. A background image shows through rows, and
+// live rows with blinking text change with the blink phase, so they are not
+// cached then.
+static void render_row(SDL_Renderer* renderer, Terminal* term, TTF_Font* font,
+                       int y, int char_w, int char_h, int win_w, uint64_t salt)
+{
+    Glyph* line = terminal_get_view_line(term, y);
+    if (!line) {
+        return;
+    }
+    bool live = term->view_offset == 0;
+    bool hide_blink = live && !term->cursor_blink_on;
+    RowCache* cache = active_background(term) || (live && terminal_get_blink_cells(term, y) > 0) ? NULL : term->row_cache;
+    SDL_Rect row_rect = {0, y * char_h, win_w, char_h};
+    uint64_t hash = 0;
+    if (cache) {
+        hash = row_cache_hash(line, term->cols, salt);
+        if (row_cache_blit(cache, renderer, hash, salt, line, term->cols, &row_rect)) {
+            perf_count_draw_call();
+            return;
+        }
+    }
+    for (int x = 0; x < term->cols; ++x) {
+        uint32_t c = hide_blink && (line[x].attributes & ATTR_BLINK) ? ' ' : line[x].character;
+        render_glyph_at(renderer, term, font, c, x, y, char_w, char_h, line[x].fg, line[x].bg, line[x].attributes);
+    }
+    if (cache) {
+        // History rows come back as the view scrolls; live rows only once seen twice
+        row_cache_capture(cache, renderer, term->screen_texture, hash, salt, line, term->cols, &row_rect, term->view_offset > 0);
+    }
+}
+
+// Redraws the blinking cells of one live row for a new blink phase. All
+// backgrounds go first, so a wide glyph is not cut by the cell after it.
+static void render_blink_cells(SDL_Renderer* renderer, Terminal* term, TTF_Font* font,
+                               int y, int char_w, int char_h, SDL_Texture* background)
+{
+    Glyph* line = terminal_get_view_line(term, y);
+    if (!line) {
+        return;
+    }
+    for (int x = 0; x < term->cols; ++x) {
+        if (!(line[x].attributes & ATTR_BLINK)) {
+            continue;
+        }
+        SDL_Rect cell = {x * char_w, y * char_h, char_w, char_h};
+        if (background) {
+            SDL_RenderCopy(renderer, background, &cell, &cell);
+        } else {
+            SDL_SetRenderDrawColor(renderer, term->default_bg.r, term->default_bg.g, term->default_bg.b, term->default_bg.a);
+            SDL_RenderFillRect(renderer, &cell);
+        }
+        perf_count_draw_call();
+    }
+    for (int x = 0; x < term->cols; ++x) {
+        if (line[x].attributes & ATTR_BLINK) {
+            uint32_t c = term->cursor_blink_on ? line[x].character : ' ';
+            render_glyph_at(renderer, term, font, c, x, y, char_w, char_h, line[x].fg, line[x].bg, line[x].attributes);
+        }
+    }
+}
+
+// Live rows with blinking text that this frame does not repaint anyway
+static bool blink_row_pending(Terminal* term, int y)
+{
+    return !(term->has_dirty_regions && term->dirty_lines[y]) && terminal_get_blink_cells(term, y) > 0;
+}
+
 void terminal_render(SDL_Renderer* renderer, Terminal* term, TTF_Font* font,
                      int char_w, int char_h, OnScreenKeyboard* osk, 
                      bool force_full_render, int win_w, int win_h, const Config* config)
@@ -32,74 +147,114 @@ void terminal_render(SDL_Renderer* renderer, Terminal* term, TTF_Font* font,
         return;
     }
 
-    bool render_background = (term->background_texture != NULL);
-    if (!force_full_render && !term->full_redraw_needed && !term->has_dirty_regions && !term->cursor_visible && !render_background) {
-        return;
+    // Creates or reloads the glyph atlas on the first frame and after font changes
+    glyph_cache_prepare(term->glyph_cache, renderer, font);
+
+    // Saves the primary screen's frame on entering the alternate screen, puts it back on leaving
+    bool restored = alt_screen_cache_render(term->alt_cache, renderer, term,
+                                            term->full_redraw_needed || force_full_render);
+    if (restored) {
+        // The saved frame may show blinking text in the other phase
+        term->blink_repaint_needed = true;
     }
-    
-    bool needs_texture_update = term->full_redraw_needed || force_full_render || term->has_dirty_regions;
+    bool blink_repaint = term->blink_repaint_needed && term->view_offset == 0;
 
-    if (needs_texture_update || render_background) {
+    bool needs_texture_update = term->full_redraw_needed || force_full_render || term->has_dirty_regions ||
+                                restored || blink_repaint;
+
+    if (needs_texture_update && soft_render_active(term->screen_texture)) {
+        // Software renderer: composite on the CPU, upload the changed rows
+        if (term->full_redraw_needed || force_full_render) {
+            soft_render_clear(term->default_bg);
+            for (int y = 0; y < term->rows; ++y) {
+                soft_render_row(term, font, y, char_w, char_h);
+            }
+        } else {
+            for (int y = 0; blink_repaint && y < term->rows; ++y) {
+                if (blink_row_pending(term, y)) {
+                    soft_render_blink_cells(term, font, y, char_w, char_h);
+                }
+            }
+            if (term->has_dirty_regions) {
+                for (int y = term->dirty_min_y; y <= term->dirty_max_y; ++y) {
+                    if (term->dirty_lines[y]) {
+                        soft_render_row(term, font, y, char_w, char_h);
+                    }
+                }
+            }
+        }
+        soft_render_flush(term->screen_texture);
+        terminal_clear_dirty_lines(term);
+        term->full_redraw_needed = false;
+        term->blink_repaint_needed = false;
+    } else if (needs_texture_update) {
         SDL_SetRenderTarget(renderer, term->screen_texture);
 
         bool force_full_repaint_this_frame = term->full_redraw_needed || force_full_render;
+        SDL_Texture* background = active_background(term) ? scaled_background(renderer, term, win_w, win_h) : NULL;
 
-        // Clear the texture on full repaint to eliminate stale content
-        if (force_full_repaint_this_frame) {
-            SDL_SetRenderDrawColor(renderer, term->default_bg.r, term->default_bg.g, term->default_bg.b, term->default_bg.a);
-            SDL_RenderClear(renderer);
+        // Row pixels also depend on the font, cell size, default background
+        // and the quality glyphs are rasterized at
+        if (!term->row_cache && !background) {
+            term->row_cache = row_cache_create();
         }
+        const uint64_t salt_fields[] = {
+            (uint64_t)(uintptr_t)term->glyph_cache, (uint64_t)char_w, (uint64_t)char_h, (uint64_t)win_w,
+            ((uint64_t)term->default_bg.r << 16) | ((uint64_t)term->default_bg.g << 8) | term->default_bg.b,
+            (uint64_t)(term->glyph_cache ? term->glyph_cache->raster_mode : 0)
+        };
+        uint64_t row_salt = row_cache_salt(salt_fields, sizeof(salt_fields) / sizeof(salt_fields[0]));
 
-        // Render background first
-        if (term->background_texture) {
-            SDL_RenderCopy(renderer, term->background_texture, NULL, NULL);
-        }
-
-        // Optimized rendering using dirty region bounds
         if (force_full_repaint_this_frame) {
-            // Full screen render — batch background first
-            if (!term->background_texture) {
+            // Replace the whole texture on full repaint to eliminate stale
+            // content: the opaque background, or a clear.
+            if (background) {
+                SDL_RenderCopy(renderer, background, NULL, NULL);
+            } else {
                 SDL_SetRenderDrawColor(renderer, term->default_bg.r, term->default_bg.g, term->default_bg.b, term->default_bg.a);
-                SDL_Rect full_bg = {0, 0, win_w, term->rows * char_h};
-                SDL_RenderFillRect(renderer, &full_bg);
+                SDL_RenderClear(renderer);
             }
+            perf_count_draw_call();
             for (int y = 0; y < term->rows; ++y) {
-                Glyph* line = terminal_get_view_line(term, y);
-                if (line) {
-                    for (int x = 0; x < term->cols; ++x) {
-                        render_glyph_at(renderer, term, font, line[x].character, x, y, char_w, char_h, line[x].fg, line[x].bg, line[x].attributes);
-                    }
-                }
+                uint64_t row_start = trace_begin();
+                render_row(renderer, term, font, y, char_w, char_h, win_w, row_salt);
+                trace_end("render_row", row_start, y);
             }
-        } else if (term->has_dirty_regions) {
-            // Batch background fill for dirty region
-            if (term->background_texture) {
-                SDL_Rect src_rect = {0, term->dirty_min_y * char_h, win_w, (term->dirty_max_y - term->dirty_min_y + 1) * char_h};
-                SDL_Rect dst_rect = {0, term->dirty_min_y * char_h, win_w, (term->dirty_max_y - term->dirty_min_y + 1) * char_h};
-                SDL_RenderCopy(renderer, term->background_texture, &src_rect, &dst_rect);
-            } else {
-                SDL_SetRenderDrawColor(renderer, term->default_bg.r, term->default_bg.g, term->default_bg.b, term->default_bg.a);
-                SDL_Rect clear_rect = {0, term->dirty_min_y * char_h, win_w, (term->dirty_max_y - term->dirty_min_y + 1) * char_h};
-                SDL_RenderFillRect(renderer, &clear_rect);
+        } else {
+            // A new blink phase touches the blinking cells only
+            for (int y = 0; blink_repaint && y < term->rows; ++y) {
+                if (blink_row_pending(term, y)) {
+                    render_blink_cells(renderer, term, font, y, char_w, char_h, background);
+                }
             }
-            
-            for (int y = term->dirty_min_y; y <= term->dirty_max_y; ++y) {
-                if (term->dirty_lines[y]) {
-                    Glyph* line = terminal_get_view_line(term, y);
-                    if (line) {
-                        for (int x = 0; x < term->cols; ++x) {
-                            render_glyph_at(renderer, term, font, line[x].character, x, y, char_w, char_h, line[x].fg, line[x].bg, line[x].attributes);
-                        }
+            if (term->has_dirty_regions) {
+                // Repaint only the damaged rows; rows in between keep their pixels
+                for (int y = term->dirty_min_y; y <= term->dirty_max_y; ++y) {
+                    if (!term->dirty_lines[y]) {
+                        continue;
                     }
+                    uint64_t row_start = trace_begin();
+                    SDL_Rect row_rect = {0, y * char_h, win_w, char_h};
+                    if (background) {
+                        SDL_RenderCopy(renderer, background, &row_rect, &row_rect);
+                    } else {
+                        SDL_SetRenderDrawColor(renderer, term->default_bg.r, term->default_bg.g, term->default_bg.b, term->default_bg.a);
+                        SDL_RenderFillRect(renderer, &row_rect);
+                    }
+                    perf_count_draw_call();
+                    render_row(renderer, term, font, y, char_w, char_h, win_w, row_salt);
+                    trace_end("render_row", row_start, y);
                 }
             }
         }
         terminal_clear_dirty_lines(term);
         term->full_redraw_needed = false;
+        term->blink_repaint_needed = false;
     }
 
     SDL_SetRenderTarget(renderer, NULL);
     SDL_RenderCopy(renderer, term->screen_texture, NULL, NULL);
+    perf_count_draw_call();
 
     if (term->view_offset == 0 && term->cursor_visible) {
         bool should_draw_cursor = !term->cursor_style_blinking || term->cursor_blink_on;
@@ -114,18 +269,21 @@ void terminal_render(SDL_Renderer* renderer, Terminal* term, TTF_Font* font,
                     term->cursor_x * char_w, term->cursor_y * char_h, char_w, char_h
                 };
                 SDL_RenderFillRect(renderer, &cursor_rect);
+                perf_count_draw_call();
                 break;
             case CURSOR_STYLE_UNDERLINE:
                 cursor_rect = (SDL_Rect) {
                     term->cursor_x * char_w, term->cursor_y * char_h + char_h - 2, char_w, 2
                 };
                 SDL_RenderFillRect(renderer, &cursor_rect);
+                perf_count_draw_call();
                 break;
             case CURSOR_STYLE_BAR:
                 cursor_rect = (SDL_Rect) {
                     term->cursor_x * char_w, term->cursor_y * char_h, 2, char_h
                 };
                 SDL_RenderFillRect(renderer, &cursor_rect);
+                perf_count_draw_call();
                 break;
             }
         }
@@ -152,11 +310,19 @@ void terminal_render(SDL_Renderer* renderer, Terminal* term, TTF_Font* font,
         SDL_Rect scrollbar_thumb = {win_w - scrollbar_w, (int)thumb_y, scrollbar_w, (int)thumb_h};
         SDL_SetRenderDrawColor(renderer, 120, 120, 120, 200);
         SDL_RenderFillRect(renderer, &scrollbar_thumb);
+        perf_count_draw_call();
+        perf_count_draw_call();
     }
 
     // Render OSK on top if active
     if (osk && osk->active) {
+        uint64_t osk_start = trace_begin();
         render_osk(renderer, font, osk, term, win_w, win_h, char_w, char_h, config);
+        trace_end("osk_render", osk_start, osk->mode);
+    }
+
+    if (perf_hud_visible()) {
+        render_perf_hud(renderer, font, win_w);
     }
 }
 
@@ -214,40 +380,115 @@ void render_glyph_at(SDL_Renderer* renderer, Terminal* term, TTF_Font* font,
                      SDL_Color fg, SDL_Color bg, unsigned char attributes)
 {
     // Only fill bg when it differs from the already-batched background.
-    // The render loop batch-fills dirty regions with default_bg, so cells
-    // with default_bg don't need an individual fill (saves 2 SDL calls each).
-    if (!term->background_texture &&
-        (bg.r != term->default_bg.r || bg.g != term->default_bg.g || bg.b != term->default_bg.b)) {
+    // The render loop batch-fills dirty regions with default_bg, or restores
+    // the background image under them, so cells with default_bg don't need
+    // an individual fill (saves 2 SDL calls each).
+    if (bg.r != term->default_bg.r || bg.g != term->default_bg.g || bg.b != term->default_bg.b) {
         SDL_Rect bg_rect = {x * char_w, y * char_h, char_w, char_h};
         SDL_SetRenderDrawColor(renderer, bg.r, bg.g, bg.b, bg.a);
         SDL_RenderFillRect(renderer, &bg_rect);
+        perf_count_draw_call();
     }
 
     // Skip rendering for non-printable control characters (NUL, ESC, etc.)
     if (c < 0x20)
         return;
 
-    // Try to get from glyph cache first
-    uint64_t cache_key = make_glyph_key(c, attributes, fg);
-    GlyphCacheEntry* entry = glyph_cache_get(term->glyph_cache, cache_key);
+    GlyphCacheEntry* entry = glyph_cache_lookup(term->glyph_cache, font, c, attributes);
+    if (!entry) {
+        return;
+    }
+
+    // Blit the white coverage tinted with the cell color. Glyphs wider
+    // than a cell (CJK, emoji) start at the cell and run into the next one.
+    int glyph_x = x * char_w + (entry->w > char_w ? 0 : (char_w - entry->w) / 2);
+    int glyph_y = y * char_h + (char_h - entry->h) / 2;
+    SDL_Rect dst_rect = {glyph_x, glyph_y, entry->w, entry->h};
+    if (!entry->color) {
+        glyph_cache_tint(term->glyph_cache, fg);
+    }
+    SDL_RenderCopy(renderer, entry->texture, &entry->src, &dst_rect);
+    perf_count_draw_call();
+}
 
-    if (entry) {
-        // Cache hit — fast path: just blit
-        int glyph_x = x * char_w + (char_w - entry->w) / 2;
-        int glyph_y = y * char_h + (char_h - entry->h) / 2;
-        SDL_Rect dst_rect = {glyph_x, glyph_y, entry->w, entry->h};
-        SDL_RenderCopy(renderer, entry->texture, NULL, &dst_rect);
+// HUD text is rasterized once per published snapshot, not every frame
+static SDL_Texture* s_hud_texture = NULL;
+static SDL_Renderer* s_hud_renderer = NULL;
+static uint32_t s_hud_generation = 0;
+static int s_hud_w = 0, s_hud_h = 0;
+#define PERF_HUD_LINES 7
+
+static void build_perf_hud(SDL_Renderer* renderer, TTF_Font* font)
+{
+    const PerfSnapshot* s = perf_snapshot();
+    char lines[PERF_HUD_LINES][96];
+    snprintf(lines[0], sizeof(lines[0]), "frame %6.2f ms  %5.1f fps", s->frame_ms, s->fps);
+    snprintf(lines[1], sizeof(lines[1]), "drain %5.2f parse %5.2f conv %5.2f",
+             s->stage_ms[PERF_STAGE_DRAIN], s->stage_ms[PERF_STAGE_PARSE], s->stage_ms[PERF_STAGE_CONVERT]);
+    snprintf(lines[2], sizeof(lines[2]), "draw  %5.2f present %5.2f",
+             s->stage_ms[PERF_STAGE_DRAW], s->stage_ms[PERF_STAGE_PRESENT]);
+    snprintf(lines[3], sizeof(lines[3]), "pty %8.1f KB/s  %5.0f draws", s->pty_bytes_per_s / 1024.0, s->draw_calls);
+    snprintf(lines[4], sizeof(lines[4]), "glyph %5.1f%% hit  %d cached", s->glyph_hit_rate * 100.0, s->glyph_entries);
+    snprintf(lines[5], sizeof(lines[5]), "scrollback %.1f KB", (double)s->scrollback_bytes / 1024.0);
+    double lat_p50, lat_p99;
+    if (input_latency_percentiles(&lat_p50, &lat_p99)) {
+        snprintf(lines[6], sizeof(lines[6]), "key->photon p50 %.0f p99 %.0f ms", lat_p50, lat_p99);
+    } else {
+        snprintf(lines[6], sizeof(lines[6]), "key->photon -");
+    }
+
+    SDL_Color color = {255, 255, 255, 255};
+    SDL_Surface* rendered[PERF_HUD_LINES] = {NULL};
+    int w = 0, h = 0;
+    for (int i = 0; i < PERF_HUD_LINES; i++) {
+        rendered[i] = TTF_RenderUTF8_Blended(font, lines[i], color);
+        if (rendered[i]) {
+            if (rendered[i]->w > w) w = rendered[i]->w;
+            h += rendered[i]->h;
+        }
+    }
+
+    const int pad = 4;
+    SDL_Surface* panel = w > 0 ? SDL_CreateRGBSurfaceWithFormat(0, w + 2 * pad, h + 2 * pad, 32, SDL_PIXELFORMAT_RGBA8888) : NULL;
+    if (panel) {
+        SDL_FillRect(panel, NULL, SDL_MapRGBA(panel->format, 0, 0, 0, 180));
+        SDL_Rect dst = {pad, pad, 0, 0};
+        for (int i = 0; i < PERF_HUD_LINES; i++) {
+            if (!rendered[i]) continue;
+            SDL_BlitSurface(rendered[i], NULL, panel, &dst);
+            dst.y += rendered[i]->h;
+        }
+        if (s_hud_texture) SDL_DestroyTexture(s_hud_texture);
+        s_hud_texture = SDL_CreateTextureFromSurface(renderer, panel);
+        s_hud_w = panel->w;
+        s_hud_h = panel->h;
+        SDL_FreeSurface(panel);
+    }
+    for (int i = 0; i < PERF_HUD_LINES; i++) {
+        if (rendered[i]) SDL_FreeSurface(rendered[i]);
+    }
+}
+
+void render_perf_hud(SDL_Renderer* renderer, TTF_Font* font, int win_w)
+{
+    if (!renderer || !font) {
         return;
     }
 
-    // Cache miss — render and cache
-    SDL_Texture* texture = NULL;
-    int texture_w = 0, texture_h = 0;
-    if (render_and_cache_glyph(renderer, font, term->glyph_cache, c, fg, bg, attributes, &texture, &texture_w, &texture_h)) {
-        int glyph_x = x * char_w + (char_w - texture_w) / 2;
-        int glyph_y = y * char_h + (char_h - texture_h) / 2;
-        SDL_Rect dst_rect = {glyph_x, glyph_y, texture_w, texture_h};
-        SDL_RenderCopy(renderer, texture, NULL, &dst_rect);
+    if (!s_hud_texture || s_hud_renderer != renderer || s_hud_generation != perf_snapshot_generation()) {
+        if (s_hud_texture && s_hud_renderer != renderer) {
+            SDL_DestroyTexture(s_hud_texture);
+            s_hud_texture = NULL;
+        }
+        build_perf_hud(renderer, font);
+        s_hud_renderer = renderer;
+        s_hud_generation = perf_snapshot_generation();
+    }
+
+    if (s_hud_texture) {
+        SDL_Rect dst = {win_w - s_hud_w - 8, 4, s_hud_w, s_hud_h};
+        SDL_RenderCopy(renderer, s_hud_texture, NULL, &dst);
+        perf_count_draw_call();
     }
 }
 
@@ -345,3 +586,13 @@ void render_credit_screen(SDL_Renderer* renderer, TTF_Font* font, int win_w, int
     y += spacing_after_separates;
     render_text(renderer, font, "by Stanley[._]?(00)?", 0, y, title_color, true, win_w);
 }
+
+size_t render_texture_bytes(SDL_Texture* texture)
+{
+    Uint32 format;
+    int w, h;
+    if (!texture || SDL_QueryTexture(texture, &format, NULL, &w, &h) != 0) {
+        return 0;
+    }
+    return (size_t)w * h * SDL_BYTESPERPIXEL(format);
+}
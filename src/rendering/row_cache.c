@@ -0,0 +1,203 @@
+/**
+ * @file row_cache.c
+ * @brief LRU of fully rendered terminal rows.
+ *
+ * A row is captured by copying its rectangle out of the screen texture
+ * into a target texture of its own. Hits are verified against the salt
+ * and a copy of the cells, so rows drawn for another font, size or
+ * background never match.
+ *
+ * @author VaixTerm Team
+ * @date 2024
+ */
+
+#include "row_cache.h"
+#include "error_codes.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint64_t hash;          // 0 = empty
+    uint64_t salt;
+    Glyph* cells;
+    int cols;
+    SDL_Texture* texture;
+    Uint32 format;          // Same as the screen texture, so 16-bit stays 16-bit
+    int w, h;
+    uint32_t last_used;
+} RowCacheEntry;
+
+struct RowCache {
+    RowCacheEntry entries[ROW_CACHE_SIZE];
+    uint64_t seen[ROW_CACHE_SEEN];
+    uint32_t clock;
+    uint32_t hits;
+    uint32_t captures;
+};
+
+RowCache* row_cache_create(void)
+{
+    RowCache* cache = calloc(1, sizeof(RowCache));
+    if (!cache) {
+        ERROR_LOG("Failed to allocate row cache");
+    }
+    return cache;
+}
+
+static void entry_release(RowCacheEntry* e)
+{
+    if (e->texture) {
+        SDL_DestroyTexture(e->texture);
+    }
+    free(e->cells);
+    memset(e, 0, sizeof(*e));
+}
+
+void row_cache_destroy(RowCache* cache)
+{
+    if (!cache) {
+        return;
+    }
+    DEBUG_LOG("Row cache: %u hits, %u captures", cache->hits, cache->captures);
+    row_cache_clear(cache);
+    free(cache);
+}
+
+void row_cache_clear(RowCache* cache)
+{
+    if (!cache) {
+        return;
+    }
+    for (int i = 0; i < ROW_CACHE_SIZE; i++) {
+        entry_release(&cache->entries[i]);
+    }
+    memset(cache->seen, 0, sizeof(cache->seen));
+}
+
+uint64_t row_cache_salt(const uint64_t* fields, size_t count)
+{
+    // FNV-1a over every byte, so no two fields can cancel each other out
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < count; i++) {
+        for (int b = 0; b < 64; b += 8) {
+            h = (h ^ ((fields[i] >> b) & 0xff)) * 0x100000001b3ULL;
+        }
+    }
+    return h;
+}
+
+uint64_t row_cache_hash(const Glyph* line, int cols, uint64_t salt)
+{
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ salt ^ (uint64_t)cols;
+    for (int x = 0; x < cols; x++) {
+        const Glyph* g = &line[x];
+        uint64_t fg = ((uint64_t)g->fg.r << 24) | ((uint64_t)g->fg.g << 16) | ((uint64_t)g->fg.b << 8) | g->fg.a;
+        uint64_t bg = ((uint64_t)g->bg.r << 24) | ((uint64_t)g->bg.g << 16) | ((uint64_t)g->bg.b << 8) | g->bg.a;
+        uint64_t v = ((uint64_t)g->character << 32) | ((uint64_t)g->attributes << 8) | g->width;
+        h = (h ^ v) * 0xff51afd7ed558ccdULL;
+        h = (h ^ ((fg << 32) | bg)) * 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 29;
+    }
+    return h ? h : 1;
+}
+
+static bool cells_equal(const Glyph* a, const Glyph* b, int cols)
+{
+    for (int x = 0; x < cols; x++) {
+        if (a[x].character != b[x].character || a[x].attributes != b[x].attributes ||
+            a[x].width != b[x].width ||
+            a[x].fg.r != b[x].fg.r || a[x].fg.g != b[x].fg.g || a[x].fg.b != b[x].fg.b || a[x].fg.a != b[x].fg.a ||
+            a[x].bg.r != b[x].bg.r || a[x].bg.g != b[x].bg.g || a[x].bg.b != b[x].bg.b || a[x].bg.a != b[x].bg.a) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool row_cache_blit(RowCache* cache, SDL_Renderer* renderer, uint64_t hash, uint64_t salt,
+                    const Glyph* line, int cols, const SDL_Rect* dst)
+{
+    if (!cache) {
+        return false;
+    }
+    for (int i = 0; i < ROW_CACHE_SIZE; i++) {
+        RowCacheEntry* e = &cache->entries[i];
+        if (e->hash != hash || e->cols != cols || e->w != dst->w || e->h != dst->h) {
+            continue;
+        }
+        if (e->salt != salt || !cells_equal(e->cells, line, cols)) {
+            return false;
+        }
+        e->last_used = ++cache->clock;
+        cache->hits++;
+        SDL_RenderCopy(renderer, e->texture, NULL, dst);
+        return true;
+    }
+    return false;
+}
+
+void row_cache_capture(RowCache* cache, SDL_Renderer* renderer, SDL_Texture* source, uint64_t hash,
+                       uint64_t salt, const Glyph* line, int cols, const SDL_Rect* rect, bool admit)
+{
+    if (!cache || rect->w <= 0 || rect->h <= 0) {
+        return;
+    }
+    if (!admit) {
+        uint64_t* seen = &cache->seen[hash % ROW_CACHE_SEEN];
+        if (*seen != hash) {
+            *seen = hash;
+            return;
+        }
+    }
+
+    // Evict the least recently used row, reusing its texture when it fits
+    RowCacheEntry* e = &cache->entries[0];
+    for (int i = 0; i < ROW_CACHE_SIZE; i++) {
+        if (cache->entries[i].hash == 0) {
+            e = &cache->entries[i];
+            break;
+        }
+        if (cache->entries[i].last_used < e->last_used) {
+            e = &cache->entries[i];
+        }
+    }
+    Uint32 format = SDL_PIXELFORMAT_RGBA8888;
+    if (SDL_QueryTexture(source, &format, NULL, NULL, NULL) != 0) {
+        return;
+    }
+    if (e->texture && (e->w != rect->w || e->h != rect->h || e->format != format)) {
+        entry_release(e);
+    }
+    if (!e->texture) {
+        e->texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_TARGET, rect->w, rect->h);
+        if (!e->texture) {
+            return;
+        }
+        SDL_SetTextureBlendMode(e->texture, SDL_BLENDMODE_NONE);
+        e->format = format;
+        e->w = rect->w;
+        e->h = rect->h;
+    }
+    if (e->cols != cols) {
+        Glyph* cells = realloc(e->cells, sizeof(Glyph) * (size_t)cols);
+        if (!cells) {
+            entry_release(e);
+            return;
+        }
+        e->cells = cells;
+        e->cols = cols;
+    }
+    memcpy(e->cells, line, sizeof(Glyph) * (size_t)cols);
+    e->hash = hash;
+    e->salt = salt;
+    e->last_used = ++cache->clock;
+
+    SDL_BlendMode mode;
+    SDL_GetTextureBlendMode(source, &mode);
+    SDL_SetTextureBlendMode(source, SDL_BLENDMODE_NONE);
+    SDL_SetRenderTarget(renderer, e->texture);
+    SDL_RenderCopy(renderer, source, rect, NULL);
+    SDL_SetRenderTarget(renderer, source);
+    SDL_SetTextureBlendMode(source, mode);
+    cache->captures++;
+}
@@ -0,0 +1,372 @@
+/**
+ * @file soft_render.c
+ * @brief CPU compositor for the terminal grid on the software renderer.
+ *
+ * Glyphs are blended from the atlas's CPU coverage (and the color page's
+ * CPU copy) into an ARGB8888 frame buffer. The mask blend has SSE2 and
+ * NEON kernels that do four pixels per step and a scalar loop that gives
+ * bit-identical results for the tail and for other targets.
+ */
+
+#include "soft_render.h"
+#include "glyph_cache.h"
+#include "terminal.h"
+#include "perf_stats.h"
+#include "error_codes.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFT_RENDER_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SOFT_RENDER_NEON 1
+#endif
+
+static struct {
+    SDL_Texture* texture;   // Not owned; identifies the screen texture we feed
+    uint32_t* pixels;       // w * h ARGB8888
+    uint8_t* dirty;         // Per pixel row, set until flushed
+    int w, h;
+    Uint32 format;          // Of the texture
+} s_soft;
+
+bool soft_render_supported(SDL_Renderer* renderer)
+{
+    SDL_RendererInfo info;
+    return renderer && SDL_GetRendererInfo(renderer, &info) == 0 && (info.flags & SDL_RENDERER_SOFTWARE);
+}
+
+SDL_Texture* soft_render_create_target(SDL_Renderer* renderer, int w, int h, Uint32 format)
+{
+    if (w <= 0 || h <= 0) {
+        return NULL;
+    }
+    SDL_Texture* texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, w, h);
+    if (!texture) {
+        WARN_LOG("Failed to create streaming screen texture: %s", SDL_GetError());
+        return NULL;
+    }
+    uint32_t* pixels = malloc((size_t)w * h * sizeof(uint32_t));
+    uint8_t* dirty = malloc((size_t)h);
+    if (!pixels || !dirty) {
+        ERROR_LOG("Failed to allocate %dx%d software frame", w, h);
+        free(pixels);
+        free(dirty);
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+    soft_render_cleanup();
+    s_soft.texture = texture;
+    s_soft.pixels = pixels;
+    s_soft.dirty = dirty;
+    s_soft.w = w;
+    s_soft.h = h;
+    s_soft.format = format;
+    memset(pixels, 0, (size_t)w * h * sizeof(uint32_t));
+    memset(dirty, 1, (size_t)h);
+    DEBUG_LOG("Compositing the grid on the CPU into a %dx%d streaming texture", w, h);
+    return texture;
+}
+
+bool soft_render_active(SDL_Texture* screen_texture)
+{
+    return screen_texture && screen_texture == s_soft.texture && s_soft.pixels;
+}
+
+static inline uint32_t pack_color(SDL_Color c)
+{
+    return 0xFF000000u | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | c.b;
+}
+
+static void fill_rect(int x, int y, int w, int h, uint32_t color)
+{
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > s_soft.w) w = s_soft.w - x;
+    if (y + h > s_soft.h) h = s_soft.h - y;
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    uint32_t* first = s_soft.pixels + (size_t)y * s_soft.w + x;
+    for (int i = 0; i < w; i++) {
+        first[i] = color;
+    }
+    for (int row = 1; row < h; row++) {
+        memcpy(first + (size_t)row * s_soft.w, first, (size_t)w * sizeof(uint32_t));
+    }
+}
+
+void soft_render_clear(SDL_Color bg)
+{
+    if (!s_soft.pixels) {
+        return;
+    }
+    fill_rect(0, 0, s_soft.w, s_soft.h, pack_color(bg));
+    memset(s_soft.dirty, 1, (size_t)s_soft.h);
+}
+
+// --- Blend kernels ---
+// Per channel: (d * (255 - a) + f * a + 128) / 255, with the division done
+// as (t + (t >> 8)) >> 8 so every path rounds the same way.
+
+static inline uint32_t blend_channel(uint32_t d, uint32_t f, uint32_t a)
+{
+    uint32_t t = d * (255 - a) + f * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+static inline uint32_t blend_pixel(uint32_t d, uint32_t f, uint32_t a)
+{
+    return 0xFF000000u |
+           (blend_channel((d >> 16) & 0xFF, (f >> 16) & 0xFF, a) << 16) |
+           (blend_channel((d >> 8) & 0xFF, (f >> 8) & 0xFF, a) << 8) |
+           blend_channel(d & 0xFF, f & 0xFF, a);
+}
+
+/**
+ * Tints an A8 coverage span with @p fg over @p dst.
+ */
+static void blend_mask_span(uint32_t* dst, const uint8_t* mask, int n, uint32_t fg, uint8_t fg_alpha)
+{
+    int i = 0;
+    if (fg_alpha == 255) {
+#if defined(SOFT_RENDER_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i v255 = _mm_set1_epi16(255);
+        const __m128i v128 = _mm_set1_epi16(128);
+        const __m128i opaque = _mm_set1_epi32((int)0xFF000000u);
+        const __m128i f16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)fg), zero);
+        for (; i + 4 <= n; i += 4) {
+            uint32_t m4;
+            memcpy(&m4, mask + i, sizeof(m4));
+            if (m4 == 0) {
+                continue;
+            }
+            __m128i m = _mm_cvtsi32_si128((int)m4);
+            m = _mm_unpacklo_epi8(m, m);
+            m = _mm_unpacklo_epi16(m, m);            // Each coverage byte repeated per channel
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+            __m128i halves[2];
+            for (int k = 0; k < 2; k++) {
+                __m128i a = k ? _mm_unpackhi_epi8(m, zero) : _mm_unpacklo_epi8(m, zero);
+                __m128i d16 = k ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+                __m128i t = _mm_add_epi16(_mm_mullo_epi16(d16, _mm_sub_epi16(v255, a)), _mm_mullo_epi16(f16, a));
+                t = _mm_add_epi16(t, v128);
+                halves[k] = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+            }
+            d = _mm_or_si128(_mm_packus_epi16(halves[0], halves[1]), opaque);
+            _mm_storeu_si128((__m128i*)(dst + i), d);
+        }
+#elif defined(SOFT_RENDER_NEON)
+        static const uint8_t spread_lo[8] = {0, 0, 0, 0, 1, 1, 1, 1};
+        static const uint8_t spread_hi[8] = {2, 2, 2, 2, 3, 3, 3, 3};
+        const uint8x8_t idx_lo = vld1_u8(spread_lo);
+        const uint8x8_t idx_hi = vld1_u8(spread_hi);
+        const uint8x16_t f = vreinterpretq_u8_u32(vdupq_n_u32(fg));
+        const uint16x8_t v128 = vdupq_n_u16(128);
+        const uint32x4_t opaque = vdupq_n_u32(0xFF000000u);
+        for (; i + 4 <= n; i += 4) {
+            uint32_t m4;
+            memcpy(&m4, mask + i, sizeof(m4));
+            if (m4 == 0) {
+                continue;
+            }
+            uint8x8_t m8 = vreinterpret_u8_u32(vdup_n_u32(m4));
+            uint8x16_t a = vcombine_u8(vtbl1_u8(m8, idx_lo), vtbl1_u8(m8, idx_hi));
+            uint8x16_t inv = vsubq_u8(vdupq_n_u8(255), a);
+            uint8x16_t d = vld1q_u8((const uint8_t*)(dst + i));
+            uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(d), vget_low_u8(inv)), vget_low_u8(f), vget_low_u8(a));
+            uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(d), vget_high_u8(inv)), vget_high_u8(f), vget_high_u8(a));
+            lo = vaddq_u16(lo, v128);
+            hi = vaddq_u16(hi, v128);
+            uint8x16_t out = vcombine_u8(vshrn_n_u16(vaddq_u16(lo, vshrq_n_u16(lo, 8)), 8),
+                                         vshrn_n_u16(vaddq_u16(hi, vshrq_n_u16(hi, 8)), 8));
+            vst1q_u32(dst + i, vorrq_u32(vreinterpretq_u32_u8(out), opaque));
+        }
+#endif
+    }
+    for (; i < n; i++) {
+        uint32_t a = mask[i];
+        if (fg_alpha != 255) {
+            a = (a * fg_alpha + 127) / 255;
+        }
+        if (a == 255) {
+            dst[i] = fg;
+        } else if (a) {
+            dst[i] = blend_pixel(dst[i], fg, a);
+        }
+    }
+}
+
+/**
+ * Blends a straight-alpha ARGB span (color glyphs) over @p dst.
+ */
+static void blend_argb_span(uint32_t* dst, const uint32_t* src, int n)
+{
+    for (int i = 0; i < n; i++) {
+        uint32_t a = src[i] >> 24;
+        if (a == 255) {
+            dst[i] = src[i];
+        } else if (a) {
+            dst[i] = blend_pixel(dst[i], src[i], a);
+        }
+    }
+}
+
+// --- Rows ---
+
+static void draw_glyph(const GlyphCache* cache, const GlyphCacheEntry* entry, int gx, int gy,
+                       int clip_y0, int clip_y1, SDL_Color fg)
+{
+    int sx = entry->src.x, sy = entry->src.y;
+    int w = entry->src.w, h = entry->src.h;
+    if (gx < 0) { sx -= gx; w += gx; gx = 0; }
+    if (gy < clip_y0) { sy += clip_y0 - gy; h -= clip_y0 - gy; gy = clip_y0; }
+    if (gx + w > s_soft.w) w = s_soft.w - gx;
+    if (gy + h > clip_y1) h = clip_y1 - gy;
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    uint32_t* dst = s_soft.pixels + (size_t)gy * s_soft.w + gx;
+    if (entry->color) {
+        if (!cache->color_pixels) {
+            return;
+        }
+        const uint32_t* src = cache->color_pixels + (size_t)sy * GLYPH_COLOR_PAGE_SIZE + sx;
+        for (int row = 0; row < h; row++) {
+            blend_argb_span(dst + (size_t)row * s_soft.w, src + (size_t)row * GLYPH_COLOR_PAGE_SIZE, w);
+        }
+        return;
+    }
+    if (!cache->atlas_alpha) {
+        return;
+    }
+    uint32_t color = pack_color(fg);
+    const uint8_t* mask = cache->atlas_alpha + (size_t)sy * cache->atlas_size + sx;
+    for (int row = 0; row < h; row++) {
+        blend_mask_span(dst + (size_t)row * s_soft.w, mask + (size_t)row * cache->atlas_size, w, color, fg.a);
+    }
+}
+
+// Draws the cells of a view row, or only its blinking cells when
+// @p blink_only is set; the rest of the row keeps its pixels then.
+static void render_cells(Terminal* term, TTF_Font* font, int y, int char_w, int char_h, bool blink_only)
+{
+    int y0 = y * char_h;
+    int y1 = y0 + char_h > s_soft.h ? s_soft.h : y0 + char_h;
+    if (!s_soft.pixels || y0 >= s_soft.h) {
+        return;
+    }
+    if (!blink_only) {
+        fill_rect(0, y0, s_soft.w, y1 - y0, pack_color(term->default_bg));
+    }
+    memset(s_soft.dirty + y0, 1, (size_t)(y1 - y0));
+
+    Glyph* line = terminal_get_view_line(term, y);
+    if (!line) {
+        return;
+    }
+    bool hide_blink = term->view_offset == 0 && !term->cursor_blink_on;
+    // Backgrounds first, so glyphs wider than a cell are not cut by the next cell
+    for (int x = 0; x < term->cols; ++x) {
+        SDL_Color bg = line[x].bg;
+        bool custom_bg = bg.r != term->default_bg.r || bg.g != term->default_bg.g || bg.b != term->default_bg.b;
+        if (blink_only) {
+            if (line[x].attributes & ATTR_BLINK) {
+                fill_rect(x * char_w, y0, char_w, y1 - y0, pack_color(custom_bg ? bg : term->default_bg));
+            }
+        } else if (custom_bg) {
+            fill_rect(x * char_w, y0, char_w, y1 - y0, pack_color(bg));
+        }
+    }
+    for (int x = 0; x < term->cols; ++x) {
+        if (line[x].character < 0x20) {
+            continue;
+        }
+        if ((line[x].attributes & ATTR_BLINK) ? hide_blink : blink_only) {
+            continue;
+        }
+        GlyphCacheEntry* entry = glyph_cache_lookup(term->glyph_cache, font, line[x].character, line[x].attributes);
+        if (!entry) {
+            continue;
+        }
+        int gx = x * char_w + (entry->w > char_w ? 0 : (char_w - entry->w) / 2);
+        int gy = y0 + (char_h - entry->h) / 2;
+        draw_glyph(term->glyph_cache, entry, gx, gy, y0, y1, line[x].fg);
+    }
+}
+
+void soft_render_row(Terminal* term, TTF_Font* font, int y, int char_w, int char_h)
+{
+    render_cells(term, font, y, char_w, char_h, false);
+}
+
+void soft_render_blink_cells(Terminal* term, TTF_Font* font, int y, int char_w, int char_h)
+{
+    render_cells(term, font, y, char_w, char_h, true);
+}
+
+void soft_render_flush(SDL_Texture* texture)
+{
+    if (!soft_render_active(texture)) {
+        return;
+    }
+    for (int y = 0; y < s_soft.h; ) {
+        if (!s_soft.dirty[y]) {
+            y++;
+            continue;
+        }
+        int start = y;
+        while (y < s_soft.h && s_soft.dirty[y]) {
+            s_soft.dirty[y++] = 0;
+        }
+        SDL_Rect rect = {0, start, s_soft.w, y - start};
+        const uint32_t* src = s_soft.pixels + (size_t)start * s_soft.w;
+        int src_pitch = s_soft.w * (int)sizeof(uint32_t);
+        void* dst;
+        int dst_pitch;
+        if (s_soft.format == SDL_PIXELFORMAT_ARGB8888) {
+            SDL_UpdateTexture(texture, &rect, src, src_pitch);
+        } else if (SDL_LockTexture(texture, &rect, &dst, &dst_pitch) == 0) {
+            SDL_ConvertPixels(rect.w, rect.h, SDL_PIXELFORMAT_ARGB8888, src, src_pitch, s_soft.format, dst, dst_pitch);
+            SDL_UnlockTexture(texture);
+        }
+        perf_count_draw_call();
+    }
+}
+
+size_t soft_render_frame_pixels(void)
+{
+    return s_soft.pixels ? (size_t)s_soft.w * s_soft.h : 0;
+}
+
+void soft_render_save(uint32_t* dst)
+{
+    if (s_soft.pixels) {
+        memcpy(dst, s_soft.pixels, (size_t)s_soft.w * s_soft.h * sizeof(uint32_t));
+    }
+}
+
+void soft_render_restore(const uint32_t* src)
+{
+    if (!s_soft.pixels) {
+        return;
+    }
+    memcpy(s_soft.pixels, src, (size_t)s_soft.w * s_soft.h * sizeof(uint32_t));
+    memset(s_soft.dirty, 1, (size_t)s_soft.h);
+}
+
+void soft_render_blend_span(uint32_t* dst, const uint8_t* mask, int n, SDL_Color fg)
+{
+    blend_mask_span(dst, mask, n, pack_color(fg), fg.a);
+}
+
+void soft_render_cleanup(void)
+{
+    free(s_soft.pixels);
+    free(s_soft.dirty);
+    memset(&s_soft, 0, sizeof(s_soft));
+}
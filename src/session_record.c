@@ -0,0 +1,285 @@
+/**
+ * @file session_record.c
+ * @brief Timestamped PTY session recording and deterministic replay.
+ *
+ * Layout (host byte order):
+ *   magic "VXRC", u32 version, i32 cols, i32 rows
+ *   events: u8 type, u64 time_us, u32 len, payload
+ *     OUTPUT/INPUT payload: len raw bytes
+ *     RESIZE payload:       i32 cols, i32 rows (len = 8)
+ *
+ * Output chunks keep the boundaries of the original read() calls so a
+ * replay splits escape sequences exactly where the live session did.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "session_record.h"
+#include "terminal.h"
+#include "terminal_libvterm.h"
+#include "input_latency.h"
+#include "error_codes.h"
+
+#define RECORD_MAGIC "VXRC"
+#define RECORD_VERSION 1
+#define REPLAY_FAST_BUDGET (64 * 1024) // Bytes fed per pump in fast mode
+
+static FILE* s_record_file = NULL;
+static uint64_t s_record_start_us = 0;
+
+static struct {
+    char* data;
+    size_t size;
+    size_t pos;
+    uint64_t start_us; // Wall clock of the first pump, 0 = not started
+} s_replay = { NULL, 0, 0, 0 };
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void record_event(SessionEventType type, const void* data, uint32_t len)
+{
+    uint8_t t = (uint8_t)type;
+    uint64_t stamp = now_us() - s_record_start_us;
+    if (fwrite(&t, sizeof(t), 1, s_record_file) != 1 ||
+        fwrite(&stamp, sizeof(stamp), 1, s_record_file) != 1 ||
+        fwrite(&len, sizeof(len), 1, s_record_file) != 1 ||
+        (len > 0 && fwrite(data, 1, len, s_record_file) != len)) {
+        ERROR_LOG("Recording write failed, stopping: %s", strerror(errno));
+        session_record_stop();
+    }
+}
+
+bool session_record_start(const char* path, int cols, int rows)
+{
+    if (!path) {
+        return false;
+    }
+    session_record_stop();
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        ERROR_LOG("Cannot create recording %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    uint32_t version = RECORD_VERSION;
+    int32_t dims[2] = { cols, rows };
+    if (fwrite(RECORD_MAGIC, 4, 1, file) != 1 ||
+        fwrite(&version, sizeof(version), 1, file) != 1 ||
+        fwrite(dims, sizeof(dims), 1, file) != 1) {
+        ERROR_LOG("Cannot write recording header to %s", path);
+        fclose(file);
+        return false;
+    }
+
+    s_record_file = file;
+    s_record_start_us = now_us();
+    INFO_LOG("Recording session to %s (%dx%d)", path, cols, rows);
+    return true;
+}
+
+void session_record_stop(void)
+{
+    if (s_record_file) {
+        fclose(s_record_file);
+        s_record_file = NULL;
+    }
+}
+
+void session_record_flush(void)
+{
+    if (s_record_file) {
+        fflush(s_record_file);
+    }
+}
+
+void session_record_output(const char* data, size_t len)
+{
+    if (s_record_file && len > 0) {
+        record_event(SESSION_EVENT_OUTPUT, data, (uint32_t)len);
+    }
+}
+
+void session_record_resize(int cols, int rows)
+{
+    if (s_record_file) {
+        int32_t dims[2] = { cols, rows };
+        record_event(SESSION_EVENT_RESIZE, dims, sizeof(dims));
+    }
+}
+
+ssize_t session_record_write(int fd, const char* data, size_t len)
+{
+    if (fd < 0) {
+        return (ssize_t)len;
+    }
+    ssize_t written = write(fd, data, len);
+    if (written > 0) {
+        input_latency_pty_write();
+    }
+    if (s_record_file && written > 0) {
+        record_event(SESSION_EVENT_INPUT, data, (uint32_t)written);
+    }
+    return written;
+}
+
+bool session_replay_open(const char* path, int* cols, int* rows)
+{
+    session_replay_close();
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        ERROR_LOG("Cannot open recording %s: %s", path, strerror(errno));
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version;
+    int32_t dims[2];
+    if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, RECORD_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(version), 1, file) != 1 || version != RECORD_VERSION ||
+        fread(dims, sizeof(dims), 1, file) != 1) {
+        ERROR_LOG("%s is not a vaixterm recording", path);
+        fclose(file);
+        return false;
+    }
+
+    long body = ftell(file);
+    fseek(file, 0, SEEK_END);
+    long end = ftell(file);
+    fseek(file, body, SEEK_SET);
+    size_t size = end > body ? (size_t)(end - body) : 0;
+
+    char* data = malloc(size ? size : 1);
+    if (!data || fread(data, 1, size, file) != size) {
+        ERROR_LOG("Cannot read recording %s", path);
+        free(data);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    s_replay.data = data;
+    s_replay.size = size;
+    s_replay.pos = 0;
+    s_replay.start_us = 0;
+    if (cols) *cols = dims[0];
+    if (rows) *rows = dims[1];
+    INFO_LOG("Replaying %s (%dx%d, %zu bytes)", path, dims[0], dims[1], size);
+    return true;
+}
+
+/* Decodes the event at s_replay.pos without consuming it. */
+static bool replay_peek(SessionEvent* event, size_t* next_pos)
+{
+    const size_t header = 1 + sizeof(uint64_t) + sizeof(uint32_t);
+    if (!s_replay.data || s_replay.size - s_replay.pos < header) {
+        return false;
+    }
+
+    const char* p = s_replay.data + s_replay.pos;
+    uint32_t len;
+    memcpy(&event->time_us, p + 1, sizeof(uint64_t));
+    memcpy(&len, p + 1 + sizeof(uint64_t), sizeof(uint32_t));
+    if (len > s_replay.size - s_replay.pos - header) {
+        WARN_LOG("Recording truncated at offset %zu", s_replay.pos);
+        return false;
+    }
+
+    event->type = (SessionEventType)(uint8_t)p[0];
+    event->data = p + header;
+    event->len = len;
+    event->cols = event->rows = 0;
+    if (event->type == SESSION_EVENT_RESIZE && len == 2 * sizeof(int32_t)) {
+        int32_t dims[2];
+        memcpy(dims, event->data, sizeof(dims));
+        event->cols = dims[0];
+        event->rows = dims[1];
+    }
+    *next_pos = s_replay.pos + header + len;
+    return true;
+}
+
+bool session_replay_next(SessionEvent* event)
+{
+    size_t next;
+    if (!replay_peek(event, &next)) {
+        return false;
+    }
+    s_replay.pos = next;
+    return true;
+}
+
+bool session_replay_active(void)
+{
+    return s_replay.data != NULL;
+}
+
+long session_replay_pump(Terminal* term, bool fast)
+{
+    if (!s_replay.data) {
+        return -1;
+    }
+
+    uint64_t now = now_us();
+    if (s_replay.start_us == 0) {
+        s_replay.start_us = now;
+    }
+
+    long fed = 0;
+    bool any = false;
+    bool exhausted = false;
+    SessionEvent ev;
+    size_t next;
+    for (;;) {
+        if (!replay_peek(&ev, &next)) {
+            exhausted = true;
+            break;
+        }
+        if (fast ? fed >= REPLAY_FAST_BUDGET : ev.time_us > now - s_replay.start_us) {
+            break;
+        }
+        s_replay.pos = next;
+        any = true;
+
+        if (ev.type == SESSION_EVENT_OUTPUT) {
+            if (term->view_offset != 0) {
+                term->view_offset = 0;
+                term->full_redraw_needed = true;
+            }
+            terminal_handle_input(term, ev.data, ev.len);
+            fed += (long)ev.len;
+        } else if (ev.type == SESSION_EVENT_RESIZE && ev.cols > 0 && ev.rows > 0) {
+            terminal_resize(term, ev.cols, ev.rows);
+            term->full_redraw_needed = true;
+        }
+    }
+
+    if (fed > 0) {
+        terminal_libvterm_flush_damage(term);
+    }
+    if (exhausted && !any) {
+        return -1;
+    }
+    return fed;
+}
+
+void session_replay_close(void)
+{
+    free(s_replay.data);
+    s_replay.data = NULL;
+    s_replay.size = 0;
+    s_replay.pos = 0;
+    s_replay.start_us = 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file session_snapshot.c
+ * @brief Binary session snapshots for instant resume.
+ *
+ * Layout (host byte order, the file never leaves the device):
+ *   magic "VXSN", u32 version
+ *   i32 view_offset
+ *   backend state (see terminal_libvterm_save_state)
+ *   OSK: u8 active, u8 mode, u8 position, i32 set_idx, i32 char_idx,
+ *        i32 char_row, u32 count, count * (u16 len, path bytes)
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <SDL.h>
+
+#include "session_snapshot.h"
+#include "terminal_libvterm.h"
+#include "osk_core.h"
+#include "osk_renderer.h"
+#include "error_codes.h"
+
+#define SNAPSHOT_MAGIC "VXSN"
+#define SNAPSHOT_VERSION 1
+
+static bool write_osk_state(FILE* file, const OnScreenKeyboard* osk)
+{
+    uint8_t flags[3] = { 0, 0, 0 };
+    int32_t idx[3] = { 0, 0, 0 };
+    uint32_t count = 0;
+    if (osk) {
+        flags[0] = osk->active;
+        flags[1] = (uint8_t)osk->mode;
+        flags[2] = (uint8_t)osk->position_mode;
+        idx[0] = osk->set_idx;
+        idx[1] = osk->char_idx;
+        idx[2] = osk->current_char_row;
+        count = (uint32_t)osk->num_loaded_key_sets;
+    }
+    if (fwrite(flags, sizeof(flags), 1, file) != 1 ||
+        fwrite(idx, sizeof(idx), 1, file) != 1 ||
+        fwrite(&count, sizeof(count), 1, file) != 1) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const char* name = osk->loaded_key_set_names[i];
+        uint16_t len = (uint16_t)strlen(name);
+        if (fwrite(&len, sizeof(len), 1, file) != 1 || fwrite(name, 1, len, file) != len) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool osk_has_loaded_set(const OnScreenKeyboard* osk, const char* path)
+{
+    for (int i = 0; i < osk->num_loaded_key_sets; i++) {
+        if (strcmp(osk->loaded_key_set_names[i], path) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool read_osk_state(FILE* file, OnScreenKeyboard* osk)
+{
+    uint8_t flags[3];
+    int32_t idx[3];
+    uint32_t count;
+    if (fread(flags, sizeof(flags), 1, file) != 1 ||
+        fread(idx, sizeof(idx), 1, file) != 1 ||
+        fread(&count, sizeof(count), 1, file) != 1) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        char path[1024];
+        uint16_t len;
+        if (fread(&len, sizeof(len), 1, file) != 1 || len >= sizeof(path) ||
+            fread(path, 1, len, file) != len) {
+            return false;
+        }
+        path[len] = '\0';
+        if (osk && !osk_has_loaded_set(osk, path)) {
+            osk_add_custom_set(osk, path);
+        }
+    }
+
+    if (osk) {
+        osk->active = flags[0] != 0;
+        osk->mode = flags[1] == OSK_MODE_SPECIAL ? OSK_MODE_SPECIAL : OSK_MODE_CHARS;
+        osk->position_mode = flags[2] == OSK_POSITION_SAME ? OSK_POSITION_SAME : OSK_POSITION_OPPOSITE;
+        osk->set_idx = (idx[0] >= 0 && idx[0] < osk->num_total_special_sets) ? idx[0] : 0;
+        osk->current_char_row = idx[2];
+        osk_validate_row_index(osk);
+        osk->char_idx = idx[1] >= 0 ? idx[1] : 0;
+        osk_invalidate_render_cache(osk);
+    }
+    return true;
+}
+
+bool session_snapshot_save(const char* path, Terminal* term, const OnScreenKeyboard* osk)
+{
+    if (!path || !term) {
+        ERROR_LOG("Invalid parameters: path=%p, term=%p", (void*)path, (void*)term);
+        return false;
+    }
+
+    Uint32 start = SDL_GetTicks();
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE* file = fopen(tmp_path, "wb");
+    if (!file) {
+        WARN_LOG("Could not write session snapshot '%s': %s", tmp_path, strerror(errno));
+        return false;
+    }
+
+    uint32_t version = SNAPSHOT_VERSION;
+    int32_t view_offset = term->view_offset;
+    bool ok = fwrite(SNAPSHOT_MAGIC, 4, 1, file) == 1 &&
+              fwrite(&version, sizeof(version), 1, file) == 1 &&
+              fwrite(&view_offset, sizeof(view_offset), 1, file) == 1 &&
+              terminal_libvterm_save_state(term, file) &&
+              write_osk_state(file, osk);
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    if (!ok || rename(tmp_path, path) != 0) {
+        WARN_LOG("Failed to save session snapshot '%s'", path);
+        remove(tmp_path);
+        return false;
+    }
+
+    INFO_LOG("Session snapshot saved to %s (%u ms)", path, SDL_GetTicks() - start);
+    return true;
+}
+
+bool session_snapshot_restore(const char* path, Terminal* term, OnScreenKeyboard* osk)
+{
+    if (!path || !term) {
+        ERROR_LOG("Invalid parameters: path=%p, term=%p", (void*)path, (void*)term);
+        return false;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        DEBUG_LOG("No session snapshot at %s", path);
+        return false;
+    }
+
+    Uint32 start = SDL_GetTicks();
+    char magic[4];
+    uint32_t version;
+    int32_t view_offset;
+    if (fread(magic, sizeof(magic), 1, file) != 1 || memcmp(magic, SNAPSHOT_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(version), 1, file) != 1 || version != SNAPSHOT_VERSION) {
+        WARN_LOG("Ignoring incompatible session snapshot: %s", path);
+        fclose(file);
+        session_snapshot_discard(path);
+        return false;
+    }
+
+    bool ok = fread(&view_offset, sizeof(view_offset), 1, file) == 1 &&
+              terminal_libvterm_load_state(term, file) &&
+              read_osk_state(file, osk);
+    fclose(file);
+
+    if (!ok) {
+        // Half a history is worse than none: start clean, and do not trip
+        // over the same file on the next launch
+        WARN_LOG("Session snapshot '%s' is corrupt, starting a fresh session", path);
+        terminal_libvterm_reset(term, true);
+        term->view_offset = 0;
+        term->full_redraw_needed = true;
+        session_snapshot_discard(path);
+        return false;
+    }
+
+    // The shell behind the snapshot is gone; start the new one on a fresh
+    // line below the restored screen instead of on top of the old prompt.
+    terminal_libvterm_feed(term, "\r\n", 2);
+    terminal_libvterm_flush_damage(term);
+
+    int sb_count = terminal_libvterm_get_scrollback_count(term);
+    term->view_offset = SDL_max(0, SDL_min(sb_count, view_offset));
+    term->full_redraw_needed = true;
+
+    INFO_LOG("Session restored from %s (%d history lines, %u ms)", path, sb_count, SDL_GetTicks() - start);
+    return true;
+}
+
+void session_snapshot_discard(const char* path)
+{
+    if (path && remove(path) == 0) {
+        DEBUG_LOG("Removed session snapshot %s", path);
+    }
+}
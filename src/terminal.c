@@ -2,8 +2,12 @@
 #include "terminal_state.h"
 #include "terminal_libvterm.h"
 #include "glyph_cache.h"
+#include "row_cache.h"
+#include "alt_screen_cache.h"
 #include "dirty_region_tracker.h"
 #include "color_manager.h"
+#include "session_record.h"
+#include "resource_bundle.h"
 #include "error_codes.h"
 #include <SDL_image.h>
 
@@ -17,11 +21,56 @@
 
 // --- Colorscheme Loading ---
 
+static void apply_theme_colors(Terminal* term, const ThemeColor* colors, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        switch (colors[i].slot) {
+        case THEME_SLOT_PALETTE:
+            if (colors[i].index < 256) {
+                term->palette[colors[i].index] = colors[i].color;
+                if (colors[i].index < 16) {
+                    term->colors[colors[i].index] = colors[i].color;
+                }
+            }
+            break;
+        case THEME_SLOT_FOREGROUND: term->default_fg = colors[i].color; break;
+        case THEME_SLOT_BACKGROUND: term->default_bg = colors[i].color; break;
+        case THEME_SLOT_CURSOR:     term->cursor_color = colors[i].color; break;
+        }
+    }
+}
+
+// A 16-bit target cannot show more; quantizing here keeps cell colors,
+// row cache keys and the screen texture in agreement.
+static void apply_color_depth(Terminal* term)
+{
+    if (term->color_depth != 16) {
+        return;
+    }
+    for (int i = 0; i < 256; i++) {
+        term->palette[i] = color_quantize_565(term->palette[i]);
+    }
+    for (int i = 0; i < 16; i++) {
+        term->colors[i] = color_quantize_565(term->colors[i]);
+    }
+    term->default_fg = color_quantize_565(term->default_fg);
+    term->default_bg = color_quantize_565(term->default_bg);
+    term->cursor_color = color_quantize_565(term->cursor_color);
+}
+
 void terminal_load_colorscheme(Terminal* term, const char* path)
 {
     VALIDATE_TERM(term);
     if (!path) return;
 
+    size_t count = 0;
+    const ThemeColor* cached = resource_bundle_load_theme(path, &count);
+    if (cached) {
+        apply_theme_colors(term, cached, count);
+        apply_color_depth(term);
+        return;
+    }
+
     FILE* file = fopen(path, "r");
     if (!file) {
         WARN_LOG("Could not open colorscheme file '%s'. Using defaults.", path);
@@ -31,6 +80,9 @@ void terminal_load_colorscheme(Terminal* term, const char* path)
     char line[256];
     char key[64];
     char value[64];
+    ThemeColor* colors = NULL;
+    size_t capacity = 0;
+    bool complete = true;
 
     while (fgets(line, sizeof(line), file)) {
         if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
@@ -38,25 +90,50 @@ void terminal_load_colorscheme(Terminal* term, const char* path)
         }
 
         if (sscanf(line, " %63[^= \t] = %63s", key, value) == 2) {
+            // Parse on top of the current value, as the in-place parse did
+            ThemeColor tc = {0};
             if (strncmp(key, "color", 5) == 0) {
                 int color_index = atoi(key + 5);
-                if (color_index >= 0 && color_index < 256) {
-                    parse_color_string(value, &term->palette[color_index]);
-                    if (color_index < 16) {
-                        term->colors[color_index] = term->palette[color_index];
-                    }
-                }
+                if (color_index < 0 || color_index >= 256) continue;
+                tc.slot = THEME_SLOT_PALETTE;
+                tc.index = (uint16_t)color_index;
+                tc.color = term->palette[color_index];
             } else if (strcmp(key, "foreground") == 0) {
-                parse_color_string(value, &term->default_fg);
+                tc.slot = THEME_SLOT_FOREGROUND;
+                tc.color = term->default_fg;
             } else if (strcmp(key, "background") == 0) {
-                parse_color_string(value, &term->default_bg);
+                tc.slot = THEME_SLOT_BACKGROUND;
+                tc.color = term->default_bg;
             } else if (strcmp(key, "cursor") == 0) {
-                parse_color_string(value, &term->cursor_color);
+                tc.slot = THEME_SLOT_CURSOR;
+                tc.color = term->cursor_color;
+            } else {
+                continue;
+            }
+            bool valid = parse_color_string(value, &tc.color);
+            apply_theme_colors(term, &tc, 1);
+            if (!valid) {
+                continue; // Only well-formed colors are precompiled
+            }
+
+            if (complete && count == capacity) {
+                capacity = capacity ? capacity * 2 : 32;
+                ThemeColor* grown = realloc(colors, capacity * sizeof(ThemeColor));
+                complete = grown != NULL;
+                if (grown) colors = grown;
+            }
+            if (complete) {
+                colors[count++] = tc;
             }
         }
     }
 
     fclose(file);
+    if (complete) {
+        resource_bundle_store_theme(path, colors, count);
+    }
+    free(colors);
+    apply_color_depth(term);
 }
 
 // --- Terminal Lifecycle ---
@@ -95,6 +172,11 @@ Terminal* terminal_create(int cols, int rows, const Config* config, SDL_Renderer
         term->cursor_color = term->default_fg;
     }
 
+    // Set after the scheme so the cursor default above compares unquantized
+    // colors; reloads quantize in terminal_load_colorscheme
+    term->color_depth = config->color_depth;
+    apply_color_depth(term);
+
     term->cols = cols;
     term->rows = rows;
     term->scrollback = config->scrollback_lines;
@@ -107,7 +189,7 @@ Terminal* terminal_create(int cols, int rows, const Config* config, SDL_Renderer
     term->last_blink_toggle_time = SDL_GetTicks();
 
     term->glyph_cache = NULL;
-    term->dirty_lines = malloc(sizeof(bool) * (size_t)rows);
+    term->dirty_lines = calloc((size_t)rows, sizeof(bool));
     if (!term->dirty_lines) {
         free(term);
         return NULL;
@@ -118,6 +200,7 @@ Terminal* terminal_create(int cols, int rows, const Config* config, SDL_Renderer
     term->full_redraw_needed = true;
 
     term->background_texture = NULL;
+    term->background_scaled = NULL;
     if (config->background_image_path) {
         term->background_texture = IMG_LoadTexture(renderer, config->background_image_path);
         if (!term->background_texture) {
@@ -149,10 +232,15 @@ void terminal_destroy(Terminal* term)
         if (term->background_texture) {
             SDL_DestroyTexture(term->background_texture);
         }
+        if (term->background_scaled) {
+            SDL_DestroyTexture(term->background_scaled);
+        }
         if (term->glyph_cache) {
             glyph_cache_cleanup(term->glyph_cache);
             free(term->glyph_cache);
         }
+        row_cache_destroy(term->row_cache);
+        alt_screen_cache_destroy(term->alt_cache);
         terminal_libvterm_free(term);
         free(term->dirty_lines);
         free(term);
@@ -174,6 +262,7 @@ void terminal_resize(Terminal* term, int new_cols, int new_rows)
     }
 
     terminal_libvterm_resize(term, new_rows, new_cols);
+    session_record_resize(new_cols, new_rows);
 }
 
 // --- Terminal Grid Operations ---
@@ -186,6 +275,21 @@ Glyph* terminal_get_view_line(Terminal* term, int y)
     return terminal_libvterm_get_view_line(term, y);
 }
 
+int terminal_get_blink_cells(Terminal* term, int y)
+{
+    return terminal_libvterm_get_blink_cells(term, y);
+}
+
+bool terminal_has_blink_text(Terminal* term)
+{
+    for (int y = 0; y < term->rows; y++) {
+        if (terminal_libvterm_get_blink_cells(term, y) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void terminal_handle_input(Terminal* term, const char* buf, size_t len)
 {
     terminal_libvterm_feed(term, buf, len);
@@ -195,3 +299,9 @@ int terminal_get_scrollback_count(Terminal* term)
 {
     return terminal_libvterm_get_scrollback_count(term);
 }
+
+bool terminal_sync_output_held(const Terminal* term, Uint32 now)
+{
+    // An application that dies mid-update must not freeze the screen
+    return term->sync_output_active && now - term->sync_output_since < SYNC_OUTPUT_TIMEOUT_MS;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file cache_file.c
+ * @brief Cache directory helpers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cache_file.h"
+#include "error_codes.h"
+
+static bool ensure_dir(const char* path)
+{
+    if (mkdir(path, 0700) == 0 || errno == EEXIST) {
+        return true;
+    }
+    DEBUG_LOG("Cannot create cache directory %s: %s", path, strerror(errno));
+    return false;
+}
+
+bool cache_file_path(const char* name, char* out, size_t out_size)
+{
+    if (!name || !out || out_size == 0) {
+        return false;
+    }
+
+    char dir[4096];
+    const char* xdg_cache = getenv("XDG_CACHE_HOME");
+    if (xdg_cache && xdg_cache[0]) {
+        snprintf(dir, sizeof(dir), "%s", xdg_cache);
+    } else {
+        const char* home = getenv("HOME");
+        if (!home || !home[0]) {
+            return false;
+        }
+        snprintf(dir, sizeof(dir), "%s/.cache", home);
+    }
+    if (!ensure_dir(dir)) {
+        return false;
+    }
+    size_t len = strlen(dir);
+    snprintf(dir + len, sizeof(dir) - len, "/vaixterm");
+    if (!ensure_dir(dir)) {
+        return false;
+    }
+
+    int n = snprintf(out, out_size, "%s/%s", dir, name);
+    return n > 0 && (size_t)n < out_size;
+}
+
+bool cache_file_write_atomic(const char* path, const void* data, size_t len)
+{
+    char tmp_path[4096];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", path, (long)getpid());
+
+    FILE* file = fopen(tmp_path, "wb");
+    if (!file) {
+        WARN_LOG("Cannot write cache file %s: %s", tmp_path, strerror(errno));
+        return false;
+    }
+    bool ok = fwrite(data, 1, len, file) == len;
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+    if (!ok || rename(tmp_path, path) != 0) {
+        WARN_LOG("Failed to write cache file %s", path);
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+const void* cache_file_map(const char* path, size_t* len)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        WARN_LOG("Cannot map cache file %s: %s", path, strerror(errno));
+        return NULL;
+    }
+    *len = (size_t)st.st_size;
+    return data;
+}
+
+void cache_file_unmap(const void* data, size_t len)
+{
+    if (data) {
+        munmap((void*)data, len);
+    }
+}
@@ -0,0 +1,168 @@
+/**
+ * @file input_latency.c
+ * @brief Keypress-to-photon latency histogram.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <SDL.h>
+
+#include "input_latency.h"
+#include "error_codes.h"
+
+#define LATENCY_TIMEOUT_MS 1000       // No echo by then: not an echoing key
+#define LATENCY_LOG_INTERVAL_MS 30000
+
+// Bucket upper bounds in ms; the last bucket is open-ended
+static const double s_bounds[] = { 4, 8, 12, 16, 20, 25, 33, 42, 50, 66, 83, 100, 150, 200, 300, 500, 1000 };
+#define LATENCY_BUCKETS (sizeof(s_bounds) / sizeof(s_bounds[0]) + 1)
+
+static struct {
+    uint64_t candidate;   // Input event not yet written to the PTY
+    uint64_t pending;     // Input written, waiting for its echo
+    bool echo_seen;
+    bool armed;           // The frame being rendered shows the echo
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint32_t samples;
+    double sum_ms;
+    double max_ms;
+    uint32_t last_logged_samples;
+    Uint32 last_log_time;
+} s_lat;
+
+static double ticks_to_ms(uint64_t ticks)
+{
+    return (double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+void input_latency_event(void)
+{
+    if (s_lat.candidate == 0) {
+        s_lat.candidate = SDL_GetPerformanceCounter();
+    }
+}
+
+void input_latency_pty_write(void)
+{
+    if (s_lat.candidate == 0) {
+        return;
+    }
+    // Keep the oldest unanswered input: typing ahead measures the first key
+    if (s_lat.pending == 0) {
+        s_lat.pending = s_lat.candidate;
+        s_lat.echo_seen = false;
+        s_lat.armed = false;
+    }
+    s_lat.candidate = 0;
+}
+
+void input_latency_pty_data(void)
+{
+    if (s_lat.pending != 0) {
+        s_lat.echo_seen = true;
+    }
+}
+
+void input_latency_frame_begin(const Terminal* term)
+{
+    if (s_lat.pending == 0 || !s_lat.echo_seen || s_lat.armed) {
+        return;
+    }
+    int y = term->cursor_y;
+    bool cursor_row_dirty = term->full_redraw_needed ||
+        (term->has_dirty_regions && y >= 0 && y < term->rows && term->dirty_lines[y]);
+    if (cursor_row_dirty) {
+        s_lat.armed = true;
+    }
+}
+
+void input_latency_frame_presented(void)
+{
+    if (!s_lat.armed) {
+        return;
+    }
+    double ms = ticks_to_ms(SDL_GetPerformanceCounter() - s_lat.pending);
+    size_t b = 0;
+    while (b < LATENCY_BUCKETS - 1 && ms > s_bounds[b]) {
+        b++;
+    }
+    s_lat.buckets[b]++;
+    s_lat.samples++;
+    s_lat.sum_ms += ms;
+    if (ms > s_lat.max_ms) s_lat.max_ms = ms;
+
+    s_lat.pending = 0;
+    s_lat.armed = false;
+    s_lat.echo_seen = false;
+}
+
+void input_latency_tick(void)
+{
+    // Inputs handled this iteration that wrote nothing (OSK navigation,
+    // scrolling) are not measured
+    s_lat.candidate = 0;
+
+    if (s_lat.pending != 0 && !s_lat.armed &&
+        ticks_to_ms(SDL_GetPerformanceCounter() - s_lat.pending) > LATENCY_TIMEOUT_MS) {
+        s_lat.pending = 0;
+        s_lat.echo_seen = false;
+    }
+
+    Uint32 now = SDL_GetTicks();
+    if (now - s_lat.last_log_time >= LATENCY_LOG_INTERVAL_MS) {
+        s_lat.last_log_time = now;
+        double p50, p99;
+        if (s_lat.samples != s_lat.last_logged_samples && input_latency_percentiles(&p50, &p99)) {
+            INFO_LOG("Input latency: n=%u p50<=%.0f ms p99<=%.0f ms mean=%.1f ms max=%.1f ms",
+                     s_lat.samples, p50, p99, s_lat.sum_ms / s_lat.samples, s_lat.max_ms);
+            s_lat.last_logged_samples = s_lat.samples;
+        }
+    }
+}
+
+static double bucket_percentile(double p)
+{
+    uint32_t target = (uint32_t)(p * s_lat.samples + 0.5);
+    if (target == 0) target = 1;
+    uint32_t seen = 0;
+    for (size_t b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += s_lat.buckets[b];
+        if (seen >= target) {
+            return b < LATENCY_BUCKETS - 1 ? s_bounds[b] : s_lat.max_ms;
+        }
+    }
+    return s_lat.max_ms;
+}
+
+bool input_latency_percentiles(double* p50_ms, double* p99_ms)
+{
+    if (s_lat.samples == 0) {
+        return false;
+    }
+    if (p50_ms) *p50_ms = bucket_percentile(0.50);
+    if (p99_ms) *p99_ms = bucket_percentile(0.99);
+    return true;
+}
+
+void input_latency_dump(void)
+{
+    if (s_lat.samples == 0) {
+        return;
+    }
+    char line[512];
+    size_t len = 0;
+    for (size_t b = 0; b < LATENCY_BUCKETS && len < sizeof(line); b++) {
+        if (s_lat.buckets[b] == 0) continue;
+        if (b < LATENCY_BUCKETS - 1) {
+            len += (size_t)snprintf(line + len, sizeof(line) - len, " <=%.0f:%u", s_bounds[b], s_lat.buckets[b]);
+        } else {
+            len += (size_t)snprintf(line + len, sizeof(line) - len, " >%.0f:%u",
+                                    s_bounds[LATENCY_BUCKETS - 2], s_lat.buckets[b]);
+        }
+    }
+    double p50, p99;
+    input_latency_percentiles(&p50, &p99);
+    INFO_LOG("Input latency histogram (ms):%s", line);
+    INFO_LOG("Input latency: n=%u p50<=%.0f ms p99<=%.0f ms mean=%.1f ms max=%.1f ms",
+             s_lat.samples, p50, p99, s_lat.sum_ms / s_lat.samples, s_lat.max_ms);
+}
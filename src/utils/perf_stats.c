@@ -0,0 +1,90 @@
+/**
+ * @file perf_stats.c
+ * @brief Frame timing windows for the performance HUD.
+ */
+
+#include <string.h>
+#include <SDL.h>
+
+#include "perf_stats.h"
+#include "glyph_cache.h"
+#include "terminal_libvterm.h"
+
+#define PERF_WINDOW_MS 1000
+
+PerfCounters g_perf;
+
+static PerfSnapshot s_snapshot;
+static uint32_t s_generation = 0;
+static uint64_t s_window_start = 0;
+static int s_last_hits = 0;
+static int s_last_misses = 0;
+static bool s_hud_visible = false;
+
+bool perf_frame_end(Terminal* term)
+{
+    uint64_t now = perf_now();
+    g_perf.frames++;
+
+    if (s_window_start == 0) {
+        s_window_start = now;
+        return false;
+    }
+
+    double freq = (double)SDL_GetPerformanceFrequency();
+    double elapsed_s = (double)(now - s_window_start) / freq;
+    if (elapsed_s * 1000.0 < PERF_WINDOW_MS) {
+        return false;
+    }
+
+    PerfSnapshot snap;
+    memset(&snap, 0, sizeof(snap));
+    double frames = g_perf.frames > 0 ? (double)g_perf.frames : 1.0;
+    for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+        snap.stage_ms[i] = (double)g_perf.stage_ticks[i] * 1000.0 / freq / frames;
+        snap.frame_ms += snap.stage_ms[i];
+    }
+    snap.fps = g_perf.frames / elapsed_s;
+    snap.pty_bytes_per_s = g_perf.pty_bytes / elapsed_s;
+    snap.draw_calls = (double)g_perf.draw_calls / frames;
+
+    if (term && term->glyph_cache) {
+        int hits = 0, misses = 0, entries = 0;
+        glyph_cache_stats(term->glyph_cache, &hits, &misses, &entries);
+        // The cache resets its counters when cleared (font or size change)
+        int dh = hits >= s_last_hits ? hits - s_last_hits : hits;
+        int dm = misses >= s_last_misses ? misses - s_last_misses : misses;
+        snap.glyph_hit_rate = dh + dm > 0 ? (double)dh / (dh + dm) : 1.0;
+        snap.glyph_entries = entries;
+        s_last_hits = hits;
+        s_last_misses = misses;
+    }
+    snap.scrollback_bytes = term ? terminal_libvterm_get_scrollback_bytes(term) : 0;
+
+    s_snapshot = snap;
+    s_generation++;
+    memset(&g_perf, 0, sizeof(g_perf));
+    s_window_start = now;
+    return true;
+}
+
+const PerfSnapshot* perf_snapshot(void)
+{
+    return &s_snapshot;
+}
+
+uint32_t perf_snapshot_generation(void)
+{
+    return s_generation;
+}
+
+bool perf_hud_toggle(void)
+{
+    s_hud_visible = !s_hud_visible;
+    return s_hud_visible;
+}
+
+bool perf_hud_visible(void)
+{
+    return s_hud_visible;
+}
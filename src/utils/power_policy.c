@@ -0,0 +1,211 @@
+/**
+ * @file power_policy.c
+ * @brief Power profile selection from sysfs battery and thermal state.
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+
+#include "power_policy.h"
+#include "error_codes.h"
+
+static const char* const s_profile_names[POWER_PROFILE_COUNT] = {
+    "ac", "battery", "low_battery", "hot"
+};
+
+static struct {
+    char* supply_path;
+    char* thermal_path;
+    int low_battery_pct;
+    int hot_temp_c;
+    PowerProfileSettings profiles[POWER_PROFILE_COUNT];
+    PowerProfile profile;
+    PowerState state;
+    Uint32 last_poll;
+} s_power;
+
+// Reads the first line of <dir>/<entry>/<file> without the newline
+static bool read_attr(const char* dir, const char* entry, const char* file, char* buf, size_t size)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s/%s", dir, entry, file);
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    bool ok = fgets(buf, (int)size, f) != NULL;
+    fclose(f);
+    if (ok) {
+        buf[strcspn(buf, "\r\n")] = '\0';
+    }
+    return ok;
+}
+
+static void read_supplies(const char* path, PowerState* out)
+{
+    DIR* dir = path ? opendir(path) : NULL;
+    if (!dir) {
+        return;
+    }
+    bool discharging = false;
+    bool charger_online = false;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') {
+            continue;
+        }
+        char type[32], value[32];
+        if (!read_attr(path, ent->d_name, "type", type, sizeof(type))) {
+            continue;
+        }
+        if (strcmp(type, "Battery") == 0) {
+            // Controller and mouse batteries report scope=Device
+            if (read_attr(path, ent->d_name, "scope", value, sizeof(value)) && strcmp(value, "Device") == 0) {
+                continue;
+            }
+            out->has_battery = true;
+            if (read_attr(path, ent->d_name, "status", value, sizeof(value)) && strcmp(value, "Discharging") == 0) {
+                discharging = true;
+            }
+            if (read_attr(path, ent->d_name, "capacity", value, sizeof(value))) {
+                int capacity = atoi(value);
+                if (out->capacity < 0 || capacity < out->capacity) {
+                    out->capacity = capacity;
+                }
+            }
+        } else if (read_attr(path, ent->d_name, "online", value, sizeof(value)) && atoi(value) == 1) {
+            // Mains, USB and the USB_* charger types
+            charger_online = true;
+        }
+    }
+    closedir(dir);
+    out->on_battery = discharging && !charger_online;
+}
+
+static void read_thermal(const char* path, PowerState* out)
+{
+    DIR* dir = path ? opendir(path) : NULL;
+    if (!dir) {
+        return;
+    }
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (strncmp(ent->d_name, "thermal_zone", 12) != 0) {
+            continue;
+        }
+        char value[32];
+        if (!read_attr(path, ent->d_name, "temp", value, sizeof(value))) {
+            continue;
+        }
+        // Millidegrees; zones without a sensor read 0 or garbage
+        long milli = strtol(value, NULL, 10);
+        if (milli <= 0 || milli > 200000) {
+            continue;
+        }
+        int temp_c = (int)(milli / 1000);
+        if (temp_c > out->temp_c) {
+            out->temp_c = temp_c;
+        }
+    }
+    closedir(dir);
+}
+
+void power_policy_read(const char* supply_path, const char* thermal_path, PowerState* out)
+{
+    out->has_battery = false;
+    out->on_battery = false;
+    out->capacity = -1;
+    out->temp_c = -1;
+    read_supplies(supply_path, out);
+    read_thermal(thermal_path, out);
+}
+
+PowerProfile power_policy_classify(const PowerState* state, int low_battery_pct, int hot_temp_c,
+                                   PowerProfile current)
+{
+    if (state->temp_c >= 0) {
+        int limit = current == POWER_PROFILE_HOT ? hot_temp_c - POWER_HOT_HYSTERESIS_C : hot_temp_c;
+        if (state->temp_c >= limit) {
+            return POWER_PROFILE_HOT;
+        }
+    }
+    if (!state->on_battery) {
+        return POWER_PROFILE_AC;
+    }
+    if (state->capacity >= 0 && state->capacity <= low_battery_pct) {
+        return POWER_PROFILE_LOW_BATTERY;
+    }
+    return POWER_PROFILE_BATTERY;
+}
+
+const char* power_profile_name(PowerProfile profile)
+{
+    return profile >= 0 && profile < POWER_PROFILE_COUNT ? s_profile_names[profile] : "unknown";
+}
+
+void power_policy_init(const Config* config)
+{
+    free(s_power.supply_path);
+    free(s_power.thermal_path);
+    s_power.supply_path = config->power_supply_path ? strdup(config->power_supply_path) : NULL;
+    s_power.thermal_path = config->thermal_path ? strdup(config->thermal_path) : NULL;
+    s_power.low_battery_pct = config->low_battery_pct;
+    s_power.hot_temp_c = config->hot_temp_c;
+    memcpy(s_power.profiles, config->power_profiles, sizeof(s_power.profiles));
+    s_power.last_poll = SDL_GetTicks();
+    power_policy_read(s_power.supply_path, s_power.thermal_path, &s_power.state);
+    s_power.profile = power_policy_classify(&s_power.state, s_power.low_battery_pct,
+                                            s_power.hot_temp_c, POWER_PROFILE_AC);
+    INFO_LOG("Power profile %s (battery %s, %d%%, %d C)", power_profile_name(s_power.profile),
+             s_power.state.has_battery ? (s_power.state.on_battery ? "discharging" : "charging") : "none",
+             s_power.state.capacity, s_power.state.temp_c);
+}
+
+bool power_policy_refresh(void)
+{
+    power_policy_read(s_power.supply_path, s_power.thermal_path, &s_power.state);
+    PowerProfile profile = power_policy_classify(&s_power.state, s_power.low_battery_pct,
+                                                 s_power.hot_temp_c, s_power.profile);
+    if (profile == s_power.profile) {
+        return false;
+    }
+    INFO_LOG("Power profile %s -> %s (battery %d%%, %d C): %d fps, blink %s, idle %d ms",
+             power_profile_name(s_power.profile), power_profile_name(profile),
+             s_power.state.capacity, s_power.state.temp_c, s_power.profiles[profile].fps,
+             s_power.profiles[profile].blink ? "on" : "off", s_power.profiles[profile].idle_ms);
+    s_power.profile = profile;
+    return true;
+}
+
+bool power_policy_poll(Uint32 now)
+{
+    if (now - s_power.last_poll < POWER_POLICY_POLL_MS) {
+        return false;
+    }
+    s_power.last_poll = now;
+    return power_policy_refresh();
+}
+
+PowerProfile power_policy_profile(void)
+{
+    return s_power.profile;
+}
+
+int power_policy_fps(int target_fps)
+{
+    int fps = s_power.profiles[s_power.profile].fps;
+    return fps > 0 && fps < target_fps ? fps : target_fps;
+}
+
+bool power_policy_blink(void)
+{
+    return s_power.profiles[s_power.profile].blink;
+}
+
+Uint32 power_policy_idle_ms(void)
+{
+    return (Uint32)s_power.profiles[s_power.profile].idle_ms;
+}
@@ -0,0 +1,594 @@
+/**
+ * @file resource_bundle.c
+ * @brief Binary bundle of parsed layouts, key sets and colorschemes.
+ *
+ * File layout (native endianness, offsets from the start of the file):
+ *   BundleHeader
+ *   BundleEntry[num_entries]
+ *   per entry: NUL-terminated source path, then 8-byte aligned data
+ *
+ * Entry data is self-contained; string offsets inside it are relative to
+ * the start of the entry data.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "resource_bundle.h"
+#include "cache_file.h"
+#include "error_codes.h"
+
+#define BUNDLE_MAGIC "VXRB"
+#define BUNDLE_FILE_NAME "resources.vxb"
+#define BUNDLE_NO_STRING UINT32_MAX
+
+typedef enum {
+    BUNDLE_KIND_LAYOUT = 1,
+    BUNDLE_KIND_KEY_SET,
+    BUNDLE_KIND_THEME
+} BundleKind;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_entries;
+    uint32_t reserved;
+} BundleHeader;
+
+typedef struct {
+    uint32_t kind;
+    uint32_t path_off;
+    uint32_t data_off;
+    uint32_t data_len;
+    int64_t mtime_ns;
+    int64_t size;
+} BundleEntry;
+
+typedef struct {
+    uint32_t display_off;
+    uint32_t sequence_off;
+    int32_t type;
+    int32_t keycode;
+    uint32_t mod;
+    int32_t command;
+} BundleKey;
+
+typedef struct {
+    uint32_t bucket;
+    int32_t active_mod_mask;
+    uint32_t first_key;
+    uint32_t num_keys;
+} BundleRow;
+
+// Layout data: {u32 num_rows, u32 num_keys} BundleRow[] BundleKey[] strings
+// Key set data: {u32 num_keys, u32 0} BundleKey[] strings
+// Theme data:   {u32 count, u32 0} ThemeColor[]
+typedef struct {
+    uint32_t count;
+    uint32_t count2;
+} BundleDataHeader;
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} ByteBuf;
+
+// Entries stored during this run. They stay allocated until close so
+// loads that hit them can borrow their strings too.
+typedef struct {
+    BundleKind kind;
+    char* path;
+    int64_t mtime_ns;
+    int64_t size;
+    ByteBuf data;
+} PendingEntry;
+
+static struct {
+    bool opened;
+    const char* map;
+    size_t map_len;
+    const BundleEntry* entries;
+    uint32_t num_entries;
+    char path[4096];
+    PendingEntry* pending;
+    int num_pending;
+    bool dirty;
+} s_bundle;
+
+// --- Byte buffer ---
+
+static bool buf_reserve(ByteBuf* b, size_t extra)
+{
+    if (b->len + extra <= b->cap) {
+        return true;
+    }
+    size_t cap = b->cap ? b->cap : 1024;
+    while (cap < b->len + extra) cap *= 2;
+    char* grown = realloc(b->data, cap);
+    if (!grown) {
+        return false;
+    }
+    b->data = grown;
+    b->cap = cap;
+    return true;
+}
+
+static bool buf_append(ByteBuf* b, const void* data, size_t len)
+{
+    if (!buf_reserve(b, len)) {
+        return false;
+    }
+    if (data) {
+        memcpy(b->data + b->len, data, len);
+    } else {
+        memset(b->data + b->len, 0, len);
+    }
+    b->len += len;
+    return true;
+}
+
+static bool buf_align(ByteBuf* b)
+{
+    size_t pad = (8 - (b->len & 7)) & 7;
+    return buf_append(b, NULL, pad);
+}
+
+static uint32_t buf_string(ByteBuf* b, const char* str)
+{
+    if (!str) {
+        return BUNDLE_NO_STRING;
+    }
+    uint32_t off = (uint32_t)b->len;
+    return buf_append(b, str, strlen(str) + 1) ? off : BUNDLE_NO_STRING;
+}
+
+// --- Source files ---
+
+static bool source_stat(const char* path, int64_t* mtime_ns, int64_t* size)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return false;
+    }
+#if defined(__APPLE__)
+    *mtime_ns = (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    *mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    *size = (int64_t)st.st_size;
+    return true;
+}
+
+// --- Mapping ---
+
+static bool map_valid(const char* map, size_t len)
+{
+    if (len < sizeof(BundleHeader)) {
+        return false;
+    }
+    const BundleHeader* header = (const BundleHeader*)map;
+    if (memcmp(header->magic, BUNDLE_MAGIC, 4) != 0 || header->version != RESOURCE_BUNDLE_VERSION) {
+        return false;
+    }
+    if (header->num_entries > (len - sizeof(BundleHeader)) / sizeof(BundleEntry)) {
+        return false;
+    }
+    const BundleEntry* entries = (const BundleEntry*)(map + sizeof(BundleHeader));
+    for (uint32_t i = 0; i < header->num_entries; i++) {
+        const BundleEntry* e = &entries[i];
+        if (e->path_off >= len || !memchr(map + e->path_off, '\0', len - e->path_off) ||
+            (e->data_off & 7) || e->data_off > len || e->data_len > len - e->data_off ||
+            e->data_len < sizeof(BundleDataHeader)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bundle_open(void)
+{
+    if (s_bundle.opened) {
+        return;
+    }
+    s_bundle.opened = true;
+    if (!cache_file_path(BUNDLE_FILE_NAME, s_bundle.path, sizeof(s_bundle.path))) {
+        s_bundle.path[0] = '\0';
+        return;
+    }
+
+    size_t len = 0;
+    const char* map = cache_file_map(s_bundle.path, &len);
+    if (!map) {
+        return;
+    }
+    if (!map_valid(map, len)) {
+        INFO_LOG("Ignoring stale resource bundle %s", s_bundle.path);
+        cache_file_unmap(map, len);
+        return;
+    }
+    s_bundle.map = map;
+    s_bundle.map_len = len;
+    s_bundle.entries = (const BundleEntry*)(map + sizeof(BundleHeader));
+    s_bundle.num_entries = ((const BundleHeader*)map)->num_entries;
+    DEBUG_LOG("Mapped resource bundle %s (%u entries, %zu bytes)", s_bundle.path, s_bundle.num_entries, len);
+}
+
+/**
+ * Finds up-to-date data for @p path, preferring entries stored this run.
+ */
+static const char* bundle_find(const char* path, BundleKind kind, uint32_t* data_len)
+{
+    bundle_open();
+
+    int64_t mtime_ns, size;
+    if (!source_stat(path, &mtime_ns, &size)) {
+        return NULL;
+    }
+
+    for (int i = s_bundle.num_pending - 1; i >= 0; i--) {
+        const PendingEntry* p = &s_bundle.pending[i];
+        if (p->kind == kind && p->mtime_ns == mtime_ns && p->size == size && strcmp(p->path, path) == 0) {
+            *data_len = (uint32_t)p->data.len;
+            return p->data.data;
+        }
+    }
+    for (uint32_t i = 0; i < s_bundle.num_entries; i++) {
+        const BundleEntry* e = &s_bundle.entries[i];
+        if (e->kind == (uint32_t)kind && e->mtime_ns == mtime_ns && e->size == size &&
+            strcmp(s_bundle.map + e->path_off, path) == 0) {
+            *data_len = e->data_len;
+            return s_bundle.map + e->data_off;
+        }
+    }
+    return NULL;
+}
+
+static void bundle_add(const char* path, BundleKind kind, ByteBuf* data)
+{
+    int64_t mtime_ns, size;
+    if (!s_bundle.path[0] || !source_stat(path, &mtime_ns, &size)) {
+        free(data->data);
+        return;
+    }
+    PendingEntry* grown = realloc(s_bundle.pending, (s_bundle.num_pending + 1) * sizeof(PendingEntry));
+    char* path_copy = strdup(path);
+    if (!grown || !path_copy) {
+        if (grown) s_bundle.pending = grown;
+        free(path_copy);
+        free(data->data);
+        return;
+    }
+    s_bundle.pending = grown;
+    s_bundle.pending[s_bundle.num_pending++] = (PendingEntry) {
+        .kind = kind, .path = path_copy, .mtime_ns = mtime_ns, .size = size, .data = *data
+    };
+    s_bundle.dirty = true;
+}
+
+// --- Keys ---
+
+static const char* data_string(const char* data, uint32_t data_len, uint32_t off)
+{
+    if (off == BUNDLE_NO_STRING || off >= data_len || !memchr(data + off, '\0', data_len - off)) {
+        return NULL;
+    }
+    return data + off;
+}
+
+/**
+ * Appends the strings of @p keys and fills their records, which the caller
+ * has reserved at @p records_off.
+ */
+static bool encode_keys(ByteBuf* b, size_t records_off, const SpecialKey* keys, int num_keys)
+{
+    for (int i = 0; i < num_keys; i++) {
+        BundleKey rec = {
+            .display_off = buf_string(b, keys[i].display_name),
+            .sequence_off = buf_string(b, keys[i].sequence),
+            .type = keys[i].type,
+            .keycode = keys[i].keycode,
+            .mod = keys[i].mod,
+            .command = keys[i].command
+        };
+        if ((keys[i].display_name && rec.display_off == BUNDLE_NO_STRING) ||
+            (keys[i].sequence && rec.sequence_off == BUNDLE_NO_STRING)) {
+            return false;
+        }
+        memcpy(b->data + records_off + (size_t)i * sizeof(BundleKey), &rec, sizeof(rec));
+    }
+    return true;
+}
+
+static void decode_key(const char* data, uint32_t data_len, const BundleKey* rec, SpecialKey* key)
+{
+    // The strings are read-only; borrowed_strings keeps them from being freed
+    key->display_name = (char*)data_string(data, data_len, rec->display_off);
+    key->sequence = (char*)data_string(data, data_len, rec->sequence_off);
+    key->type = (SpecialKeyType)rec->type;
+    key->keycode = (SDL_Keycode)rec->keycode;
+    key->mod = (SDL_Keymod)rec->mod;
+    key->command = (InternalCommand)rec->command;
+}
+
+// --- Layouts ---
+
+bool resource_bundle_load_layout(const char* path, SpecialKeySet** sets_by_modifier, int* num_rows)
+{
+    uint32_t data_len = 0;
+    const char* data = bundle_find(path, BUNDLE_KIND_LAYOUT, &data_len);
+    if (!data) {
+        return false;
+    }
+
+    const BundleDataHeader* header = (const BundleDataHeader*)data;
+    uint32_t rows_count = header->count;
+    uint32_t keys_count = header->count2;
+    size_t needed = sizeof(BundleDataHeader) + (size_t)rows_count * sizeof(BundleRow) +
+                    (size_t)keys_count * sizeof(BundleKey);
+    if (needed > data_len) {
+        return false;
+    }
+    const BundleRow* rows = (const BundleRow*)(data + sizeof(BundleDataHeader));
+    const BundleKey* keys = (const BundleKey*)(rows + rows_count);
+
+    int counts[OSK_NUM_MODIFIERS] = {0};
+    for (uint32_t r = 0; r < rows_count; r++) {
+        if (rows[r].bucket >= OSK_NUM_MODIFIERS || rows[r].first_key > keys_count ||
+            rows[r].num_keys > keys_count - rows[r].first_key) {
+            return false;
+        }
+        counts[rows[r].bucket]++;
+    }
+
+    for (int m = 0; m < OSK_NUM_MODIFIERS; m++) {
+        sets_by_modifier[m] = counts[m] ? calloc(counts[m], sizeof(SpecialKeySet)) : NULL;
+        num_rows[m] = 0;
+    }
+    for (uint32_t r = 0; r < rows_count; r++) {
+        SpecialKeySet* bucket = sets_by_modifier[rows[r].bucket];
+        if (!bucket) {
+            continue;
+        }
+        SpecialKeySet* set = &bucket[num_rows[rows[r].bucket]++];
+        set->is_dynamic = true;
+        set->active_mod_mask = rows[r].active_mod_mask;
+        set->borrowed_strings = true;
+        set->keys = malloc(rows[r].num_keys * sizeof(SpecialKey));
+        if (!set->keys) {
+            continue;
+        }
+        set->num_keys = (int)rows[r].num_keys;
+        for (uint32_t k = 0; k < rows[r].num_keys; k++) {
+            decode_key(data, data_len, &keys[rows[r].first_key + k], &set->keys[k]);
+        }
+    }
+    DEBUG_LOG("Layout %s loaded from resource bundle (%u rows)", path, rows_count);
+    return true;
+}
+
+void resource_bundle_store_layout(const char* path, SpecialKeySet* const* sets_by_modifier, const int* num_rows)
+{
+    bundle_open();
+    if (!s_bundle.path[0]) {
+        return;
+    }
+
+    BundleDataHeader header = {0};
+    for (int m = 0; m < OSK_NUM_MODIFIERS; m++) {
+        for (int r = 0; r < num_rows[m]; r++) {
+            header.count++;
+            header.count2 += (uint32_t)sets_by_modifier[m][r].num_keys;
+        }
+    }
+
+    ByteBuf b = {0};
+    bool ok = buf_append(&b, &header, sizeof(header));
+    uint32_t first_key = 0;
+    for (int m = 0; ok && m < OSK_NUM_MODIFIERS; m++) {
+        for (int r = 0; ok && r < num_rows[m]; r++) {
+            const SpecialKeySet* set = &sets_by_modifier[m][r];
+            BundleRow row = {
+                .bucket = (uint32_t)m,
+                .active_mod_mask = set->active_mod_mask,
+                .first_key = first_key,
+                .num_keys = (uint32_t)set->num_keys
+            };
+            ok = buf_append(&b, &row, sizeof(row));
+            first_key += row.num_keys;
+        }
+    }
+
+    // Keys of all rows are contiguous, then all strings
+    size_t records_off = b.len;
+    ok = ok && buf_append(&b, NULL, (size_t)header.count2 * sizeof(BundleKey));
+    for (int m = 0; ok && m < OSK_NUM_MODIFIERS; m++) {
+        for (int r = 0; ok && r < num_rows[m]; r++) {
+            const SpecialKeySet* set = &sets_by_modifier[m][r];
+            ok = encode_keys(&b, records_off, set->keys, set->num_keys);
+            records_off += (size_t)set->num_keys * sizeof(BundleKey);
+        }
+    }
+    if (!ok) {
+        free(b.data);
+        return;
+    }
+    bundle_add(path, BUNDLE_KIND_LAYOUT, &b);
+}
+
+// --- Key sets ---
+
+bool resource_bundle_load_key_set(const char* path, SpecialKeySet* set)
+{
+    uint32_t data_len = 0;
+    const char* data = bundle_find(path, BUNDLE_KIND_KEY_SET, &data_len);
+    if (!data) {
+        return false;
+    }
+
+    uint32_t num_keys = ((const BundleDataHeader*)data)->count;
+    if (num_keys == 0 || sizeof(BundleDataHeader) + (size_t)num_keys * sizeof(BundleKey) > data_len) {
+        return false;
+    }
+    SpecialKey* keys = malloc(num_keys * sizeof(SpecialKey));
+    if (!keys) {
+        return false;
+    }
+    const BundleKey* recs = (const BundleKey*)(data + sizeof(BundleDataHeader));
+    for (uint32_t i = 0; i < num_keys; i++) {
+        decode_key(data, data_len, &recs[i], &keys[i]);
+    }
+    set->keys = keys;
+    set->num_keys = (int)num_keys;
+    set->borrowed_strings = true;
+    return true;
+}
+
+void resource_bundle_store_key_set(const char* path, const SpecialKeySet* set)
+{
+    bundle_open();
+    if (!s_bundle.path[0] || !set->keys || set->num_keys <= 0) {
+        return;
+    }
+
+    BundleDataHeader header = { .count = (uint32_t)set->num_keys };
+    ByteBuf b = {0};
+    if (!buf_append(&b, &header, sizeof(header)) ||
+        !buf_append(&b, NULL, (size_t)set->num_keys * sizeof(BundleKey)) ||
+        !encode_keys(&b, sizeof(header), set->keys, set->num_keys)) {
+        free(b.data);
+        return;
+    }
+    bundle_add(path, BUNDLE_KIND_KEY_SET, &b);
+}
+
+// --- Themes ---
+
+const ThemeColor* resource_bundle_load_theme(const char* path, size_t* count)
+{
+    uint32_t data_len = 0;
+    const char* data = bundle_find(path, BUNDLE_KIND_THEME, &data_len);
+    if (!data) {
+        return NULL;
+    }
+    uint32_t n = ((const BundleDataHeader*)data)->count;
+    if (sizeof(BundleDataHeader) + (size_t)n * sizeof(ThemeColor) > data_len) {
+        return NULL;
+    }
+    *count = n;
+    return (const ThemeColor*)(data + sizeof(BundleDataHeader));
+}
+
+void resource_bundle_store_theme(const char* path, const ThemeColor* colors, size_t count)
+{
+    bundle_open();
+    if (!s_bundle.path[0]) {
+        return;
+    }
+
+    BundleDataHeader header = { .count = (uint32_t)count };
+    ByteBuf b = {0};
+    if (!buf_append(&b, &header, sizeof(header)) || !buf_append(&b, colors, count * sizeof(ThemeColor))) {
+        free(b.data);
+        return;
+    }
+    bundle_add(path, BUNDLE_KIND_THEME, &b);
+}
+
+// --- Writing ---
+
+static bool superseded(const BundleEntry* e)
+{
+    const char* path = s_bundle.map + e->path_off;
+    for (int i = 0; i < s_bundle.num_pending; i++) {
+        if ((uint32_t)s_bundle.pending[i].kind == e->kind && strcmp(s_bundle.pending[i].path, path) == 0) {
+            return true;
+        }
+    }
+    // Drop entries whose source changed or went away
+    int64_t mtime_ns, size;
+    return !source_stat(path, &mtime_ns, &size) || mtime_ns != e->mtime_ns || size != e->size;
+}
+
+void resource_bundle_commit(void)
+{
+    if (!s_bundle.dirty || !s_bundle.path[0]) {
+        return;
+    }
+
+    // Collect the surviving entries: kept old ones first, then this run's
+    // (last store wins, so skip pending entries replaced by a later one)
+    uint32_t max_entries = s_bundle.num_entries + (uint32_t)s_bundle.num_pending;
+    BundleEntry* dir = calloc(max_entries ? max_entries : 1, sizeof(BundleEntry));
+    const char** paths = calloc(max_entries ? max_entries : 1, sizeof(char*));
+    const char** datas = calloc(max_entries ? max_entries : 1, sizeof(char*));
+    if (!dir || !paths || !datas) {
+        free(dir); free(paths); free(datas);
+        return;
+    }
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < s_bundle.num_entries; i++) {
+        const BundleEntry* e = &s_bundle.entries[i];
+        if (superseded(e)) {
+            continue;
+        }
+        dir[n] = *e;
+        paths[n] = s_bundle.map + e->path_off;
+        datas[n] = s_bundle.map + e->data_off;
+        n++;
+    }
+    for (int i = 0; i < s_bundle.num_pending; i++) {
+        const PendingEntry* p = &s_bundle.pending[i];
+        bool replaced = false;
+        for (int j = i + 1; j < s_bundle.num_pending && !replaced; j++) {
+            replaced = s_bundle.pending[j].kind == p->kind && strcmp(s_bundle.pending[j].path, p->path) == 0;
+        }
+        if (replaced) {
+            continue;
+        }
+        dir[n] = (BundleEntry) {
+            .kind = p->kind, .mtime_ns = p->mtime_ns, .size = p->size, .data_len = (uint32_t)p->data.len
+        };
+        paths[n] = p->path;
+        datas[n] = p->data.data;
+        n++;
+    }
+
+    BundleHeader header = { .version = RESOURCE_BUNDLE_VERSION, .num_entries = n };
+    memcpy(header.magic, BUNDLE_MAGIC, 4);
+
+    ByteBuf b = {0};
+    bool ok = buf_append(&b, &header, sizeof(header)) && buf_append(&b, NULL, n * sizeof(BundleEntry));
+    for (uint32_t i = 0; ok && i < n; i++) {
+        dir[i].path_off = buf_string(&b, paths[i]);
+        ok = dir[i].path_off != BUNDLE_NO_STRING && buf_align(&b);
+        dir[i].data_off = (uint32_t)b.len;
+        ok = ok && buf_append(&b, datas[i], dir[i].data_len);
+    }
+    if (ok) {
+        memcpy(b.data + sizeof(header), dir, n * sizeof(BundleEntry));
+        if (cache_file_write_atomic(s_bundle.path, b.data, b.len)) {
+            DEBUG_LOG("Wrote resource bundle %s (%u entries, %zu bytes)", s_bundle.path, n, b.len);
+            s_bundle.dirty = false;
+        }
+    }
+    free(b.data);
+    free(dir);
+    free(paths);
+    free(datas);
+}
+
+void resource_bundle_close(void)
+{
+    resource_bundle_commit();
+    for (int i = 0; i < s_bundle.num_pending; i++) {
+        free(s_bundle.pending[i].path);
+        free(s_bundle.pending[i].data.data);
+    }
+    free(s_bundle.pending);
+    cache_file_unmap(s_bundle.map, s_bundle.map_len);
+    memset(&s_bundle, 0, sizeof(s_bundle));
+}
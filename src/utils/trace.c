@@ -0,0 +1,209 @@
+/**
+ * @file trace.c
+ * @brief Per-thread trace rings and Chrome trace JSON export.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+
+#include "trace.h"
+#include "error_codes.h"
+
+#define TRACE_MAX_THREADS 8
+
+typedef struct {
+    const char* name;
+    uint64_t start_us;
+    uint32_t dur_us;    // UINT32_MAX marks an instant event
+    int32_t arg;
+} TraceEvent;
+
+typedef struct {
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+    uint64_t count;     // Total recorded; the ring holds the last TRACE_BUFFER_EVENTS
+    int tid;
+} TraceBuffer;
+
+bool g_trace_enabled = false;
+
+static char* s_trace_path = NULL;
+static uint64_t s_trace_origin_us = 0;
+static TraceBuffer* s_buffers[TRACE_MAX_THREADS];
+static int s_num_buffers = 0;
+static _Thread_local TraceBuffer* t_buffer = NULL;
+static volatile sig_atomic_t s_dump_requested = 0;
+
+static uint64_t trace_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void on_sigusr1(int sig)
+{
+    (void)sig;
+    s_dump_requested = 1;
+}
+
+// Registration is the only shared write; it happens once per thread.
+static TraceBuffer* thread_buffer(void)
+{
+    if (t_buffer) {
+        return t_buffer;
+    }
+    int slot = __atomic_fetch_add(&s_num_buffers, 1, __ATOMIC_RELAXED);
+    if (slot >= TRACE_MAX_THREADS) {
+        return NULL;
+    }
+    TraceBuffer* buf = calloc(1, sizeof(TraceBuffer));
+    if (!buf) {
+        return NULL;
+    }
+    buf->tid = slot + 1;
+    __atomic_store_n(&s_buffers[slot], buf, __ATOMIC_RELEASE);
+    t_buffer = buf;
+    return buf;
+}
+
+static void record(const char* name, uint64_t start, uint32_t dur, int64_t arg)
+{
+    TraceBuffer* buf = thread_buffer();
+    if (!buf) {
+        return;
+    }
+    TraceEvent* ev = &buf->events[buf->count % TRACE_BUFFER_EVENTS];
+    ev->name = name;
+    ev->start_us = start;
+    ev->dur_us = dur;
+    ev->arg = (int32_t)arg;
+    __atomic_store_n(&buf->count, buf->count + 1, __ATOMIC_RELEASE);
+}
+
+bool trace_start(const char* path)
+{
+    if (!path) {
+        return false;
+    }
+    free(s_trace_path);
+    s_trace_path = strdup(path);
+    if (!s_trace_path) {
+        return false;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigusr1;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR1, &sa, NULL) != 0) {
+        WARN_LOG("Cannot install SIGUSR1 trace dump: %s", strerror(errno));
+    }
+
+    s_trace_origin_us = trace_now_us();
+    g_trace_enabled = true;
+    INFO_LOG("Tracing to %s (SIGUSR1 writes a snapshot)", path);
+    return true;
+}
+
+static bool trace_write(void)
+{
+    char tmp_path[1024];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", s_trace_path);
+    FILE* file = fopen(tmp_path, "w");
+    if (!file) {
+        ERROR_LOG("Cannot write trace %s: %s", tmp_path, strerror(errno));
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"vaixterm\"}}");
+
+    int num = __atomic_load_n(&s_num_buffers, __ATOMIC_RELAXED);
+    if (num > TRACE_MAX_THREADS) num = TRACE_MAX_THREADS;
+    size_t written = 0;
+    for (int b = 0; b < num; b++) {
+        TraceBuffer* buf = __atomic_load_n(&s_buffers[b], __ATOMIC_ACQUIRE);
+        if (!buf) continue;
+        uint64_t count = __atomic_load_n(&buf->count, __ATOMIC_ACQUIRE);
+        uint64_t first = count > TRACE_BUFFER_EVENTS ? count - TRACE_BUFFER_EVENTS : 0;
+        for (uint64_t i = first; i < count; i++) {
+            const TraceEvent* ev = &buf->events[i % TRACE_BUFFER_EVENTS];
+            uint64_t ts = ev->start_us - s_trace_origin_us;
+            if (ev->dur_us == UINT32_MAX) {
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu,\"pid\":1,\"tid\":%d,\"args\":{\"v\":%d}}",
+                        ev->name, (unsigned long long)ts, buf->tid, ev->arg);
+            } else {
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,\"pid\":1,\"tid\":%d,\"args\":{\"v\":%d}}",
+                        ev->name, (unsigned long long)ts, ev->dur_us, buf->tid, ev->arg);
+            }
+            written++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = fclose(file) == 0;
+    if (ok && rename(tmp_path, s_trace_path) != 0) {
+        ERROR_LOG("Cannot move trace into place: %s", strerror(errno));
+        ok = false;
+    }
+    if (ok) {
+        INFO_LOG("Wrote %zu trace events to %s", written, s_trace_path);
+    }
+    return ok;
+}
+
+void trace_stop(void)
+{
+    if (!g_trace_enabled) {
+        return;
+    }
+    g_trace_enabled = false;
+    trace_write();
+    signal(SIGUSR1, SIG_DFL);
+
+    int num = __atomic_load_n(&s_num_buffers, __ATOMIC_RELAXED);
+    if (num > TRACE_MAX_THREADS) num = TRACE_MAX_THREADS;
+    for (int b = 0; b < num; b++) {
+        free(s_buffers[b]);
+        s_buffers[b] = NULL;
+    }
+    s_num_buffers = 0;
+    t_buffer = NULL;
+    free(s_trace_path);
+    s_trace_path = NULL;
+}
+
+void trace_poll(void)
+{
+    if (s_dump_requested && g_trace_enabled) {
+        s_dump_requested = 0;
+        trace_write();
+    }
+}
+
+uint64_t trace_begin(void)
+{
+    return g_trace_enabled ? trace_now_us() : 0;
+}
+
+void trace_end(const char* name, uint64_t start, int64_t arg)
+{
+    if (!g_trace_enabled || start == 0) {
+        return;
+    }
+    uint64_t dur = trace_now_us() - start;
+    record(name, start, dur >= UINT32_MAX ? UINT32_MAX - 1 : (uint32_t)dur, arg);
+}
+
+void trace_instant(const char* name, int64_t arg)
+{
+    if (g_trace_enabled) {
+        record(name, trace_now_us(), UINT32_MAX, arg);
+    }
+}
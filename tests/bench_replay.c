@@ -0,0 +1,581 @@
+/**
+ * Headless replay benchmark.
+ *
+ * Feeds terminal byte streams through the real parse (terminal_libvterm_feed)
+ * and render (terminal_render) paths using SDL's dummy video driver and the
+ * software renderer (so the CPU compositor in soft_render.c), then prints one
+ * JSON object per workload:
+ *
+ *   {"name": ..., "bytes": ..., "frames": ..., "parse_mb_s": ..., "fps": ...,
+ *    "frame_ms_p50": ..., "frame_ms_p99": ..., "parse_ms": ..., "render_ms": ...,
+ *    "glyph_hit_rate": ..., "glyph_entries": ..., "present_ms": ...,
+ *    "texture_kb": ..., "peak_rss_kb": ...}
+ *
+ * Without --stream/--replay the built-in synthetic workloads are used (flood,
+ * ls_color, vim_redraw, htop, cjk, braille). They are generated from a fixed
+ * seed so numbers are comparable between runs. --replay takes a recording
+ * made with `vaixterm --record` and renders one frame per recorded 16 ms.
+ *
+ * Build/run: make bench
+ * Usage: bench_replay [--font path] [--size pt] [--bitmap-font path] [--frames n]
+ *                     [--color-depth 16|32] [--stream file]... [--replay file]...
+ *
+ * A frame is everything the main loop does for it: feeding its bytes to
+ * vterm, rendering and presenting. fps and frame_ms_p50/p99 are whole-frame
+ * numbers; parse_ms and render_ms split the mean frame into the vterm feed
+ * and the render plus present. texture_kb is the screen texture plus the
+ * glyph atlas, so runs at both color depths compare memory; present_ms is
+ * the mean SDL_RenderPresent time.
+ *
+ * Each workload runs in its own child process, so peak_rss_kb is that
+ * workload's peak alone. Persistent caches (glyph atlas, fallback coverage)
+ * go to a temporary XDG_CACHE_HOME that is removed on exit: runs start cold
+ * and never touch the user's cache.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "terminal_state.h"
+#include "terminal.h"
+#include "terminal_libvterm.h"
+#include "config_manager.h"
+#include "app_lifecycle.h"
+#include "rendering_core.h"
+#include "glyph_cache.h"
+#include "font_manager.h"
+#include "soft_render.h"
+#include "session_record.h"
+
+#define BENCH_WIN_W 640
+#define BENCH_WIN_H 480
+#define BENCH_FEED_CHUNK 4096
+#define BENCH_DEFAULT_FRAMES 300
+
+/* ===================== Growable byte buffer ===================== */
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} Buf;
+
+static void buf_put(Buf* b, const char* s, size_t n)
+{
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : 4096;
+        while (cap < b->len + n) cap *= 2;
+        char* p = realloc(b->data, cap);
+        if (!p) {
+            fprintf(stderr, "bench: out of memory\n");
+            exit(1);
+        }
+        b->data = p;
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+}
+
+static void buf_str(Buf* b, const char* s)
+{
+    buf_put(b, s, strlen(s));
+}
+
+static void buf_fmt(Buf* b, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void buf_fmt(Buf* b, const char* fmt, ...)
+{
+    char tmp[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    if (n > 0) buf_put(b, tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+}
+
+static void buf_utf8(Buf* b, uint32_t c)
+{
+    char s[4];
+    size_t n;
+    if (c < 0x80) { s[0] = (char)c; n = 1; }
+    else if (c < 0x800) { s[0] = (char)(0xC0 | (c >> 6)); s[1] = (char)(0x80 | (c & 0x3F)); n = 2; }
+    else if (c < 0x10000) {
+        s[0] = (char)(0xE0 | (c >> 12)); s[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        s[2] = (char)(0x80 | (c & 0x3F)); n = 3;
+    } else {
+        s[0] = (char)(0xF0 | (c >> 18)); s[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+        s[2] = (char)(0x80 | ((c >> 6) & 0x3F)); s[3] = (char)(0x80 | (c & 0x3F)); n = 4;
+    }
+    buf_put(b, s, n);
+}
+
+/* Deterministic LCG so every run generates identical streams */
+static uint32_t s_rng = 0x9E3779B9u;
+static uint32_t rnd(uint32_t n)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return (s_rng >> 8) % n;
+}
+
+/* ===================== Synthetic workloads ===================== */
+
+/* Each generator appends one frame's worth of output. */
+typedef void (*FrameGen)(Buf* b, int frame, int cols, int rows);
+
+static void gen_flood(Buf* b, int frame, int cols, int rows)
+{
+    (void)frame;
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols - 1; x++) {
+            char c = (char)(' ' + 1 + rnd(94));
+            buf_put(b, &c, 1);
+        }
+        buf_str(b, "\r\n");
+    }
+}
+
+static void gen_ls_color(Buf* b, int frame, int cols, int rows)
+{
+    static const char* kinds[] = { "\033[0m", "\033[01;34m", "\033[01;32m", "\033[01;36m", "\033[40;33;01m" };
+    (void)rows;
+    for (int i = 0; i < 8; i++) {
+        int x = 0;
+        while (x + 16 < cols) {
+            buf_str(b, kinds[rnd(5)]);
+            int len = 4 + (int)rnd(10);
+            for (int k = 0; k < len; k++) {
+                char c = (char)('a' + rnd(26));
+                buf_put(b, &c, 1);
+            }
+            buf_fmt(b, "_%d\033[0m  ", frame % 100);
+            x += len + 5;
+        }
+        buf_str(b, "\r\n");
+    }
+}
+
+static void gen_vim_redraw(Buf* b, int frame, int cols, int rows)
+{
+    if (frame == 0) buf_str(b, "\033[?1049h\033[H\033[2J");
+    // Full-screen repaint with line numbers, syntax colors and a status line
+    for (int y = 1; y < rows; y++) {
+        buf_fmt(b, "\033[%d;1H\033[33m%4d \033[0m", y, y + frame);
+        int x = 5;
+        while (x < cols - 12) {
+            static const char* syn[] = { "\033[35m", "\033[32m", "\033[36m", "\033[0m", "\033[1;34m" };
+            buf_str(b, syn[rnd(5)]);
+            int len = 2 + (int)rnd(8);
+            for (int k = 0; k < len; k++) {
+                char c = (char)('a' + rnd(26));
+                buf_put(b, &c, 1);
+            }
+            buf_str(b, " ");
+            x += len + 1;
+        }
+        buf_str(b, "\033[0m\033[K");
+    }
+    buf_fmt(b, "\033[%d;1H\033[7m -- INSERT -- %d,%d \033[K\033[0m", rows, frame % rows + 1, frame % cols + 1);
+    buf_fmt(b, "\033[%d;%dH", frame % (rows - 1) + 1, frame % (cols - 6) + 6);
+}
+
+static void gen_htop(Buf* b, int frame, int cols, int rows)
+{
+    if (frame == 0) buf_str(b, "\033[?1049h\033[2J");
+    int bar_w = cols / 2 - 10;
+    for (int cpu = 0; cpu < 4; cpu++) {
+        int used = (int)rnd((uint32_t)bar_w);
+        buf_fmt(b, "\033[%d;1H\033[0m%3d\033[1m[\033[32m", cpu + 1, cpu);
+        for (int i = 0; i < bar_w; i++) buf_str(b, i < used ? "|" : " ");
+        buf_fmt(b, "\033[0m\033[1m%5.1f%%]\033[0m", used * 100.0 / bar_w);
+    }
+    buf_fmt(b, "\033[6;1H\033[30;42m  PID USER      PRI  NI  VIRT   RES S CPU%% MEM%%  Command\033[K\033[0m");
+    for (int y = 7; y <= rows; y++) {
+        if (y == 7 + frame % (rows - 7)) buf_str(b, "\033[30;46m");
+        buf_fmt(b, "\033[%d;1H%5d root       20   0 %5uM %5uM S %4.1f %4.1f  /usr/bin/proc%d\033[K\033[0m",
+                y, 1000 + y, rnd(900), rnd(400), rnd(1000) / 10.0, rnd(1000) / 10.0, y);
+    }
+}
+
+static void gen_cjk(Buf* b, int frame, int cols, int rows)
+{
+    (void)frame;
+    for (int y = 0; y < rows / 2; y++) {
+        for (int x = 0; x + 2 < cols; x += 2) {
+            buf_utf8(b, 0x4E00 + rnd(0x5000)); // CJK unified ideographs
+        }
+        buf_str(b, "\r\n");
+    }
+}
+
+static void gen_braille(Buf* b, int frame, int cols, int rows)
+{
+    if (frame == 0) buf_str(b, "\033[2J");
+    // Scrolling braille sparkline, redrawn in place like btop/gping
+    for (int y = 0; y < rows; y++) {
+        buf_fmt(b, "\033[%d;1H\033[3%dm", y + 1, 1 + (y % 6));
+        for (int x = 0; x < cols; x++) {
+            buf_utf8(b, 0x2800 + ((x + y + frame) * 37 % 256));
+        }
+    }
+    buf_str(b, "\033[0m");
+}
+
+typedef struct {
+    const char* name;
+    FrameGen gen;
+} Workload;
+
+static const Workload s_workloads[] = {
+    { "flood",      gen_flood },
+    { "ls_color",   gen_ls_color },
+    { "vim_redraw", gen_vim_redraw },
+    { "htop",       gen_htop },
+    { "cjk",        gen_cjk },
+    { "braille",    gen_braille },
+};
+
+/* ===================== Measurement ===================== */
+
+typedef struct {
+    SDL_Renderer* renderer;
+    TTF_Font* font;
+    Config* config;
+    int char_w, char_h;
+} BenchCtx;
+
+static int cmp_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(double* sorted, int n, double p)
+{
+    if (n <= 0) return 0.0;
+    int idx = (int)(p * (n - 1) + 0.5);
+    return sorted[idx];
+}
+
+static double now_ms(void)
+{
+    return (double)SDL_GetPerformanceCounter() * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+/**
+ * Runs one workload. frames[i] holds the byte range fed before frame i is
+ * rendered; a frame is rendered after each range exactly as the main loop
+ * renders after each PTY drain.
+ */
+static void bench_run(BenchCtx* ctx, const char* name, const char* data, const size_t* frame_ends, int nframes)
+{
+    Terminal* term = app_init_terminal(ctx->config, ctx->renderer, ctx->char_w, ctx->char_h);
+    if (!term) {
+        fprintf(stderr, "bench: failed to create terminal for %s\n", name);
+        return;
+    }
+
+    double* frame_ms = calloc((size_t)nframes, sizeof(double));
+    double parse_ms = 0.0;
+    double render_total_ms = 0.0;
+    double present_total_ms = 0.0;
+    size_t pos = 0;
+    char drain[4096];
+
+    for (int f = 0; f < nframes; f++) {
+        double t0 = now_ms();
+        while (pos < frame_ends[f]) {
+            size_t n = frame_ends[f] - pos;
+            if (n > BENCH_FEED_CHUNK) n = BENCH_FEED_CHUNK;
+            terminal_libvterm_feed(term, data + pos, n);
+            pos += n;
+        }
+        terminal_libvterm_flush_damage(term);
+        while (terminal_libvterm_flush_output(term, drain, sizeof(drain)) > 0) {
+            // Discard replies (DA, DSR) the child would have received
+        }
+        double t1 = now_ms();
+
+        terminal_render(ctx->renderer, term, ctx->font, ctx->char_w, ctx->char_h, NULL,
+                        false, ctx->config->win_w, ctx->config->win_h, ctx->config);
+        double t_present = now_ms();
+        SDL_RenderPresent(ctx->renderer);
+        double t2 = now_ms();
+        present_total_ms += t2 - t_present;
+
+        parse_ms += t1 - t0;
+        if (frame_ms) frame_ms[f] = t2 - t0;
+        render_total_ms += t2 - t1;
+    }
+
+    int hits = 0, misses = 0, entries = 0;
+    glyph_cache_stats(term->glyph_cache, &hits, &misses, &entries);
+    size_t texture_bytes = render_texture_bytes(term->screen_texture) + render_texture_bytes(term->glyph_cache->atlas);
+
+    double p50 = 0.0, p99 = 0.0;
+    if (frame_ms) {
+        qsort(frame_ms, (size_t)nframes, sizeof(double), cmp_double);
+        p50 = percentile(frame_ms, nframes, 0.50);
+        p99 = percentile(frame_ms, nframes, 0.99);
+    }
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    double mb = (double)pos / (1024.0 * 1024.0);
+    printf("{\"name\": \"%s\", \"bytes\": %zu, \"frames\": %d, \"parse_mb_s\": %.2f, \"fps\": %.1f, "
+           "\"frame_ms_p50\": %.3f, \"frame_ms_p99\": %.3f, \"parse_ms\": %.3f, \"render_ms\": %.3f, "
+           "\"glyph_hit_rate\": %.4f, "
+           "\"glyph_entries\": %d, \"present_ms\": %.3f, \"texture_kb\": %zu, \"peak_rss_kb\": %ld}\n",
+           name, pos, nframes,
+           parse_ms > 0.0 ? mb / (parse_ms / 1000.0) : 0.0,
+           parse_ms + render_total_ms > 0.0 ? nframes * 1000.0 / (parse_ms + render_total_ms) : 0.0,
+           p50, p99, parse_ms / nframes, render_total_ms / nframes,
+           hits + misses > 0 ? (double)hits / (hits + misses) : 0.0,
+           entries, present_total_ms / nframes, texture_bytes / 1024, ru.ru_maxrss);
+    fflush(stdout);
+
+    free(frame_ms);
+    terminal_destroy(term);
+}
+
+static void bench_synthetic(BenchCtx* ctx, const Workload* w, int nframes)
+{
+    int cols = ctx->config->win_w / ctx->char_w;
+    int rows = ctx->config->win_h / ctx->char_h;
+    Buf b = {0};
+    size_t* ends = malloc((size_t)nframes * sizeof(size_t));
+    if (!ends) return;
+
+    s_rng = 0x9E3779B9u;
+    for (int f = 0; f < nframes; f++) {
+        w->gen(&b, f, cols, rows);
+        ends[f] = b.len;
+    }
+    bench_run(ctx, w->name, b.data, ends, nframes);
+    free(ends);
+    free(b.data);
+}
+
+/* Raw stream file (e.g. captured with `script -q`): split evenly into frames. */
+static void bench_stream(BenchCtx* ctx, const char* path, int nframes)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "bench: cannot open %s\n", path);
+        return;
+    }
+    Buf b = {0};
+    char tmp[65536];
+    size_t n;
+    while ((n = fread(tmp, 1, sizeof(tmp), fp)) > 0) buf_put(&b, tmp, n);
+    fclose(fp);
+
+    if (b.len == 0) {
+        free(b.data);
+        return;
+    }
+    if ((size_t)nframes > b.len) nframes = (int)b.len;
+    size_t* ends = malloc((size_t)nframes * sizeof(size_t));
+    if (ends) {
+        for (int f = 0; f < nframes; f++) ends[f] = b.len * (size_t)(f + 1) / (size_t)nframes;
+        const char* base = strrchr(path, '/');
+        bench_run(ctx, base ? base + 1 : path, b.data, ends, nframes);
+        free(ends);
+    }
+    free(b.data);
+}
+
+/* Recording from --record: output chunks batched into 16 ms frames. */
+#define BENCH_REPLAY_FRAME_US 16667
+
+static void bench_recording(BenchCtx* ctx, const char* path)
+{
+    if (!session_replay_open(path, NULL, NULL)) {
+        fprintf(stderr, "bench: cannot load recording %s\n", path);
+        return;
+    }
+    Buf b = {0};
+    size_t* ends = NULL;
+    int nframes = 0, cap = 0;
+    uint64_t frame_end_us = BENCH_REPLAY_FRAME_US;
+    SessionEvent ev;
+    while (session_replay_next(&ev)) {
+        if (ev.type != SESSION_EVENT_OUTPUT) continue;
+        if (ev.time_us >= frame_end_us && b.len > 0) {
+            if (nframes == cap) {
+                cap = cap ? cap * 2 : 256;
+                size_t* p = realloc(ends, (size_t)cap * sizeof(size_t));
+                if (!p) break;
+                ends = p;
+            }
+            ends[nframes++] = b.len;
+            frame_end_us = (ev.time_us / BENCH_REPLAY_FRAME_US + 1) * BENCH_REPLAY_FRAME_US;
+        }
+        buf_put(&b, ev.data, ev.len);
+    }
+    session_replay_close();
+
+    if (b.len > 0 && (nframes == 0 || ends[nframes - 1] != b.len)) {
+        size_t* p = realloc(ends, (size_t)(nframes + 1) * sizeof(size_t));
+        if (p) {
+            ends = p;
+            ends[nframes++] = b.len;
+        }
+    }
+    if (nframes > 0) {
+        const char* base = strrchr(path, '/');
+        bench_run(ctx, base ? base + 1 : path, b.data, ends, nframes);
+    }
+    free(ends);
+    free(b.data);
+}
+
+/* ===================== Process per workload ===================== */
+
+typedef struct {
+    const char* font_path;
+    const char* bitmap_font_path;
+    int font_size;
+    int nframes;
+    int color_depth;
+} BenchOptions;
+
+typedef enum { BENCH_JOB_SYNTHETIC, BENCH_JOB_STREAM, BENCH_JOB_REPLAY } BenchJobKind;
+
+/* Sets up SDL, the renderer and the font, runs one workload, tears down. */
+static int bench_child(const BenchOptions* opt, BenchJobKind kind, const char* path, const Workload* w)
+{
+    if (SDL_Init(SDL_INIT_VIDEO) != 0 || TTF_Init() != 0) {
+        fprintf(stderr, "bench: SDL init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    Config config;
+    config_init_defaults(&config);
+    config.win_w = BENCH_WIN_W;
+    config.win_h = BENCH_WIN_H;
+    config.font_size = opt->font_size;
+    config.color_depth = opt->color_depth;
+    free(config.font_path);
+    config.font_path = strdup(opt->font_path);
+
+    SDL_Window* win = SDL_CreateWindow("bench", 0, 0, config.win_w, config.win_h, SDL_WINDOW_HIDDEN);
+    SDL_Renderer* renderer = win ? SDL_CreateRenderer(win, -1, SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE) : NULL;
+    SDL_Surface* surface = NULL;
+    if (!renderer) {
+        surface = SDL_CreateRGBSurfaceWithFormat(0, config.win_w, config.win_h, 32, SDL_PIXELFORMAT_RGBA8888);
+        renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    }
+    TTF_Font* font = TTF_OpenFont(opt->font_path, opt->font_size);
+    if (!renderer || !font || (opt->bitmap_font_path && !font_manager_open_bitmap(opt->bitmap_font_path))) {
+        fprintf(stderr, "bench: setup failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    BenchCtx ctx = { renderer, font, &config, 0, 0 };
+    if (!font_cell_size(font, &ctx.char_w, &ctx.char_h)) {
+        fprintf(stderr, "bench: bad font metrics\n");
+        return 1;
+    }
+
+    switch (kind) {
+    case BENCH_JOB_SYNTHETIC: bench_synthetic(&ctx, w, opt->nframes); break;
+    case BENCH_JOB_STREAM:    bench_stream(&ctx, path, opt->nframes); break;
+    case BENCH_JOB_REPLAY:    bench_recording(&ctx, path); break;
+    }
+
+    TTF_CloseFont(font);
+    font_manager_cleanup();
+    soft_render_cleanup();
+    SDL_DestroyRenderer(renderer);
+    if (surface) SDL_FreeSurface(surface);
+    if (win) SDL_DestroyWindow(win);
+    config_cleanup(&config);
+    TTF_Quit();
+    SDL_Quit();
+    return 0;
+}
+
+static bool bench_isolated(const BenchOptions* opt, BenchJobKind kind, const char* path, const Workload* w)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("bench: fork");
+        return false;
+    }
+    if (pid == 0) {
+        int rc = bench_child(opt, kind, path, w);
+        fflush(stdout);
+        _exit(rc);
+    }
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "bench: workload %s failed\n", w ? w->name : path);
+        return false;
+    }
+    return true;
+}
+
+static int remove_entry(const char* path, const struct stat* st, int type, struct FTW* ftw)
+{
+    (void)st;
+    (void)type;
+    (void)ftw;
+    return remove(path);
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions opt = { "res/Martian.ttf", NULL, 12, BENCH_DEFAULT_FRAMES, 32 };
+
+    setenv("SDL_VIDEODRIVER", "dummy", 0);
+    setenv("SDL_RENDER_DRIVER", "software", 0);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--font") == 0 && i + 1 < argc) opt.font_path = argv[++i];
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) opt.font_size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--bitmap-font") == 0 && i + 1 < argc) opt.bitmap_font_path = argv[++i];
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) opt.nframes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--color-depth") == 0 && i + 1 < argc) opt.color_depth = atoi(argv[++i]) == 16 ? 16 : 32;
+    }
+    if (opt.nframes < 1) opt.nframes = 1;
+
+    // Keep the atlas and coverage caches out of the user's cache directory
+    const char* tmp = getenv("TMPDIR");
+    char cache_dir[4096];
+    snprintf(cache_dir, sizeof(cache_dir), "%s/vaixterm-bench-XXXXXX", tmp && tmp[0] ? tmp : "/tmp");
+    if (!mkdtemp(cache_dir)) {
+        perror("bench: mkdtemp");
+        return 1;
+    }
+    setenv("XDG_CACHE_HOME", cache_dir, 1);
+
+    bool ok = true;
+    bool streamed = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            ok &= bench_isolated(&opt, BENCH_JOB_STREAM, argv[++i], NULL);
+            streamed = true;
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            ok &= bench_isolated(&opt, BENCH_JOB_REPLAY, argv[++i], NULL);
+            streamed = true;
+        }
+    }
+    if (!streamed) {
+        for (size_t i = 0; i < sizeof(s_workloads) / sizeof(s_workloads[0]); i++) {
+            ok &= bench_isolated(&opt, BENCH_JOB_SYNTHETIC, NULL, &s_workloads[i]);
+        }
+    }
+
+    nftw(cache_dir, remove_entry, 8, FTW_DEPTH | FTW_PHYS);
+    return ok ? 0 : 1;
+}
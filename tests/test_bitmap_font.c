@@ -0,0 +1,309 @@
+/**
+ * Headless test for the PSF1, PSF2 and BDF font loaders.
+ *
+ * Writes small fonts to a temporary directory and checks cell sizes,
+ * glyph bitmaps and the codepoint table (including PSF unicode tables with
+ * several codepoints per glyph and skipped combining sequences). Truncated
+ * and foreign files must fail to load.
+ *
+ * Build: make tests/test_bitmap_font
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bitmap_font.h"
+
+static char root[256];
+
+/* ===================== Fixtures ===================== */
+
+static void write_file(const char* name, const void* data, size_t len, char* path, size_t path_size) {
+    snprintf(path, path_size, "%s/%s", root, name);
+    FILE* f = fopen(path, "wb");
+    if (!f) { perror(path); exit(2); }
+    fwrite(data, 1, len, f);
+    fclose(f);
+}
+
+static void put16(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/* PSF1, 256 glyphs of 8x8; every row of glyph g is the byte g. */
+static size_t make_psf1(uint8_t* buf, bool with_table) {
+    buf[0] = 0x36;
+    buf[1] = 0x04;
+    buf[2] = with_table ? 0x02 : 0x00;
+    buf[3] = 8;
+    size_t p = 4;
+    for (int g = 0; g < 256; g++) {
+        memset(buf + p, g, 8);
+        p += 8;
+    }
+    if (!with_table) return p;
+    for (int g = 0; g < 256; g++) {
+        put16(buf + p, (uint32_t)g); p += 2;
+        if (g == 'A') {
+            put16(buf + p, 0x0391); p += 2;           // GREEK CAPITAL ALPHA shares the glyph
+            put16(buf + p, 0xFFFE); p += 2;           // A + COMBINING ACUTE, not mapped
+            put16(buf + p, 'A'); p += 2;
+            put16(buf + p, 0x0301); p += 2;
+        }
+        put16(buf + p, 0xFFFF); p += 2;
+    }
+    return p;
+}
+
+/* PSF2, 4 glyphs of 12x16; row r of glyph g is the bytes {g, r}. */
+static size_t make_psf2(uint8_t* buf) {
+    put32(buf, 0x864ab572u);
+    put32(buf + 4, 0);
+    put32(buf + 8, 32);
+    put32(buf + 12, 1);         // Has a unicode table
+    put32(buf + 16, 4);
+    put32(buf + 20, 16 * 2);
+    put32(buf + 24, 16);
+    put32(buf + 28, 12);
+    size_t p = 32;
+    for (int g = 0; g < 4; g++) {
+        for (int r = 0; r < 16; r++) {
+            buf[p++] = (uint8_t)g;
+            buf[p++] = (uint8_t)r;
+        }
+    }
+    static const uint8_t table[] = {
+        'a', 0xFF,
+        0xC3, 0xA9, 0xE2, 0x82, 0xAC, 0xFF,     // U+00E9 and U+20AC
+        0xFE, 'e', 0xCC, 0x81, 0xFF,            // Only a sequence: no codepoint
+        0xF0, 0x9F, 0x98, 0x80, 0xFF,           // U+1F600
+    };
+    memcpy(buf + p, table, sizeof(table));
+    return p + sizeof(table);
+}
+
+static const char bdf[] =
+    "STARTFONT 2.1\n"
+    "FONT -test-fixed-medium-r-normal--10-100-75-75-c-80-iso10646-1\n"
+    "SIZE 10 75 75\n"
+    "FONTBOUNDINGBOX 8 10 0 -2\n"
+    "STARTPROPERTIES 2\n"
+    "FONT_ASCENT 8\n"
+    "FONT_DESCENT 2\n"
+    "ENDPROPERTIES\n"
+    "CHARS 3\n"
+    "STARTCHAR A\n"
+    "ENCODING 65\n"
+    "SWIDTH 500 0\n"
+    "DWIDTH 8 0\n"
+    "BBX 4 3 2 0\n"
+    "BITMAP\n"
+    "F0\n"
+    "90\n"
+    "F0\n"
+    "ENDCHAR\n"
+    "STARTCHAR unencoded\n"
+    "ENCODING -1\n"
+    "BBX 8 1 0 0\n"
+    "BITMAP\n"
+    "FF\n"
+    "ENDCHAR\n"
+    "STARTCHAR underscore\n"
+    "ENCODING 95\n"
+    "BBX 8 1 0 -2\n"
+    "BITMAP\n"
+    "FF\n"
+    "ENDCHAR\n"
+    "ENDFONT\n";
+
+static bool rows_are(const uint8_t* glyph, size_t stride, int height, const uint8_t* expect) {
+    return glyph && memcmp(glyph, expect, stride * (size_t)height) == 0;
+}
+
+/* ===================== Main ===================== */
+
+int main(void) {
+    int pass = 0, fail = 0;
+
+    snprintf(root, sizeof(root), "/tmp/vaixterm_bitmap_XXXXXX");
+    if (!mkdtemp(root)) { perror("mkdtemp"); return 2; }
+
+    static uint8_t buf[8192];
+    char path[320];
+
+    /* ===== TEST 1: PSF1 with a unicode table ===== */
+    printf("TEST 1: PSF1 unicode table\n");
+    {
+        size_t len = make_psf1(buf, true);
+        write_file("table.psf", buf, len, path, sizeof(path));
+        BitmapFont* font = bitmap_font_open(path);
+        const uint8_t* a = font ? bitmap_font_glyph(font, 'A') : NULL;
+        uint8_t expect[8];
+        memset(expect, 'A', sizeof(expect));
+        if (font && font->width == 8 && font->height == 8 && font->stride == 1 && font->num_glyphs == 256 &&
+            rows_are(a, 1, 8, expect) && bitmap_font_glyph(font, 0x0391) == a &&
+            !bitmap_font_glyph(font, 0x0301) && bitmap_font_glyph(font, 0xFF) &&
+            !bitmap_font_glyph(font, 0x100)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: font=%p\n", (void*)font); fail++;
+        }
+        bitmap_font_close(font);
+    }
+
+    /* ===== TEST 2: PSF1 without a table maps glyph N to codepoint N ===== */
+    printf("\nTEST 2: PSF1 identity map\n");
+    {
+        size_t len = make_psf1(buf, false);
+        write_file("plain.psf", buf, len, path, sizeof(path));
+        BitmapFont* font = bitmap_font_open(path);
+        const uint8_t* g = font ? bitmap_font_glyph(font, 200) : NULL;
+        if (font && font->map_len == 256 && g && g[0] == 200 && g[7] == 200 && !bitmap_font_glyph(font, 256)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: font=%p\n", (void*)font); fail++;
+        }
+        bitmap_font_close(font);
+    }
+
+    /* ===== TEST 3: PSF2 with UTF-8 table ===== */
+    printf("\nTEST 3: PSF2 unicode table\n");
+    {
+        size_t len = make_psf2(buf);
+        write_file("font.psfu", buf, len, path, sizeof(path));
+        BitmapFont* font = bitmap_font_open(path);
+        const uint8_t* e = font ? bitmap_font_glyph(font, 0xE9) : NULL;
+        const uint8_t* smile = font ? bitmap_font_glyph(font, 0x1F600) : NULL;
+        if (font && font->width == 12 && font->height == 16 && font->stride == 2 && font->num_glyphs == 4 &&
+            e && e[0] == 1 && e[31] == 15 && bitmap_font_glyph(font, 0x20AC) == e &&
+            bitmap_font_glyph(font, 'a') && bitmap_font_glyph(font, 'a')[0] == 0 &&
+            smile && smile[0] == 3 && !bitmap_font_glyph(font, 'e') && !bitmap_font_glyph(font, 0x301)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: font=%p e=%p smile=%p\n", (void*)font, (const void*)e, (const void*)smile); fail++;
+        }
+        bitmap_font_close(font);
+    }
+
+    /* ===== TEST 4: BDF glyphs are placed from their BBX ===== */
+    printf("\nTEST 4: BDF\n");
+    {
+        write_file("font.bdf", bdf, strlen(bdf), path, sizeof(path));
+        BitmapFont* font = bitmap_font_open(path);
+        // 8x10 cell, baseline at row 8
+        static const uint8_t expect_a[10] = { 0, 0, 0, 0, 0, 0x3C, 0x24, 0x3C, 0, 0 };
+        static const uint8_t expect_us[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF };
+        if (font && font->width == 8 && font->height == 10 && font->num_glyphs == 2 && font->map_len == 2 &&
+            rows_are(bitmap_font_glyph(font, 'A'), 1, 10, expect_a) &&
+            rows_are(bitmap_font_glyph(font, '_'), 1, 10, expect_us) && !bitmap_font_glyph(font, 'B')) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: font=%p glyphs=%u\n", (void*)font, font ? font->num_glyphs : 0); fail++;
+        }
+        bitmap_font_close(font);
+    }
+
+    /* ===== TEST 5: Truncated PSF files ===== */
+    printf("\nTEST 5: Truncated PSF\n");
+    {
+        size_t len1 = make_psf1(buf, false);
+        write_file("cut1.psf", buf, len1 - 1, path, sizeof(path));
+        BitmapFont* psf1 = bitmap_font_open(path);
+        write_file("head1.psf", buf, 3, path, sizeof(path));
+        BitmapFont* head1 = bitmap_font_open(path);
+        size_t len2 = make_psf2(buf);
+        size_t glyph_end = 32 + 4 * 32;
+        write_file("cut2.psfu", buf, glyph_end - 5, path, sizeof(path));
+        BitmapFont* psf2 = bitmap_font_open(path);
+        write_file("head2.psfu", buf, 20, path, sizeof(path));
+        BitmapFont* head2 = bitmap_font_open(path);
+        // A cut unicode table keeps the glyphs mapped so far
+        write_file("table2.psfu", buf, glyph_end + 3, path, sizeof(path));
+        BitmapFont* table2 = bitmap_font_open(path);
+        if (!psf1 && !head1 && !psf2 && !head2 && len2 > glyph_end && table2 &&
+            bitmap_font_glyph(table2, 'a') && !bitmap_font_glyph(table2, 0x1F600)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: psf1=%p head1=%p psf2=%p head2=%p table2=%p\n", (void*)psf1, (void*)head1,
+                   (void*)psf2, (void*)head2, (void*)table2); fail++;
+        }
+        bitmap_font_close(psf1);
+        bitmap_font_close(head1);
+        bitmap_font_close(psf2);
+        bitmap_font_close(head2);
+        bitmap_font_close(table2);
+    }
+
+    /* ===== TEST 6: Corrupt PSF2 header ===== */
+    printf("\nTEST 6: PSF2 with a wrong glyph size\n");
+    {
+        size_t len = make_psf2(buf);
+        put32(buf + 20, 16);        // charsize no longer height * stride
+        write_file("bad.psfu", buf, len, path, sizeof(path));
+        BitmapFont* font = bitmap_font_open(path);
+        if (!font) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: loaded\n"); fail++;
+        }
+        bitmap_font_close(font);
+    }
+
+    /* ===== TEST 7: Truncated BDF files ===== */
+    printf("\nTEST 7: Truncated BDF\n");
+    {
+        const char* first_bitmap = strstr(bdf, "F0\n90\n");
+        const char* second_char = strstr(bdf, "STARTCHAR unencoded");
+        write_file("cut_glyph.bdf", bdf, (size_t)(first_bitmap - bdf) + 3, path, sizeof(path));
+        BitmapFont* mid_first = bitmap_font_open(path);
+        write_file("cut_header.bdf", bdf, (size_t)(strstr(bdf, "CHARS 3") - bdf), path, sizeof(path));
+        BitmapFont* header = bitmap_font_open(path);
+        // Whole glyphs before the cut stay usable
+        write_file("cut_later.bdf", bdf, (size_t)(second_char - bdf) + 10, path, sizeof(path));
+        BitmapFont* later = bitmap_font_open(path);
+        if (!mid_first && !header && later && later->num_glyphs == 1 && bitmap_font_glyph(later, 'A') &&
+            !bitmap_font_glyph(later, '_')) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: mid_first=%p header=%p later=%p\n", (void*)mid_first, (void*)header,
+                   (void*)later); fail++;
+        }
+        bitmap_font_close(mid_first);
+        bitmap_font_close(header);
+        bitmap_font_close(later);
+    }
+
+    /* ===== TEST 8: Not a font ===== */
+    printf("\nTEST 8: Foreign and missing files\n");
+    {
+        write_file("text.txt", "hello world\n", 12, path, sizeof(path));
+        BitmapFont* text = bitmap_font_open(path);
+        write_file("empty.bdf", "", 0, path, sizeof(path));
+        BitmapFont* empty = bitmap_font_open(path);
+        BitmapFont* missing = bitmap_font_open("/nonexistent/font.psf");
+        if (!text && !empty && !missing && !bitmap_font_open(NULL)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: text=%p empty=%p missing=%p\n", (void*)text, (void*)empty, (void*)missing); fail++;
+        }
+    }
+
+    printf("\n===== %d passed, %d failed =====\n", pass, fail);
+
+    char cmd[300];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", root);
+    if (system(cmd) != 0) {
+        fprintf(stderr, "Could not remove %s\n", root);
+    }
+    return fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * Headless test for grapheme cluster interning.
+ *
+ * Checks that single codepoints pass through, that equal sequences get the
+ * same id and different ones (including prefixes and reorderings) get
+ * different ids, that ids map back to their codepoints, and the behavior
+ * at the per-cluster and per-session limits and after a reset.
+ *
+ * Build: make tests/test_glyph_cluster
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyph_cluster.h"
+
+/* ===================== Helpers ===================== */
+
+static bool chars_are(uint32_t id, const uint32_t* expect, int count) {
+    int n = -1;
+    const uint32_t* chars = glyph_cluster_chars(id, &n);
+    return chars && n == count && memcmp(chars, expect, sizeof(uint32_t) * (size_t)count) == 0;
+}
+
+/* ===================== Main ===================== */
+
+int main(void) {
+    int pass = 0, fail = 0;
+
+    static const uint32_t e_acute[] = { 'e', 0x0301 };
+    static const uint32_t e_acute_grave[] = { 'e', 0x0301, 0x0300 };
+    static const uint32_t e_grave_acute[] = { 'e', 0x0300, 0x0301 };
+    static const uint32_t family[] = { 0x1F468, 0x200D, 0x1F469, 0x200D, 0x1F467 };
+
+    /* ===== TEST 1: Single codepoints are stored as is ===== */
+    printf("TEST 1: Plain codepoints\n");
+    {
+        uint32_t a = 'A', wide = 0x4E2D;
+        int n = -1;
+        const uint32_t* chars = glyph_cluster_chars('A', &n);
+        if (glyph_cluster_intern(&a, 1) == 'A' && glyph_cluster_intern(&wide, 1) == 0x4E2D &&
+            glyph_cluster_intern(NULL, 0) == ' ' && !glyph_is_cluster('A') && !chars && n == 0 &&
+            glyph_cluster_base(0x4E2D) == 0x4E2D) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: n=%d\n", n); fail++;
+        }
+    }
+
+    /* ===== TEST 2: Equal sequences share an id ===== */
+    printf("\nTEST 2: Interning\n");
+    {
+        uint32_t id1 = glyph_cluster_intern(e_acute, 2);
+        uint32_t copy[2] = { 'e', 0x0301 };
+        uint32_t id2 = glyph_cluster_intern(copy, 2);
+        uint32_t id3 = glyph_cluster_intern(e_acute_grave, 3);
+        uint32_t id4 = glyph_cluster_intern(e_grave_acute, 3);
+        uint32_t id5 = glyph_cluster_intern(family, 5);
+        if (glyph_is_cluster(id1) && id1 == id2 && id3 != id1 && id4 != id3 && id5 != id1 &&
+            id5 != id3 && id5 != id4 && glyph_cluster_intern(family, 5) == id5) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: ids %08x %08x %08x %08x %08x\n", id1, id2, id3, id4, id5); fail++;
+        }
+    }
+
+    /* ===== TEST 3: Ids map back to their codepoints ===== */
+    printf("\nTEST 3: Lookup\n");
+    {
+        uint32_t id1 = glyph_cluster_intern(e_acute, 2);
+        uint32_t id5 = glyph_cluster_intern(family, 5);
+        int n = -1;
+        if (chars_are(id1, e_acute, 2) && chars_are(id5, family, 5) && glyph_cluster_base(id1) == 'e' &&
+            glyph_cluster_base(id5) == 0x1F468 && !glyph_cluster_chars(GLYPH_CLUSTER_FLAG | 9999, &n) &&
+            n == 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: lookup mismatch\n"); fail++;
+        }
+    }
+
+    /* ===== TEST 4: Long clusters keep their first codepoints ===== */
+    printf("\nTEST 4: Per-cluster limit\n");
+    {
+        uint32_t long_seq[GLYPH_CLUSTER_MAX_CHARS + 3];
+        long_seq[0] = 'o';
+        for (int i = 1; i < GLYPH_CLUSTER_MAX_CHARS + 3; i++) long_seq[i] = 0x0300 + (uint32_t)i;
+        uint32_t id = glyph_cluster_intern(long_seq, GLYPH_CLUSTER_MAX_CHARS + 3);
+        if (chars_are(id, long_seq, GLYPH_CLUSTER_MAX_CHARS) &&
+            glyph_cluster_intern(long_seq, GLYPH_CLUSTER_MAX_CHARS) == id) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: id=%08x\n", id); fail++;
+        }
+    }
+
+    /* ===== TEST 5: A full table degrades new clusters to their base ===== */
+    printf("\nTEST 5: Per-session limit\n");
+    {
+        glyph_cluster_reset();
+        bool distinct = true;
+        uint32_t first = 0, last = 0;
+        for (uint32_t i = 0; i < GLYPH_CLUSTER_MAX; i++) {
+            uint32_t seq[2] = { 0x10000 + i, 0x0301 };
+            uint32_t id = glyph_cluster_intern(seq, 2);
+            distinct &= glyph_is_cluster(id) && (id & ~GLYPH_CLUSTER_FLAG) == i;
+            if (i == 0) first = id;
+            last = id;
+        }
+        uint32_t extra[2] = { 'x', 0x0301 };
+        uint32_t seq0[2] = { 0x10000, 0x0301 };
+        uint32_t seq_last[2] = { 0x10000 + GLYPH_CLUSTER_MAX - 1, 0x0301 };
+        if (distinct && glyph_cluster_intern(extra, 2) == 'x' && glyph_cluster_intern(seq0, 2) == first &&
+            glyph_cluster_intern(seq_last, 2) == last && chars_are(first, seq0, 2)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: distinct=%d\n", distinct); fail++;
+        }
+    }
+
+    /* ===== TEST 6: Reset forgets every cluster ===== */
+    printf("\nTEST 6: Reset\n");
+    {
+        glyph_cluster_reset();
+        uint32_t old = glyph_cluster_intern(family, 5);
+        glyph_cluster_reset();
+        int n = -1;
+        bool gone = !glyph_cluster_chars(old, &n) && n == 0;
+        uint32_t id = glyph_cluster_intern(e_acute, 2);
+        if (old == GLYPH_CLUSTER_FLAG && gone && id == GLYPH_CLUSTER_FLAG && chars_are(id, e_acute, 2)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: gone=%d id=%08x\n", gone, id); fail++;
+        }
+        glyph_cluster_reset();
+    }
+
+    printf("\n===== %d passed, %d failed =====\n", pass, fail);
+    return fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * Headless test for the power profile policy.
+ *
+ * Builds fake power_supply and thermal trees in a temporary directory and
+ * checks the state read from them, the chosen profile, the hot hysteresis
+ * and the settings handed to the main loop.
+ *
+ * Build: make tests/test_power_policy
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "power_policy.h"
+
+static char root[256];
+static char supply[300];
+static char thermal[300];
+
+/* ===================== Fake sysfs ===================== */
+
+static void write_attr(const char *dir, const char *entry, const char *file, const char *value) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, entry);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/%s/%s", dir, entry, file);
+    FILE *f = fopen(path, "w");
+    if (!f) { perror(path); exit(2); }
+    fprintf(f, "%s\n", value);
+    fclose(f);
+}
+
+static void set_battery(const char *status, const char *capacity, const char *ac_online) {
+    write_attr(supply, "BAT0", "type", "Battery");
+    write_attr(supply, "BAT0", "status", status);
+    write_attr(supply, "BAT0", "capacity", capacity);
+    write_attr(supply, "AC", "type", "Mains");
+    write_attr(supply, "AC", "online", ac_online);
+}
+
+static void set_temp(const char *millidegrees) {
+    write_attr(thermal, "thermal_zone0", "temp", "41000");
+    write_attr(thermal, "thermal_zone1", "temp", millidegrees);
+}
+
+/* ===================== Main ===================== */
+
+int main(void) {
+    int pass = 0, fail = 0;
+
+    snprintf(root, sizeof(root), "/tmp/vaixterm_power_XXXXXX");
+    if (!mkdtemp(root)) { perror("mkdtemp"); return 2; }
+    snprintf(supply, sizeof(supply), "%s/power_supply", root);
+    snprintf(thermal, sizeof(thermal), "%s/thermal", root);
+    mkdir(supply, 0755);
+    mkdir(thermal, 0755);
+
+    PowerState st;
+
+    /* ===== TEST 1: Missing directories mean AC ===== */
+    printf("TEST 1: Missing directories\n");
+    power_policy_read("/nonexistent/power_supply", "/nonexistent/thermal", &st);
+    if (!st.has_battery && power_policy_classify(&st, 20, 70, POWER_PROFILE_AC) == POWER_PROFILE_AC) {
+        printf("  PASS\n"); pass++;
+    } else {
+        printf("  FAIL: has_battery=%d\n", st.has_battery); fail++;
+    }
+
+    /* ===== TEST 2: Charger online ===== */
+    printf("\nTEST 2: Charging battery\n");
+    set_battery("Charging", "80", "1");
+    set_temp("45000");
+    power_policy_read(supply, thermal, &st);
+    if (st.has_battery && !st.on_battery && st.capacity == 80 && st.temp_c == 45 &&
+        power_policy_classify(&st, 20, 70, POWER_PROFILE_AC) == POWER_PROFILE_AC) {
+        printf("  PASS\n"); pass++;
+    } else {
+        printf("  FAIL: on_battery=%d capacity=%d temp=%d\n", st.on_battery, st.capacity, st.temp_c); fail++;
+    }
+
+    /* ===== TEST 3: Discharging, then low ===== */
+    printf("\nTEST 3: Discharging battery\n");
+    set_battery("Discharging", "55", "0");
+    power_policy_read(supply, thermal, &st);
+    PowerProfile p1 = power_policy_classify(&st, 20, 70, POWER_PROFILE_AC);
+    set_battery("Discharging", "12", "0");
+    power_policy_read(supply, thermal, &st);
+    PowerProfile p2 = power_policy_classify(&st, 20, 70, p1);
+    if (p1 == POWER_PROFILE_BATTERY && p2 == POWER_PROFILE_LOW_BATTERY) {
+        printf("  PASS\n"); pass++;
+    } else {
+        printf("  FAIL: %s, %s\n", power_profile_name(p1), power_profile_name(p2)); fail++;
+    }
+
+    /* ===== TEST 4: Peripheral batteries are ignored ===== */
+    printf("\nTEST 4: Device-scoped battery\n");
+    set_battery("Charging", "80", "1");
+    write_attr(supply, "hid-pad-battery", "type", "Battery");
+    write_attr(supply, "hid-pad-battery", "scope", "Device");
+    write_attr(supply, "hid-pad-battery", "status", "Discharging");
+    write_attr(supply, "hid-pad-battery", "capacity", "5");
+    power_policy_read(supply, thermal, &st);
+    if (!st.on_battery && st.capacity == 80) {
+        printf("  PASS\n"); pass++;
+    } else {
+        printf("  FAIL: on_battery=%d capacity=%d\n", st.on_battery, st.capacity); fail++;
+    }
+
+    /* ===== TEST 5: Heat wins, with hysteresis ===== */
+    printf("\nTEST 5: Hot and cooling down\n");
+    set_temp("72000");
+    power_policy_read(supply, thermal, &st);
+    PowerProfile hot = power_policy_classify(&st, 20, 70, POWER_PROFILE_AC);
+    set_temp("67000");
+    power_policy_read(supply, thermal, &st);
+    PowerProfile still_hot = power_policy_classify(&st, 20, 70, hot);
+    set_temp("64000");
+    power_policy_read(supply, thermal, &st);
+    PowerProfile cooled = power_policy_classify(&st, 20, 70, still_hot);
+    if (hot == POWER_PROFILE_HOT && still_hot == POWER_PROFILE_HOT && cooled == POWER_PROFILE_AC) {
+        printf("  PASS\n"); pass++;
+    } else {
+        printf("  FAIL: %s, %s, %s\n", power_profile_name(hot), power_profile_name(still_hot),
+               power_profile_name(cooled)); fail++;
+    }
+
+    /* ===== TEST 6: Settings follow the profile ===== */
+    printf("\nTEST 6: Profile settings\n");
+    Config config;
+    memset(&config, 0, sizeof(config));
+    config.power_supply_path = supply;
+    config.thermal_path = thermal;
+    config.low_battery_pct = 20;
+    config.hot_temp_c = 70;
+    config.power_profiles[POWER_PROFILE_AC] = (PowerProfileSettings){ 0, true, 33 };
+    config.power_profiles[POWER_PROFILE_BATTERY] = (PowerProfileSettings){ 24, true, 100 };
+    config.power_profiles[POWER_PROFILE_LOW_BATTERY] = (PowerProfileSettings){ 15, false, 250 };
+    config.power_profiles[POWER_PROFILE_HOT] = (PowerProfileSettings){ 10, false, 250 };
+    set_battery("Charging", "80", "1");
+    power_policy_init(&config);
+    int ac_fps = power_policy_fps(30);
+    set_battery("Discharging", "10", "0");
+    bool changed = power_policy_refresh();
+    if (ac_fps == 30 && changed && power_policy_profile() == POWER_PROFILE_LOW_BATTERY &&
+        power_policy_fps(30) == 15 && power_policy_fps(12) == 12 && !power_policy_blink() &&
+        power_policy_idle_ms() == 250 && !power_policy_refresh()) {
+        printf("  PASS\n"); pass++;
+    } else {
+        printf("  FAIL: ac_fps=%d changed=%d profile=%s fps=%d\n", ac_fps, changed,
+               power_profile_name(power_policy_profile()), power_policy_fps(30)); fail++;
+    }
+
+    printf("\n===== %d passed, %d failed =====\n", pass, fail);
+
+    char cmd[300];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", root);
+    if (system(cmd) != 0) {
+        fprintf(stderr, "Could not remove %s\n", root);
+    }
+    return fail > 0 ? 1 : 0;
+}
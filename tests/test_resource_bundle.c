@@ -0,0 +1,267 @@
+/**
+ * Headless test for the precompiled resource bundle.
+ *
+ * Points XDG_CACHE_HOME at a temporary directory, stores a colorscheme, a
+ * key set and a layout, and loads them back both before and after the
+ * bundle is written and mapped again. Changing a source file's size or
+ * mtime must turn its entry into a miss, and a commit must drop entries
+ * whose source changed or went away.
+ *
+ * Build: make tests/test_resource_bundle
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "resource_bundle.h"
+
+static char root[256];
+static char bundle_path[400];
+
+/* ===================== Helpers ===================== */
+
+static void write_source(const char* path, const char* content) {
+    FILE* f = fopen(path, "w");
+    if (!f) { perror(path); exit(2); }
+    fputs(content, f);
+    fclose(f);
+}
+
+/* Moves the mtime by @p seconds without touching the content. */
+static void shift_mtime(const char* path, int seconds) {
+    struct stat st;
+    if (stat(path, &st) != 0) { perror(path); exit(2); }
+    struct timespec times[2] = { st.st_atim, st.st_mtim };
+    times[1].tv_sec += seconds;
+    if (utimensat(AT_FDCWD, path, times, 0) != 0) { perror(path); exit(2); }
+}
+
+/* Number of entries in the written bundle, or -1 if there is none. */
+static int bundle_entries(void) {
+    FILE* f = fopen(bundle_path, "rb");
+    if (!f) return -1;
+    uint32_t header[3] = {0};
+    size_t n = fread(header, sizeof(header), 1, f);
+    fclose(f);
+    return n == 1 && memcmp(header, "VXRB", 4) == 0 ? (int)header[2] : -1;
+}
+
+static bool theme_equal(const ThemeColor* a, const ThemeColor* b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (a[i].slot != b[i].slot || a[i].index != b[i].index || a[i].color.r != b[i].color.r ||
+            a[i].color.g != b[i].color.g || a[i].color.b != b[i].color.b || a[i].color.a != b[i].color.a) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool str_equal(const char* a, const char* b) {
+    return (!a && !b) || (a && b && strcmp(a, b) == 0);
+}
+
+static bool keys_equal(const SpecialKey* a, const SpecialKey* b, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!str_equal(a[i].display_name, b[i].display_name) || !str_equal(a[i].sequence, b[i].sequence) ||
+            a[i].type != b[i].type || a[i].keycode != b[i].keycode || a[i].mod != b[i].mod ||
+            a[i].command != b[i].command) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ===================== Fixtures ===================== */
+
+static const ThemeColor theme[] = {
+    { THEME_SLOT_PALETTE, 1, { 204, 0, 0, 255 } },
+    { THEME_SLOT_PALETTE, 255, { 1, 2, 3, 255 } },
+    { THEME_SLOT_FOREGROUND, 0, { 238, 238, 236, 255 } },
+    { THEME_SLOT_BACKGROUND, 0, { 0, 0, 0, 255 } },
+    { THEME_SLOT_CURSOR, 0, { 255, 128, 0, 255 } },
+};
+#define THEME_COUNT (sizeof(theme) / sizeof(theme[0]))
+
+static SpecialKey keys[] = {
+    { "Tab", SK_SEQUENCE, NULL, SDLK_TAB, KMOD_NONE, CMD_NONE },
+    { "^C", SK_SEQUENCE, NULL, 'c', KMOD_CTRL, CMD_NONE },
+    { "ls", SK_STRING, "ls -la\r", 0, KMOD_NONE, CMD_NONE },
+    { "A+", SK_INTERNAL_CMD, NULL, 0, KMOD_NONE, CMD_FONT_INC },
+    { NULL, SK_STRING, "", 0, KMOD_NONE, CMD_NONE },
+};
+#define KEY_COUNT (int)(sizeof(keys) / sizeof(keys[0]))
+
+/* ===================== Main ===================== */
+
+int main(void) {
+    int pass = 0, fail = 0;
+
+    snprintf(root, sizeof(root), "/tmp/vaixterm_bundle_XXXXXX");
+    if (!mkdtemp(root)) { perror("mkdtemp"); return 2; }
+    setenv("XDG_CACHE_HOME", root, 1);
+    snprintf(bundle_path, sizeof(bundle_path), "%s/vaixterm/resources.vxb", root);
+
+    char theme_path[300], keys_path[300], layout_path[300];
+    snprintf(theme_path, sizeof(theme_path), "%s/dark.theme", root);
+    snprintf(keys_path, sizeof(keys_path), "%s/bash.keys", root);
+    snprintf(layout_path, sizeof(layout_path), "%s/qwerty.kb", root);
+    write_source(theme_path, "color1 = #cc0000\n");
+    write_source(keys_path, "Tab\n^C\n");
+    write_source(layout_path, "q w e\n");
+
+    SpecialKeySet key_set = { .keys = keys, .num_keys = KEY_COUNT };
+    SpecialKeySet rows_none[2] = { { .keys = keys, .num_keys = 2 }, { .keys = keys + 2, .num_keys = 3 } };
+    SpecialKeySet rows_shift[1] = { { .keys = keys + 1, .num_keys = 1, .active_mod_mask = 1 } };
+    SpecialKeySet* layout[OSK_NUM_MODIFIERS] = { rows_none, rows_shift, NULL, NULL };
+    int layout_rows[OSK_NUM_MODIFIERS] = { 2, 1, 0, 0 };
+
+    /* ===== TEST 1: Nothing cached yet ===== */
+    printf("TEST 1: Empty bundle\n");
+    {
+        size_t count = 0;
+        SpecialKeySet loaded = {0};
+        if (!resource_bundle_load_theme(theme_path, &count) &&
+            !resource_bundle_load_key_set(keys_path, &loaded) && bundle_entries() == -1) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: hit before anything was stored\n"); fail++;
+        }
+    }
+
+    /* ===== TEST 2: Entries stored this run are found before commit ===== */
+    printf("\nTEST 2: Store and load in one run\n");
+    resource_bundle_store_theme(theme_path, theme, THEME_COUNT);
+    resource_bundle_store_key_set(keys_path, &key_set);
+    resource_bundle_store_layout(layout_path, layout, layout_rows);
+    {
+        size_t count = 0;
+        const ThemeColor* colors = resource_bundle_load_theme(theme_path, &count);
+        SpecialKeySet loaded = {0};
+        bool keys_hit = resource_bundle_load_key_set(keys_path, &loaded);
+        if (colors && count == THEME_COUNT && theme_equal(colors, theme, count) && keys_hit &&
+            loaded.num_keys == KEY_COUNT && keys_equal(loaded.keys, keys, KEY_COUNT) &&
+            loaded.keys[0].display_name != keys[0].display_name && bundle_entries() == -1) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: theme=%p count=%zu keys_hit=%d\n", (const void*)colors, count, keys_hit); fail++;
+        }
+        free(loaded.keys);
+    }
+
+    /* ===== TEST 3: Entries survive a write and a fresh mapping ===== */
+    printf("\nTEST 3: Commit and reopen\n");
+    resource_bundle_close();
+    {
+        size_t count = 0;
+        const ThemeColor* colors = resource_bundle_load_theme(theme_path, &count);
+        SpecialKeySet loaded = {0};
+        bool keys_hit = resource_bundle_load_key_set(keys_path, &loaded);
+        if (bundle_entries() == 3 && colors && count == THEME_COUNT && theme_equal(colors, theme, count) &&
+            keys_hit && loaded.borrowed_strings && loaded.num_keys == KEY_COUNT &&
+            keys_equal(loaded.keys, keys, KEY_COUNT)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: entries=%d theme=%p keys_hit=%d\n", bundle_entries(), (const void*)colors,
+                   keys_hit); fail++;
+        }
+        free(loaded.keys);
+    }
+
+    /* ===== TEST 4: Layout rows keep their buckets and keys ===== */
+    printf("\nTEST 4: Layout round trip\n");
+    {
+        SpecialKeySet* sets[OSK_NUM_MODIFIERS] = {0};
+        int rows[OSK_NUM_MODIFIERS] = {0};
+        bool hit = resource_bundle_load_layout(layout_path, sets, rows);
+        bool ok = hit && rows[0] == 2 && rows[1] == 1 && rows[2] == 0 && rows[3] == 0;
+        for (int m = 0; ok && m < OSK_NUM_MODIFIERS; m++) {
+            for (int r = 0; ok && r < rows[m]; r++) {
+                const SpecialKeySet* want = &layout[m][r];
+                ok = sets[m][r].num_keys == want->num_keys && sets[m][r].borrowed_strings &&
+                     sets[m][r].active_mod_mask == want->active_mod_mask &&
+                     keys_equal(sets[m][r].keys, want->keys, want->num_keys);
+            }
+        }
+        if (ok) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: hit=%d rows=%d,%d,%d,%d\n", hit, rows[0], rows[1], rows[2], rows[3]); fail++;
+        }
+        for (int m = 0; m < OSK_NUM_MODIFIERS; m++) {
+            for (int r = 0; r < rows[m]; r++) free(sets[m][r].keys);
+            free(sets[m]);
+        }
+    }
+
+    /* ===== TEST 5: A changed source is a miss ===== */
+    printf("\nTEST 5: Stale entries\n");
+    {
+        write_source(theme_path, "color1 = #cc0000\ncolor2 = #00cc00\n");   // New size
+        shift_mtime(keys_path, -3600);                                    // Same size, older mtime
+        size_t count = 0;
+        SpecialKeySet loaded = {0};
+        bool theme_hit = resource_bundle_load_theme(theme_path, &count) != NULL;
+        bool keys_hit = resource_bundle_load_key_set(keys_path, &loaded);
+        SpecialKeySet* sets[OSK_NUM_MODIFIERS] = {0};
+        int rows[OSK_NUM_MODIFIERS] = {0};
+        bool layout_hit = resource_bundle_load_layout(layout_path, sets, rows);
+        if (!theme_hit && !keys_hit && layout_hit) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: theme_hit=%d keys_hit=%d layout_hit=%d\n", theme_hit, keys_hit, layout_hit); fail++;
+        }
+        free(loaded.keys);
+        for (int m = 0; m < OSK_NUM_MODIFIERS; m++) {
+            for (int r = 0; r < rows[m]; r++) free(sets[m][r].keys);
+            free(sets[m]);
+        }
+    }
+
+    /* ===== TEST 6: Commit drops stale entries and keeps fresh ones ===== */
+    printf("\nTEST 6: Commit prunes\n");
+    {
+        // Only the theme is re-stored; the key set stays stale, the layout goes away
+        resource_bundle_store_theme(theme_path, theme, 2);
+        remove(layout_path);
+        resource_bundle_close();
+        size_t count = 0;
+        const ThemeColor* colors = resource_bundle_load_theme(theme_path, &count);
+        if (bundle_entries() == 1 && colors && count == 2 && theme_equal(colors, theme, 2)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: entries=%d count=%zu\n", bundle_entries(), count); fail++;
+        }
+        resource_bundle_close();
+    }
+
+    /* ===== TEST 7: A corrupt bundle is ignored and replaced ===== */
+    printf("\nTEST 7: Corrupt bundle\n");
+    {
+        FILE* f = fopen(bundle_path, "r+b");
+        if (f) { fputs("JUNK", f); fclose(f); }
+        size_t count = 0;
+        bool hit = resource_bundle_load_theme(theme_path, &count) != NULL;
+        resource_bundle_store_theme(theme_path, theme, THEME_COUNT);
+        resource_bundle_close();
+        const ThemeColor* colors = resource_bundle_load_theme(theme_path, &count);
+        if (!hit && bundle_entries() == 1 && colors && count == THEME_COUNT) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: hit=%d entries=%d\n", hit, bundle_entries()); fail++;
+        }
+        resource_bundle_close();
+    }
+
+    printf("\n===== %d passed, %d failed =====\n", pass, fail);
+
+    char cmd[300];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", root);
+    if (system(cmd) != 0) {
+        fprintf(stderr, "Could not remove %s\n", root);
+    }
+    return fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+/**
+ * Headless test for the rendered row cache.
+ *
+ * Uses a software renderer on an offscreen surface. Rows are drawn into a
+ * screen texture, captured and blitted back elsewhere; the pixels must
+ * match. Also checks second-sighting admission, misses on a different
+ * hash, salt, cells or size, LRU eviction and clearing.
+ *
+ * Build: make tests/test_row_cache
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "row_cache.h"
+
+#define COLS 20
+#define ROW_W 160
+#define ROW_H 16
+
+/* ===================== Helpers ===================== */
+
+static SDL_Renderer* renderer;
+static SDL_Texture* screen;
+static const SDL_Rect src_rect = { 0, 0, ROW_W, ROW_H };
+static const SDL_Rect dst_rect = { 0, ROW_H, ROW_W, ROW_H };
+
+static void make_line(Glyph* line, uint32_t c, Uint8 shade) {
+    for (int x = 0; x < COLS; x++) {
+        line[x] = (Glyph){ .character = c, .fg = { shade, 255, 255, 255 }, .bg = { 0, 0, shade, 255 },
+                           .width = 1 };
+    }
+}
+
+/* Paints the source row of the screen texture and leaves it as the target. */
+static void draw_row(SDL_Color color) {
+    SDL_SetRenderTarget(renderer, screen);
+    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+    SDL_RenderFillRect(renderer, &src_rect);
+}
+
+static void clear_dst(void) {
+    SDL_SetRenderTarget(renderer, screen);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderFillRect(renderer, &dst_rect);
+}
+
+/* Reads a pixel of the screen texture as 0xRRGGBBAA. */
+static Uint32 pixel_at(int x, int y) {
+    Uint32 pixel = 0;
+    SDL_Rect r = { x, y, 1, 1 };
+    SDL_SetRenderTarget(renderer, screen);
+    SDL_RenderReadPixels(renderer, &r, SDL_PIXELFORMAT_RGBA8888, &pixel, sizeof(pixel));
+    return pixel;
+}
+
+static bool blit(RowCache* cache, const Glyph* line, uint64_t salt) {
+    SDL_SetRenderTarget(renderer, screen);
+    return row_cache_blit(cache, renderer, row_cache_hash(line, COLS, salt), salt, line, COLS, &dst_rect);
+}
+
+static void capture(RowCache* cache, const Glyph* line, uint64_t salt, bool admit) {
+    SDL_SetRenderTarget(renderer, screen);
+    row_cache_capture(cache, renderer, screen, row_cache_hash(line, COLS, salt), salt, line, COLS,
+                      &src_rect, admit);
+}
+
+/* ===================== Main ===================== */
+
+int main(void) {
+    int pass = 0, fail = 0;
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, ROW_W, 2 * ROW_H, 32, SDL_PIXELFORMAT_RGBA8888);
+    renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    screen = renderer ? SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                          ROW_W, 2 * ROW_H) : NULL;
+    if (!screen) { fprintf(stderr, "No software renderer: %s\n", SDL_GetError()); return 2; }
+
+    const uint64_t fields[] = { 8, ROW_H, ROW_W, 0x000000ff };
+    const uint64_t salt = row_cache_salt(fields, 4);
+    const uint64_t swapped[] = { ROW_H, 8, ROW_W, 0x000000ff };
+    const uint64_t other_salt = row_cache_salt(swapped, 4);
+
+    RowCache* cache = row_cache_create();
+    Glyph line_a[COLS], line_b[COLS];
+    make_line(line_a, 'a', 10);
+    make_line(line_b, 'b', 10);
+
+    /* ===== TEST 1: Salt and hash ===== */
+    printf("TEST 1: Salt and hash\n");
+    {
+        Glyph recolored[COLS];
+        make_line(recolored, 'a', 11);
+        uint64_t h = row_cache_hash(line_a, COLS, salt);
+        if (cache && salt != other_salt && h == row_cache_hash(line_a, COLS, salt) &&
+            h != row_cache_hash(line_a, COLS, other_salt) && h != row_cache_hash(line_b, COLS, salt) &&
+            h != row_cache_hash(recolored, COLS, salt) && h != row_cache_hash(line_a, COLS - 1, salt)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: salt=%016llx other=%016llx\n", (unsigned long long)salt,
+                   (unsigned long long)other_salt); fail++;
+        }
+    }
+
+    /* ===== TEST 2: Live rows are admitted on their second sighting ===== */
+    printf("\nTEST 2: Admission\n");
+    {
+        draw_row((SDL_Color){ 255, 0, 0, 255 });
+        capture(cache, line_a, salt, false);
+        bool first = blit(cache, line_a, salt);
+        capture(cache, line_a, salt, false);
+        bool second = blit(cache, line_a, salt);
+        if (!first && second) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: first=%d second=%d\n", first, second); fail++;
+        }
+    }
+
+    /* ===== TEST 3: A hit draws the captured pixels ===== */
+    printf("\nTEST 3: Hit\n");
+    {
+        draw_row((SDL_Color){ 0, 0, 255, 255 });    // The source changes after the capture
+        clear_dst();
+        bool hit = blit(cache, line_a, salt);
+        Uint32 left = pixel_at(0, ROW_H), right = pixel_at(ROW_W - 1, 2 * ROW_H - 1);
+        if (hit && left == 0xFF0000FFu && right == 0xFF0000FFu) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: hit=%d left=%08x right=%08x\n", hit, left, right); fail++;
+        }
+    }
+
+    /* ===== TEST 4: Misses ===== */
+    printf("\nTEST 4: Misses\n");
+    {
+        Glyph collided[COLS];
+        make_line(collided, 'z', 10);
+        uint64_t hash_a = row_cache_hash(line_a, COLS, salt);
+        SDL_Rect narrow = { 0, ROW_H, ROW_W / 2, ROW_H };
+        bool other_row = blit(cache, line_b, salt);
+        bool wrong_salt = row_cache_blit(cache, renderer, hash_a, other_salt, line_a, COLS, &dst_rect);
+        bool wrong_cells = row_cache_blit(cache, renderer, hash_a, salt, collided, COLS, &dst_rect);
+        bool wrong_size = row_cache_blit(cache, renderer, hash_a, salt, line_a, COLS, &narrow);
+        if (!other_row && !wrong_salt && !wrong_cells && !wrong_size && blit(cache, line_a, salt)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: other=%d salt=%d cells=%d size=%d\n", other_row, wrong_salt, wrong_cells,
+                   wrong_size); fail++;
+        }
+    }
+
+    /* ===== TEST 5: The least recently used row is evicted ===== */
+    printf("\nTEST 5: LRU eviction\n");
+    {
+        row_cache_clear(cache);
+        Glyph lines[ROW_CACHE_SIZE + 1][COLS];
+        for (int i = 0; i <= ROW_CACHE_SIZE; i++) make_line(lines[i], 0x100 + (uint32_t)i, 10);
+        draw_row((SDL_Color){ 0, 255, 0, 255 });
+        for (int i = 0; i < ROW_CACHE_SIZE; i++) capture(cache, lines[i], salt, true);
+        bool all = true;
+        for (int i = 0; i < ROW_CACHE_SIZE; i++) all &= blit(cache, lines[i], salt);
+        // Row 0 was used last, so row 1 is now the oldest
+        bool touched = blit(cache, lines[0], salt);
+        capture(cache, lines[ROW_CACHE_SIZE], salt, true);
+        bool newest = blit(cache, lines[ROW_CACHE_SIZE], salt);
+        bool evicted = !blit(cache, lines[1], salt);
+        bool kept = blit(cache, lines[0], salt) && blit(cache, lines[2], salt);
+        if (all && touched && newest && evicted && kept) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: all=%d newest=%d evicted=%d kept=%d\n", all, newest, evicted, kept); fail++;
+        }
+    }
+
+    /* ===== TEST 6: A 16-bit screen texture ===== */
+    printf("\nTEST 6: RGB565 source\n");
+    {
+        SDL_Texture* screen32 = screen;
+        screen = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGB565, SDL_TEXTUREACCESS_TARGET, ROW_W, 2 * ROW_H);
+        bool hit = false;
+        Uint32 px = 0;
+        if (screen) {
+            draw_row((SDL_Color){ 255, 0, 0, 255 });
+            capture(cache, line_b, salt, true);
+            clear_dst();
+            hit = blit(cache, line_b, salt);
+            px = pixel_at(ROW_W / 2, ROW_H + 1);
+            SDL_DestroyTexture(screen);
+        }
+        screen = screen32;
+        if (hit && px == 0xFF0000FFu) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: hit=%d pixel=%08x\n", hit, px); fail++;
+        }
+    }
+
+    /* ===== TEST 7: Clear drops every row ===== */
+    printf("\nTEST 7: Clear\n");
+    {
+        bool before = blit(cache, line_b, salt);
+        row_cache_clear(cache);
+        if (before && !blit(cache, line_b, salt)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: before=%d\n", before); fail++;
+        }
+    }
+
+    printf("\n===== %d passed, %d failed =====\n", pass, fail);
+
+    row_cache_destroy(cache);
+    SDL_DestroyTexture(screen);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+/**
+ * Headless test for session snapshots.
+ *
+ * Saves a terminal with scrollback, colors and a scroll position, restores
+ * it into a fresh terminal and compares every row. Also checks that the
+ * primary screen is saved while the alternate screen is up, and that a
+ * truncated or foreign snapshot resets the terminal and is removed.
+ *
+ * Build: make tests/test_session_snapshot
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <SDL.h>
+
+#include "terminal_state.h"
+#include "terminal.h"
+#include "terminal_libvterm.h"
+#include "config_manager.h"
+#include "session_snapshot.h"
+
+#define COLS 24
+#define ROWS 8
+
+/* ===================== Helpers ===================== */
+
+static SDL_Surface* surface;
+static SDL_Renderer* renderer;
+static Config config;
+
+static Terminal* make_terminal(void) {
+    Terminal* term = terminal_create(COLS, ROWS, &config, renderer);
+    if (!term) { fprintf(stderr, "terminal_create failed\n"); exit(2); }
+    return term;
+}
+
+static void feed(Terminal* term, const char* s) {
+    terminal_libvterm_feed(term, s, strlen(s));
+    terminal_libvterm_flush_damage(term);
+}
+
+/* Row text with trailing blanks trimmed. */
+static void row_text(Terminal* term, int y, char* buf) {
+    Glyph* row = terminal_get_view_line(term, y);
+    int n = 0;
+    for (int x = 0; x < COLS; x++) {
+        uint32_t c = row ? row[x].character : '?';
+        buf[x] = (c >= 0x20 && c < 0x7f) ? (char)c : '?';
+        if (c != ' ') n = x + 1;
+    }
+    buf[n] = '\0';
+}
+
+static bool glyph_equal(const Glyph* a, const Glyph* b) {
+    return a->character == b->character && a->width == b->width &&
+           a->attributes == b->attributes &&
+           a->fg.r == b->fg.r && a->fg.g == b->fg.g && a->fg.b == b->fg.b &&
+           a->bg.r == b->bg.r && a->bg.g == b->bg.g && a->bg.b == b->bg.b;
+}
+
+/* Returns the first view row (at @p offset) that differs between a and b, or -1. */
+static int first_diff(Terminal* a, Terminal* b, int offset) {
+    int save_a = a->view_offset, save_b = b->view_offset;
+    a->view_offset = offset;
+    b->view_offset = offset;
+    int diff = -1;
+    for (int y = 0; y < ROWS && diff < 0; y++) {
+        Glyph* ra = terminal_get_view_line(a, y);
+        Glyph* rb = terminal_get_view_line(b, y);
+        for (int x = 0; x < COLS; x++) {
+            if (!glyph_equal(&ra[x], &rb[x])) { diff = y; break; }
+        }
+    }
+    a->view_offset = save_a;
+    b->view_offset = save_b;
+    return diff;
+}
+
+static void fill_history(Terminal* term) {
+    for (int i = 0; i < 12; i++) {
+        char line[64];
+        snprintf(line, sizeof(line), "\x1b[1;3%dmLINE%02d\x1b[0m \x1b[4;44mu\x1b[0m\r\n", i % 8, i);
+        feed(term, line);
+    }
+    feed(term, "\x1b[3;4H");
+}
+
+/* ===================== Main ===================== */
+
+int main(void) {
+    int pass = 0, fail = 0;
+
+    char dir[] = "/tmp/vaixterm_snapshot_XXXXXX";
+    if (!mkdtemp(dir)) { perror("mkdtemp"); return 2; }
+    char path[300], tmp_path[310];
+    snprintf(path, sizeof(path), "%s/session.snap", dir);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_RGBA8888);
+    renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!renderer) { fprintf(stderr, "No software renderer: %s\n", SDL_GetError()); return 2; }
+    config_init_defaults(&config);
+
+    Terminal* src = make_terminal();
+    fill_history(src);
+    src->view_offset = 3;
+
+    /* ===== TEST 1: Round trip ===== */
+    printf("TEST 1: Save and restore\n");
+    {
+        bool saved = session_snapshot_save(path, src, NULL);
+        Terminal* dst = make_terminal();
+        bool restored = session_snapshot_restore(path, dst, NULL);
+        int sb_src = terminal_get_scrollback_count(src);
+        int sb_dst = terminal_get_scrollback_count(dst);
+        int diff_live = restored ? first_diff(src, dst, 0) : -2;
+        int diff_back = restored ? first_diff(src, dst, 3) : -2;
+        // The restored shell starts on a fresh line below the old cursor
+        if (saved && restored && access(tmp_path, F_OK) != 0 && sb_src == sb_dst && sb_src > 0 &&
+            diff_live < 0 && diff_back < 0 && dst->view_offset == 3 &&
+            dst->cursor_y == 3 && dst->cursor_x == 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: saved=%d restored=%d sb=%d/%d diff=%d/%d view=%d cursor=%d,%d\n",
+                   saved, restored, sb_src, sb_dst, diff_live, diff_back, dst->view_offset,
+                   dst->cursor_x, dst->cursor_y); fail++;
+        }
+        terminal_destroy(dst);
+    }
+
+    /* ===== TEST 2: The primary screen is saved under the alternate one ===== */
+    printf("\nTEST 2: Save during alternate screen\n");
+    {
+        Terminal* alt = make_terminal();
+        fill_history(alt);
+        char primary_row0[COLS + 1];
+        row_text(alt, 0, primary_row0);
+        feed(alt, "\x1b[?1049h\x1b[HALT SCREEN");
+        bool on_alt = alt->alt_screen_active;
+        bool saved = session_snapshot_save(path, alt, NULL);
+        Terminal* dst = make_terminal();
+        bool restored = session_snapshot_restore(path, dst, NULL);
+        char row0[COLS + 1];
+        row_text(dst, 0, row0);
+        if (on_alt && saved && restored && !dst->alt_screen_active &&
+            strcmp(row0, primary_row0) == 0 && strncmp(primary_row0, "LINE", 4) == 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: on_alt=%d saved=%d restored=%d row0='%s' expected='%s'\n",
+                   on_alt, saved, restored, row0, primary_row0); fail++;
+        }
+        terminal_destroy(dst);
+        terminal_destroy(alt);
+    }
+
+    /* ===== TEST 3: Truncated snapshot ===== */
+    printf("\nTEST 3: Truncated snapshot\n");
+    {
+        session_snapshot_save(path, src, NULL);
+        FILE* f = fopen(path, "rb");
+        static char data[1 << 20];
+        size_t size = f ? fread(data, 1, sizeof(data), f) : 0;
+        if (f) fclose(f);
+        f = fopen(path, "wb");
+        if (f) { fwrite(data, 1, size / 2, f); fclose(f); }
+
+        Terminal* dst = make_terminal();
+        feed(dst, "stale\r\n");
+        dst->view_offset = 1;
+        bool restored = session_snapshot_restore(path, dst, NULL);
+        char row0[COLS + 1];
+        row_text(dst, 0, row0);
+        if (size > 64 && !restored && access(path, F_OK) != 0 &&
+            terminal_get_scrollback_count(dst) == 0 && dst->view_offset == 0 &&
+            row0[0] == '\0' && dst->cursor_x == 0 && dst->cursor_y == 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: size=%zu restored=%d exists=%d sb=%d row0='%s'\n", size, restored,
+                   access(path, F_OK) == 0, terminal_get_scrollback_count(dst), row0); fail++;
+        }
+        terminal_destroy(dst);
+    }
+
+    /* ===== TEST 4: Foreign file ===== */
+    printf("\nTEST 4: Wrong magic\n");
+    {
+        FILE* f = fopen(path, "wb");
+        if (f) { fputs("not a snapshot at all", f); fclose(f); }
+        Terminal* dst = make_terminal();
+        bool restored = session_snapshot_restore(path, dst, NULL);
+        if (!restored && access(path, F_OK) != 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: restored=%d exists=%d\n", restored, access(path, F_OK) == 0); fail++;
+        }
+        terminal_destroy(dst);
+    }
+
+    /* ===== TEST 5: No snapshot ===== */
+    printf("\nTEST 5: Missing file\n");
+    {
+        Terminal* dst = make_terminal();
+        if (!session_snapshot_restore(path, dst, NULL)) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: restored a file that does not exist\n"); fail++;
+        }
+        terminal_destroy(dst);
+    }
+
+    printf("\n===== %d passed, %d failed =====\n", pass, fail);
+
+    terminal_destroy(src);
+    config_cleanup(&config);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+
+    char cmd[300];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", dir);
+    if (system(cmd) != 0) {
+        fprintf(stderr, "Could not remove %s\n", dir);
+    }
+    return fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+/**
+ * Headless test for synchronized output (mode 2026).
+ *
+ * Feeds the mode sequences whole, one byte per read and split at random
+ * points, inside parameter lists and around CAN. Checks the mode flag, the
+ * DECRQM replies, that a repeated set keeps its timeout, that a reset
+ * clears a half-read sequence, and that an alternate screen switch split
+ * across reads still leaves the text on the right screen.
+ *
+ * Build: make tests/test_sync_output
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "terminal_state.h"
+#include "terminal.h"
+#include "terminal_libvterm.h"
+#include "config_manager.h"
+
+#define COLS 24
+#define ROWS 6
+
+/* ===================== Helpers ===================== */
+
+static void feed(Terminal* term, const char* s) {
+    terminal_libvterm_feed(term, s, strlen(s));
+    terminal_libvterm_flush_damage(term);
+}
+
+/* Feeds @p s one byte per call, as a slow pty would deliver it. */
+static void feed_bytes(Terminal* term, const char* s) {
+    for (size_t i = 0; s[i]; i++) terminal_libvterm_feed(term, s + i, 1);
+    terminal_libvterm_flush_damage(term);
+}
+
+/* Feeds @p s in two reads, split after @p at bytes. */
+static void feed_split(Terminal* term, const char* s, size_t at) {
+    terminal_libvterm_feed(term, s, at);
+    terminal_libvterm_feed(term, s + at, strlen(s) - at);
+    terminal_libvterm_flush_damage(term);
+}
+
+/* Drains the reply buffer into @p buf as a string. */
+static void take_output(Terminal* term, char* buf, size_t len) {
+    size_t n = terminal_libvterm_flush_output(term, buf, len - 1);
+    buf[n] = '\0';
+}
+
+/* Row text with trailing blanks trimmed. */
+static void row_text(Terminal* term, int y, char* buf) {
+    Glyph* row = terminal_get_view_line(term, y);
+    int n = 0;
+    for (int x = 0; x < COLS; x++) {
+        uint32_t c = row ? row[x].character : '?';
+        buf[x] = (c >= 0x20 && c < 0x7f) ? (char)c : '?';
+        if (c != ' ') n = x + 1;
+    }
+    buf[n] = '\0';
+}
+
+/* ===================== Main ===================== */
+
+int main(void) {
+    int pass = 0, fail = 0;
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_RGBA8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!renderer) { fprintf(stderr, "No software renderer: %s\n", SDL_GetError()); return 2; }
+    Config config;
+    config_init_defaults(&config);
+    Terminal* term = terminal_create(COLS, ROWS, &config, renderer);
+    if (!term) { fprintf(stderr, "terminal_create failed\n"); return 2; }
+
+    char out[128];
+
+    /* ===== TEST 1: Set and reset, whole and byte by byte ===== */
+    printf("TEST 1: Set and reset across reads\n");
+    {
+        feed(term, "\x1b[?2026h");
+        bool whole_set = term->sync_output_active;
+        feed(term, "\x1b[?2026l");
+        bool whole_reset = !term->sync_output_active;
+        feed_bytes(term, "\x1b[?2026h");
+        bool bytes_set = term->sync_output_active;
+        bool split_reset = true;
+        const char* reset = "\x1b[?2026l";
+        for (size_t at = 1; at < strlen(reset); at++) {
+            feed(term, "\x1b[?2026h");
+            feed_split(term, reset, at);
+            split_reset &= !term->sync_output_active;
+        }
+        if (whole_set && whole_reset && bytes_set && split_reset) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: whole=%d/%d bytes=%d split=%d\n", whole_set, whole_reset, bytes_set,
+                   split_reset); fail++;
+        }
+    }
+
+    /* ===== TEST 2: Parameter lists ===== */
+    printf("\nTEST 2: Mode 2026 among other modes\n");
+    {
+        feed_split(term, "\x1b[?1;2026h", 5);
+        bool listed_set = term->sync_output_active;
+        feed_bytes(term, "\x1b[?2026;1l");
+        bool listed_reset = !term->sync_output_active;
+        feed(term, "\x1b[?12026h\x1b[?20260h\x1b[2026h");
+        bool others = !term->sync_output_active;
+        feed(term, "\x1b[?1l");
+        if (listed_set && listed_reset && others) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: listed=%d/%d others=%d\n", listed_set, listed_reset, others); fail++;
+        }
+    }
+
+    /* ===== TEST 3: CAN and ESC abort a sequence ===== */
+    printf("\nTEST 3: Aborted sequences\n");
+    {
+        feed_split(term, "\x1b[?20\x18" "26h", 5);
+        bool cancelled = !term->sync_output_active;
+        feed_split(term, "\x1b[?20\x1b" "26h", 5);
+        bool restarted = !term->sync_output_active;
+        feed_split(term, "\x1b[?20\x1b[?2026h", 5);
+        bool resumed = term->sync_output_active;
+        feed(term, "\x1b[?2026l\x1b[2J\x1b[H");
+        if (cancelled && restarted && resumed) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: can=%d esc=%d resumed=%d\n", cancelled, restarted, resumed); fail++;
+        }
+    }
+
+    /* ===== TEST 4: DECRQM replies ===== */
+    printf("\nTEST 4: DECRQM\n");
+    {
+        char reset_reply[64], set_reply[64], split_reply[64];
+        take_output(term, out, sizeof(out));
+        feed(term, "\x1b[?2026$p");
+        take_output(term, reset_reply, sizeof(reset_reply));
+        feed(term, "\x1b[?2026h");
+        feed_bytes(term, "\x1b[?2026$p");
+        take_output(term, set_reply, sizeof(set_reply));
+        feed_split(term, "\x1b[?2026$p", 7);
+        take_output(term, split_reply, sizeof(split_reply));
+        bool still_set = term->sync_output_active;
+        feed(term, "\x1b[?2026l");
+        if (strcmp(reset_reply, "\x1b[?2026;2$y") == 0 && strcmp(set_reply, "\x1b[?2026;1$y") == 0 &&
+            strcmp(split_reply, "\x1b[?2026;1$y") == 0 && still_set) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: reset=%zu set=%zu split=%zu still=%d\n", strlen(reset_reply),
+                   strlen(set_reply), strlen(split_reply), still_set); fail++;
+        }
+    }
+
+    /* ===== TEST 5: A repeated set keeps the timeout running ===== */
+    printf("\nTEST 5: Timeout\n");
+    {
+        feed(term, "\x1b[?2026h");
+        term->sync_output_since -= 50;
+        Uint32 since = term->sync_output_since;
+        feed(term, "\x1b[?2026h");
+        bool kept = term->sync_output_since == since;
+        bool held = terminal_sync_output_held(term, since + SYNC_OUTPUT_TIMEOUT_MS - 1);
+        bool expired = !terminal_sync_output_held(term, since + SYNC_OUTPUT_TIMEOUT_MS);
+        feed(term, "\x1b[?2026l");
+        bool released = !terminal_sync_output_held(term, since);
+        if (kept && held && expired && released) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: kept=%d held=%d expired=%d released=%d\n", kept, held, expired, released);
+            fail++;
+        }
+    }
+
+    /* ===== TEST 6: Text around the mode changes ===== */
+    printf("\nTEST 6: Text in the same read\n");
+    {
+        feed(term, "\x1b[H\x1b[2KA\x1b[?2026hB\x1b[?2026lC\x1b[?2026h");
+        char row[COLS + 1];
+        row_text(term, 0, row);
+        bool active = term->sync_output_active;
+        feed(term, "\x1b[?2026l");
+        if (strcmp(row, "ABC") == 0 && active) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: row='%s' active=%d\n", row, active); fail++;
+        }
+    }
+
+    /* ===== TEST 7: Reset drops the mode and a half-read sequence ===== */
+    printf("\nTEST 7: Reset\n");
+    {
+        feed(term, "\x1b[?2026h");
+        terminal_libvterm_feed(term, "\x1b[?20", 5);
+        terminal_reset(term);
+        bool cleared = !term->sync_output_active;
+        feed(term, "26h");
+        if (cleared && !term->sync_output_active) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: cleared=%d active=%d\n", cleared, term->sync_output_active); fail++;
+        }
+        feed(term, "\x1b[2J\x1b[H");
+    }
+
+    /* ===== TEST 8: Alternate screen switch split across reads ===== */
+    printf("\nTEST 8: Split alternate screen switch\n");
+    {
+        feed(term, "PRIMARY");
+        feed_bytes(term, "\x1b[?1049h");
+        bool entered = term->alt_screen_active;
+        feed(term, "\x1b[HALT");
+        char alt_row[COLS + 1], primary_row[COLS + 1];
+        row_text(term, 0, alt_row);
+        feed_split(term, "\x1b[?1049l", 7);
+        row_text(term, 0, primary_row);
+        if (entered && !term->alt_screen_active && strcmp(alt_row, "ALT") == 0 &&
+            strcmp(primary_row, "PRIMARY") == 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: entered=%d alt='%s' primary='%s'\n", entered, alt_row, primary_row); fail++;
+        }
+    }
+
+    printf("\n===== %d passed, %d failed =====\n", pass, fail);
+
+    terminal_destroy(term);
+    config_cleanup(&config);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return fail > 0 ? 1 : 0;
+}
@@ -0,0 +1,237 @@
+/**
+ * Headless test for the damage-driven cell grid of the libvterm backend.
+ *
+ * Feeds text, scrolls, scroll regions and partial-width moves through
+ * terminal_libvterm_feed and checks the rows returned by
+ * terminal_get_view_line. After each workload the grid is compared with a
+ * full re-read from libvterm, so every damage and moverect update must
+ * leave it exactly as a rebuild would.
+ *
+ * Build: make tests/test_vterm_grid
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL.h>
+
+#include "terminal_state.h"
+#include "terminal.h"
+#include "terminal_libvterm.h"
+#include "config_manager.h"
+#include "dirty_region_tracker.h"
+
+#define COLS 20
+#define ROWS 8
+
+/* ===================== Helpers ===================== */
+
+static SDL_Surface* surface;
+static SDL_Renderer* renderer;
+
+static Terminal* make_terminal(Config* config) {
+    config_init_defaults(config);
+    Terminal* term = terminal_create(COLS, ROWS, config, renderer);
+    if (!term) { fprintf(stderr, "terminal_create failed\n"); exit(2); }
+    // The first read builds the grid; later reads see incremental updates
+    terminal_get_view_line(term, 0);
+    return term;
+}
+
+static void feed(Terminal* term, const char* s) {
+    terminal_libvterm_feed(term, s, strlen(s));
+    terminal_libvterm_flush_damage(term);
+}
+
+/* Row text with trailing blanks trimmed. */
+static const char* row_text(Terminal* term, int y) {
+    static char buf[COLS + 1];
+    Glyph* row = terminal_get_view_line(term, y);
+    int n = 0;
+    for (int x = 0; x < COLS; x++) {
+        uint32_t c = row ? row[x].character : '?';
+        buf[x] = (c >= 0x20 && c < 0x7f) ? (char)c : '?';
+        if (c != ' ') n = x + 1;
+    }
+    buf[n] = '\0';
+    return buf;
+}
+
+static bool glyph_equal(const Glyph* a, const Glyph* b) {
+    return a->character == b->character && a->width == b->width &&
+           a->attributes == b->attributes &&
+           a->fg.r == b->fg.r && a->fg.g == b->fg.g && a->fg.b == b->fg.b &&
+           a->bg.r == b->bg.r && a->bg.g == b->bg.g && a->bg.b == b->bg.b;
+}
+
+/* Compares the grid with a full rebuild; returns the first differing row or -1. */
+static int grid_matches_rebuild(Terminal* term, int* blink_row) {
+    Glyph before[ROWS][COLS];
+    int blink[ROWS];
+    for (int y = 0; y < ROWS; y++) {
+        memcpy(before[y], terminal_get_view_line(term, y), sizeof(Glyph) * COLS);
+        blink[y] = terminal_get_blink_cells(term, y);
+    }
+
+    // Same colors, but the grid is marked stale and re-read on the next access
+    terminal_libvterm_set_default_colors(term, term->default_fg, term->default_bg);
+
+    *blink_row = -1;
+    for (int y = 0; y < ROWS; y++) {
+        Glyph* row = terminal_get_view_line(term, y);
+        for (int x = 0; x < COLS; x++) {
+            if (!glyph_equal(&before[y][x], &row[x])) return y;
+        }
+        if (blink[y] != terminal_get_blink_cells(term, y) && *blink_row < 0) *blink_row = y;
+    }
+    return -1;
+}
+
+/* ===================== Main ===================== */
+
+int main(void) {
+    int pass = 0, fail = 0;
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_RGBA8888);
+    renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!renderer) { fprintf(stderr, "No software renderer: %s\n", SDL_GetError()); return 2; }
+
+    Config config;
+    Terminal* term = make_terminal(&config);
+
+    /* ===== TEST 1: Printed text lands in the grid ===== */
+    printf("TEST 1: Printed text\n");
+    feed(term, "hello\r\nworld");
+    {
+        char row0[COLS + 1];
+        snprintf(row0, sizeof(row0), "%s", row_text(term, 0));
+        if (strcmp(row0, "hello") == 0 && strcmp(row_text(term, 1), "world") == 0 &&
+            term->cursor_x == 5 && term->cursor_y == 1) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: row0='%s' row1='%s' cursor=%d,%d\n", row0, row_text(term, 1),
+                   term->cursor_x, term->cursor_y); fail++;
+        }
+    }
+
+    /* ===== TEST 2: Rows are updated in place ===== */
+    printf("\nTEST 2: Held rows see later updates\n");
+    {
+        Glyph* r0 = terminal_get_view_line(term, 0);
+        Glyph* r1 = terminal_get_view_line(term, 1);
+        feed(term, "\x1b[1;1HJ\x1b[2;5HD");
+        if (r0 != r1 && r0 == terminal_get_view_line(term, 0) &&
+            r0[0].character == 'J' && r1[4].character == 'D' && r1[0].character == 'w') {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: r0[0]=%u r1[4]=%u\n", r0[0].character, r1[4].character); fail++;
+        }
+    }
+
+    /* ===== TEST 3: Damage marks only the damaged rows dirty ===== */
+    printf("\nTEST 3: Damage marks dirty rows\n");
+    terminal_clear_dirty_lines(term);
+    feed(term, "\x1b[3;1Hthird");
+    if (term->dirty_lines[2] && !term->dirty_lines[0] && !term->dirty_lines[5] &&
+        strcmp(row_text(term, 2), "third") == 0) {
+        printf("  PASS\n"); pass++;
+    } else {
+        printf("  FAIL: dirty0=%d dirty2=%d dirty5=%d\n", term->dirty_lines[0],
+               term->dirty_lines[2], term->dirty_lines[5]); fail++;
+    }
+
+    /* ===== TEST 4: Full-screen scroll moves the grid ===== */
+    printf("\nTEST 4: Scrolling\n");
+    feed(term, "\x1b[H\x1b[2J");
+    for (int i = 0; i <= 10; i++) {
+        char line[16];
+        snprintf(line, sizeof(line), "L%02d\r\n", i);
+        feed(term, line);
+    }
+    {
+        char row0[COLS + 1], row6[COLS + 1];
+        snprintf(row0, sizeof(row0), "%s", row_text(term, 0));
+        snprintf(row6, sizeof(row6), "%s", row_text(term, 6));
+        int bad_blink;
+        int bad = grid_matches_rebuild(term, &bad_blink);
+        if (strcmp(row0, "L04") == 0 && strcmp(row6, "L10") == 0 &&
+            strcmp(row_text(term, 7), "") == 0 && bad < 0 && bad_blink < 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: row0='%s' row6='%s' mismatch row=%d\n", row0, row6, bad); fail++;
+        }
+    }
+
+    /* ===== TEST 5: Scroll regions and partial-width moves ===== */
+    printf("\nTEST 5: Scroll region, insert and delete\n");
+    feed(term, "\x1b[1;2H\x1b[3@");                 // ICH: shift row 0 right from col 1
+    {
+        char row0[COLS + 1];
+        snprintf(row0, sizeof(row0), "%s", row_text(term, 0));
+        feed(term, "\x1b[2;1H\x1b[1;31mRED\x1b[0m\x1b[2;1H\x1b[2P"); // DCH on a colored row
+        feed(term, "\x1b[3;6r\x1b[6;1H\n\n");         // Region scroll up by two
+        feed(term, "\x1b[4;1H\x1b[L");                // IL inside the region
+        feed(term, "\x1b[3;1H\x1bM");                 // RI at the region top
+        feed(term, "\x1b[r\x1b[7;3H\x1b[5;44mblink\x1b[0m\x1b[8;10H\x1b[4X");
+        int bad_blink;
+        int bad = grid_matches_rebuild(term, &bad_blink);
+        if (strcmp(row0, "L   04") == 0 && bad < 0 && bad_blink < 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: row0='%s' mismatch row=%d blink row=%d\n", row0, bad, bad_blink); fail++;
+        }
+    }
+
+    /* ===== TEST 6: Blink counts follow moved rows ===== */
+    printf("\nTEST 6: Blink counts move with rows\n");
+    feed(term, "\x1b[H\x1b[2J\x1b[6;1H\x1b[5mB\x1b[0m");
+    int before = terminal_get_blink_cells(term, 5);
+    feed(term, "\x1b[2S");                              // SU: scroll up two
+    {
+        int bad_blink;
+        int bad = grid_matches_rebuild(term, &bad_blink);
+        if (before == 1 && terminal_get_blink_cells(term, 3) == 1 &&
+            terminal_get_blink_cells(term, 5) == 0 && bad < 0 && bad_blink < 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: before=%d row3=%d row5=%d\n", before, terminal_get_blink_cells(term, 3),
+                   terminal_get_blink_cells(term, 5)); fail++;
+        }
+    }
+
+    /* ===== TEST 7: Scrolled-back rows are separate buffers ===== */
+    printf("\nTEST 7: Scrollback view\n");
+    feed(term, "\x1b[H\x1b[2J");
+    for (int i = 0; i < 12; i++) {
+        char line[16];
+        snprintf(line, sizeof(line), "S%02d\r\n", i);
+        feed(term, line);
+    }
+    term->view_offset = 2;
+    {
+        Glyph* top = terminal_get_view_line(term, 0);
+        Glyph* next = terminal_get_view_line(term, 1);
+        int sb = terminal_get_scrollback_count(term);
+        char row0[COLS + 1];
+        snprintf(row0, sizeof(row0), "%s", row_text(term, 0));
+        char row1[COLS + 1];
+        snprintf(row1, sizeof(row1), "%s", row_text(term, 1));
+        // 13 lines on 8 rows: S00-S04 scrolled off, S05 is the top live row
+        if (top != next && sb >= 5 && strcmp(row0, "S03") == 0 && strcmp(row1, "S04") == 0 &&
+            strcmp(row_text(term, 2), "S05") == 0) {
+            printf("  PASS\n"); pass++;
+        } else {
+            printf("  FAIL: sb=%d row0='%s' row1='%s'\n", sb, row0, row1); fail++;
+        }
+    }
+    term->view_offset = 0;
+
+    printf("\n===== %d passed, %d failed =====\n", pass, fail);
+
+    terminal_destroy(term);
+    config_cleanup(&config);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return fail > 0 ? 1 : 0;
+}